@@ -7,6 +7,7 @@
 //
 
 #import "AppDelegate.h"
+#import "DBManagerBenchmark.h"
 
 @interface AppDelegate ()
 
@@ -17,6 +18,11 @@
 
 - (BOOL)application:(UIApplication *)application didFinishLaunchingWithOptions:(NSDictionary *)launchOptions {
     // Override point for customization after application launch.
+#if DEBUG
+    if ([[[NSProcessInfo processInfo] arguments] containsObject:DBManagerBenchmarkLaunchArgument]) {
+        [DBManagerBenchmark runAllWithDatabaseFilename:@"f15_r12_RadarTrackData_traf.db"];
+    }
+#endif
     return YES;
 }
 
@@ -0,0 +1,46 @@
+//
+//  DBColumnarResult.h
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 24/06/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <sqlite3.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Storage type of a result column. Both types are 8 bytes wide.
+typedef NS_ENUM(NSInteger, DBColumnType) {
+    DBColumnTypeInt64,
+    DBColumnTypeDouble
+};
+
+// Column layout shared by TRAF and OWN: the INT time of applicability followed by six FLOAT columns.
+extern const DBColumnType DBTrackSampleColumnTypes[];
+extern const NSUInteger DBTrackSampleColumnCount;
+
+// Column layout of TRACK: the INT track id, then the TRAF layout.
+extern const DBColumnType DBTrackStateColumnTypes[];
+extern const NSUInteger DBTrackStateColumnCount;
+
+// Query results stored as one contiguous array per column. Column types are declared up front and
+// values are read with sqlite3_column_int64/sqlite3_column_double, so no object is created per cell.
+// SQL NULLs are stored as 0 in INTEGER columns and NAN in REAL columns.
+@interface DBColumnarResult : NSObject
+
+    @property (nonatomic, readonly) NSUInteger columnCount;
+    @property (nonatomic, readonly) NSUInteger rowCount;
+    @property (nonatomic, readonly) NSUInteger capacity;
+
+    -(instancetype)initWithColumnTypes:(const DBColumnType *)columnTypes count:(NSUInteger)columnCount;
+    -(DBColumnType)typeOfColumnAtIndex:(NSUInteger)columnIndex;
+    -(const int64_t *)int64ColumnAtIndex:(NSUInteger)columnIndex;
+    -(const double *)doubleColumnAtIndex:(NSUInteger)columnIndex;
+    -(void)reserveCapacity:(NSUInteger)rowCapacity;
+    -(void)removeAllRows;
+    -(BOOL)appendRowFromStatement:(sqlite3_stmt *)statement;
+@end
+
+NS_ASSUME_NONNULL_END
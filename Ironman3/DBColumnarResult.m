@@ -0,0 +1,126 @@
+//
+//  DBColumnarResult.m
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 24/06/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import "DBColumnarResult.h"
+
+const DBColumnType DBTrackSampleColumnTypes[] = {
+    DBColumnTypeInt64,
+    DBColumnTypeDouble,
+    DBColumnTypeDouble,
+    DBColumnTypeDouble,
+    DBColumnTypeDouble,
+    DBColumnTypeDouble,
+    DBColumnTypeDouble,
+};
+const NSUInteger DBTrackSampleColumnCount = sizeof(DBTrackSampleColumnTypes) / sizeof(DBTrackSampleColumnTypes[0]);
+
+const DBColumnType DBTrackStateColumnTypes[] = {
+    DBColumnTypeInt64,
+    DBColumnTypeInt64,
+    DBColumnTypeDouble,
+    DBColumnTypeDouble,
+    DBColumnTypeDouble,
+    DBColumnTypeDouble,
+    DBColumnTypeDouble,
+    DBColumnTypeDouble,
+};
+const NSUInteger DBTrackStateColumnCount = sizeof(DBTrackStateColumnTypes) / sizeof(DBTrackStateColumnTypes[0]);
+
+// A column buffer viewed as either of the two 8-byte storage types.
+typedef union {
+    int64_t *int64Values;
+    double *doubleValues;
+    void *bytes;
+} DBColumnBuffer;
+
+@interface DBColumnarResult ()
+
+    @property (nonatomic, readwrite) NSUInteger columnCount;
+    @property (nonatomic, readwrite) NSUInteger rowCount;
+    @property (nonatomic, readwrite) NSUInteger capacity;
+@end
+
+@implementation DBColumnarResult {
+    DBColumnType *_columnTypes;
+    DBColumnBuffer *_columns;
+}
+
+-(instancetype)initWithColumnTypes:(const DBColumnType *)columnTypes count:(NSUInteger)columnCount{
+    self = [super init];
+    if (self) {
+        self.columnCount = columnCount;
+        _columnTypes = malloc(columnCount * sizeof(DBColumnType));
+        memcpy(_columnTypes, columnTypes, columnCount * sizeof(DBColumnType));
+        _columns = calloc(columnCount, sizeof(DBColumnBuffer));
+    }
+    return self;
+}
+
+-(void)dealloc{
+    for (NSUInteger i=0; i<self.columnCount; i++) {
+        free(_columns[i].bytes);
+    }
+    free(_columns);
+    free(_columnTypes);
+}
+
+-(DBColumnType)typeOfColumnAtIndex:(NSUInteger)columnIndex{
+    return _columnTypes[columnIndex];
+}
+
+-(const int64_t *)int64ColumnAtIndex:(NSUInteger)columnIndex{
+    NSAssert(_columnTypes[columnIndex] == DBColumnTypeInt64, @"Column %lu is not an INTEGER column", (unsigned long)columnIndex);
+    return _columns[columnIndex].int64Values;
+}
+
+-(const double *)doubleColumnAtIndex:(NSUInteger)columnIndex{
+    NSAssert(_columnTypes[columnIndex] == DBColumnTypeDouble, @"Column %lu is not a REAL column", (unsigned long)columnIndex);
+    return _columns[columnIndex].doubleValues;
+}
+
+-(void)reserveCapacity:(NSUInteger)rowCapacity{
+    if (rowCapacity <= self.capacity) {
+        return;
+    }
+
+    // Both storage types are 8 bytes, so every column grows by the same amount.
+    for (NSUInteger i=0; i<self.columnCount; i++) {
+        _columns[i].bytes = realloc(_columns[i].bytes, rowCapacity * sizeof(int64_t));
+    }
+    self.capacity = rowCapacity;
+}
+
+-(void)removeAllRows{
+    // Keep the buffers so the result can be refilled without reallocating.
+    self.rowCount = 0;
+}
+
+-(BOOL)appendRowFromStatement:(sqlite3_stmt *)statement{
+    if ((NSUInteger)sqlite3_column_count(statement) != self.columnCount) {
+        NSLog(@"DB Error: query returns %d columns, %lu declared", sqlite3_column_count(statement), (unsigned long)self.columnCount);
+        return NO;
+    }
+
+    // Grow geometrically so appending n rows costs O(n) copies overall.
+    if (self.rowCount == self.capacity) {
+        [self reserveCapacity:MAX(self.capacity * 2, (NSUInteger)64)];
+    }
+
+    NSUInteger row = self.rowCount;
+    for (int i=0; i<(int)self.columnCount; i++) {
+        if (_columnTypes[i] == DBColumnTypeInt64) {
+            _columns[i].int64Values[row] = sqlite3_column_int64(statement, i);
+        }
+        else {
+            _columns[i].doubleValues[row] = sqlite3_column_type(statement, i) == SQLITE_NULL ? NAN : sqlite3_column_double(statement, i);
+        }
+    }
+    self.rowCount = row + 1;
+    return YES;
+}
+@end
@@ -0,0 +1,34 @@
+//
+//  DBConnection.h
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 21/06/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <sqlite3.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Default number of prepared statements kept alive per connection.
+extern const NSUInteger DBConnectionDefaultStatementCacheCapacity;
+
+// A long-lived sqlite3 handle with a bounded LRU cache of prepared statements keyed by SQL text.
+// Statements are checked out with acquireStatement: and handed back with releaseStatement:, which
+// resets and unbinds them so the next caller gets a clean statement without re-parsing the SQL.
+@interface DBConnection : NSObject
+
+    @property (nonatomic, readonly) NSString *databasePath;
+    @property (nonatomic, readonly, nullable) sqlite3 *database;
+    @property (nonatomic) NSUInteger statementCacheCapacity;
+
+    -(nullable instancetype)initWithDatabasePath:(NSString *)databasePath flags:(int)flags;
+    -(nullable sqlite3_stmt *)acquireStatement:(const char *)query;
+    -(void)releaseStatement:(sqlite3_stmt *)statement;
+    -(BOOL)bindArguments:(nullable NSArray *)arguments toStatement:(sqlite3_stmt *)statement;
+    -(void)finalizeCachedStatements;
+    -(void)close;
+@end
+
+NS_ASSUME_NONNULL_END
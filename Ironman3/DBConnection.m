@@ -0,0 +1,150 @@
+//
+//  DBConnection.m
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 21/06/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import "DBConnection.h"
+
+const NSUInteger DBConnectionDefaultStatementCacheCapacity = 16;
+
+@interface DBConnection ()
+
+    @property (nonatomic, readwrite) NSString *databasePath;
+    @property (nonatomic, readwrite, nullable) sqlite3 *database;
+
+    // Idle prepared statements keyed by their SQL text.
+    @property (nonatomic, strong) NSMutableDictionary<NSString *, NSValue *> *cachedStatements;
+
+    // SQL keys of the idle statements, least recently used first.
+    @property (nonatomic, strong) NSMutableArray<NSString *> *recentlyUsedQueries;
+@end
+
+@implementation DBConnection
+
+-(instancetype)initWithDatabasePath:(NSString *)databasePath flags:(int)flags{
+    self = [super init];
+    if (self) {
+        self.databasePath = databasePath;
+        self.statementCacheCapacity = DBConnectionDefaultStatementCacheCapacity;
+        self.cachedStatements = [[NSMutableDictionary alloc] init];
+        self.recentlyUsedQueries = [[NSMutableArray alloc] init];
+
+        // Open the database once; every query on this connection reuses the handle.
+        sqlite3 *sqlite3Database = NULL;
+        if (sqlite3_open_v2([databasePath UTF8String], &sqlite3Database, flags, NULL) != SQLITE_OK) {
+            NSLog(@"%s", sqlite3_errmsg(sqlite3Database));
+            sqlite3_close(sqlite3Database);
+            return nil;
+        }
+        self.database = sqlite3Database;
+    }
+    return self;
+}
+
+-(void)dealloc{
+    [self close];
+}
+
+-(sqlite3_stmt *)acquireStatement:(const char *)query{
+    if (self.database == NULL) {
+        return NULL;
+    }
+
+    // Hand out a cached statement if one is idle. It is removed from the cache while in use so that
+    // two callers running the same SQL never share a statement.
+    NSString *key = [NSString stringWithUTF8String:query];
+    NSValue *cachedStatement = self.cachedStatements[key];
+    if (cachedStatement != nil) {
+        [self.cachedStatements removeObjectForKey:key];
+        [self.recentlyUsedQueries removeObject:key];
+        return (sqlite3_stmt *)[cachedStatement pointerValue];
+    }
+
+    // Otherwise compile the query into a new statement.
+    sqlite3_stmt *compiledStatement = NULL;
+    if (sqlite3_prepare_v3(self.database, query, -1, SQLITE_PREPARE_PERSISTENT, &compiledStatement, NULL) != SQLITE_OK) {
+        NSLog(@"%s", sqlite3_errmsg(self.database));
+        sqlite3_finalize(compiledStatement);
+        return NULL;
+    }
+    return compiledStatement;
+}
+
+-(void)releaseStatement:(sqlite3_stmt *)statement{
+    // Reset the statement and clear its bindings so it is ready for the next caller.
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+
+    NSString *key = [NSString stringWithUTF8String:sqlite3_sql(statement)];
+    if (self.database == NULL || self.statementCacheCapacity == 0 || self.cachedStatements[key] != nil) {
+        // The connection was closed while the statement was out, caching is disabled, or an
+        // identical statement is already idle in the cache.
+        sqlite3_finalize(statement);
+        return;
+    }
+
+    // Evict the least recently used statement once the cache is full.
+    if (self.cachedStatements.count >= self.statementCacheCapacity) {
+        NSString *evictedKey = self.recentlyUsedQueries.firstObject;
+        sqlite3_finalize((sqlite3_stmt *)[self.cachedStatements[evictedKey] pointerValue]);
+        [self.cachedStatements removeObjectForKey:evictedKey];
+        [self.recentlyUsedQueries removeObjectAtIndex:0];
+    }
+
+    self.cachedStatements[key] = [NSValue valueWithPointer:statement];
+    [self.recentlyUsedQueries addObject:key];
+}
+
+-(BOOL)bindArguments:(NSArray *)arguments toStatement:(sqlite3_stmt *)statement{
+    // Parameters are 1-based in SQLite.
+    for (int i=0; i<(int)arguments.count; i++){
+        id argument = arguments[i];
+        int bindResult;
+        if ([argument isKindOfClass:[NSNumber class]]) {
+            // Keep floating point values as REAL and everything else as INTEGER.
+            const char *objCType = [argument objCType];
+            if (strcmp(objCType, @encode(double)) == 0 || strcmp(objCType, @encode(float)) == 0) {
+                bindResult = sqlite3_bind_double(statement, i + 1, [argument doubleValue]);
+            }
+            else {
+                bindResult = sqlite3_bind_int64(statement, i + 1, [argument longLongValue]);
+            }
+        }
+        else if ([argument isKindOfClass:[NSString class]]) {
+            bindResult = sqlite3_bind_text(statement, i + 1, [argument UTF8String], -1, SQLITE_TRANSIENT);
+        }
+        else if ([argument isKindOfClass:[NSData class]]) {
+            bindResult = sqlite3_bind_blob(statement, i + 1, [argument bytes], (int)[argument length], SQLITE_TRANSIENT);
+        }
+        else {
+            bindResult = sqlite3_bind_null(statement, i + 1);
+        }
+
+        if (bindResult != SQLITE_OK) {
+            NSLog(@"DB Error: %s", sqlite3_errmsg(self.database));
+            return NO;
+        }
+    }
+    return YES;
+}
+
+-(void)finalizeCachedStatements{
+    for (NSValue *cachedStatement in self.cachedStatements.allValues) {
+        sqlite3_finalize((sqlite3_stmt *)[cachedStatement pointerValue]);
+    }
+    [self.cachedStatements removeAllObjects];
+    [self.recentlyUsedQueries removeAllObjects];
+}
+
+-(void)close{
+    [self finalizeCachedStatements];
+    if (self.database != NULL) {
+        // Statements still checked out keep the handle alive until they are finalized.
+        sqlite3_close_v2(self.database);
+        self.database = NULL;
+    }
+}
+@end
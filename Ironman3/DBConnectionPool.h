@@ -0,0 +1,28 @@
+//
+//  DBConnectionPool.h
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 05/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "DBConnection.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// A fixed number of connections to one database, opened on demand. A connection is used by one
+// thread at a time: acquireConnection blocks until one is free and releaseConnection hands it back.
+@interface DBConnectionPool : NSObject
+
+    @property (nonatomic, readonly) NSString *databasePath;
+    @property (nonatomic, readonly) NSUInteger capacity;
+    @property (nonatomic) NSUInteger statementCacheCapacity;
+
+    -(instancetype)initWithDatabasePath:(NSString *)databasePath flags:(int)flags capacity:(NSUInteger)capacity;
+    -(nullable DBConnection *)acquireConnection;
+    -(void)releaseConnection:(DBConnection *)connection;
+    -(void)close;
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,102 @@
+//
+//  DBConnectionPool.m
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 05/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import "DBConnectionPool.h"
+
+@interface DBConnectionPool ()
+
+    @property (nonatomic, readwrite) NSString *databasePath;
+    @property (nonatomic, readwrite) NSUInteger capacity;
+    @property (nonatomic) int flags;
+
+    // Counts the connections that are free or not opened yet.
+    @property (nonatomic, strong) dispatch_semaphore_t availableConnections;
+
+    // Open connections that nobody has checked out, guarded by @synchronized(self).
+    @property (nonatomic, strong) NSMutableArray<DBConnection *> *idleConnections;
+    @property (nonatomic) BOOL closed;
+@end
+
+@implementation DBConnectionPool
+
+-(instancetype)initWithDatabasePath:(NSString *)databasePath flags:(int)flags capacity:(NSUInteger)capacity{
+    self = [super init];
+    if (self) {
+        self.databasePath = databasePath;
+        self.flags = flags;
+        self.capacity = MAX(capacity, (NSUInteger)1);
+        self.statementCacheCapacity = DBConnectionDefaultStatementCacheCapacity;
+        self.availableConnections = dispatch_semaphore_create((long)self.capacity);
+        self.idleConnections = [[NSMutableArray alloc] initWithCapacity:self.capacity];
+    }
+    return self;
+}
+
+-(void)dealloc{
+    [self close];
+}
+
+-(void)setStatementCacheCapacity:(NSUInteger)statementCacheCapacity{
+    @synchronized (self) {
+        _statementCacheCapacity = statementCacheCapacity;
+        for (DBConnection *connection in self.idleConnections) {
+            connection.statementCacheCapacity = statementCacheCapacity;
+        }
+    }
+}
+
+-(DBConnection *)acquireConnection{
+    dispatch_semaphore_wait(self.availableConnections, DISPATCH_TIME_FOREVER);
+
+    // Reuse an idle connection, or open a new one while the pool is below capacity.
+    @synchronized (self) {
+        if (self.closed) {
+            dispatch_semaphore_signal(self.availableConnections);
+            return nil;
+        }
+        DBConnection *connection = self.idleConnections.lastObject;
+        if (connection != nil) {
+            [self.idleConnections removeLastObject];
+            return connection;
+        }
+    }
+
+    // Opening is slow, so do it outside the lock.
+    DBConnection *connection = [[DBConnection alloc] initWithDatabasePath:self.databasePath flags:self.flags | SQLITE_OPEN_NOMUTEX];
+    if (connection == nil) {
+        dispatch_semaphore_signal(self.availableConnections);
+        return nil;
+    }
+    connection.statementCacheCapacity = self.statementCacheCapacity;
+    return connection;
+}
+
+-(void)releaseConnection:(DBConnection *)connection{
+    @synchronized (self) {
+        if (self.closed) {
+            [connection close];
+        }
+        else {
+            connection.statementCacheCapacity = self.statementCacheCapacity;
+            [self.idleConnections addObject:connection];
+        }
+    }
+    dispatch_semaphore_signal(self.availableConnections);
+}
+
+-(void)close{
+    // Connections still checked out are closed when they come back.
+    @synchronized (self) {
+        self.closed = YES;
+        for (DBConnection *connection in self.idleConnections) {
+            [connection close];
+        }
+        [self.idleConnections removeAllObjects];
+    }
+}
+@end
@@ -0,0 +1,38 @@
+//
+//  DBCursor.h
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 26/06/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <sqlite3.h>
+#import "DBColumnarResult.h"
+
+@class DBConnection;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Number of rows a cursor hands out per batch unless told otherwise.
+extern const NSUInteger DBCursorDefaultBatchSize;
+
+// Pull-based reader over a live statement. Each call steps at most batchSize rows, so a recording of
+// any length can be processed in constant memory. The statement goes back to the connection's cache
+// when the cursor is exhausted or closed.
+@interface DBCursor : NSObject
+
+    @property (nonatomic, readonly) NSUInteger batchSize;
+    @property (nonatomic, readonly) NSArray<NSString *> *columnNames;
+    @property (nonatomic, readonly, getter=isExhausted) BOOL exhausted;
+
+    // Called once when the cursor closes, after its statement has been handed back.
+    @property (nonatomic, copy, nullable) void (^closeHandler)(void);
+
+    -(nullable instancetype)initWithConnection:(DBConnection *)connection query:(const char *)query arguments:(nullable NSArray *)arguments batchSize:(NSUInteger)batchSize;
+    -(nullable NSArray<NSArray *> *)nextBatch;
+    -(NSUInteger)nextBatchIntoResult:(DBColumnarResult *)result;
+    -(void)close;
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,123 @@
+//
+//  DBCursor.m
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 26/06/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import "DBCursor.h"
+#import "DBConnection.h"
+
+const NSUInteger DBCursorDefaultBatchSize = 4096;
+
+@interface DBCursor ()
+
+    @property (nonatomic, readwrite) NSUInteger batchSize;
+    @property (nonatomic, readwrite) NSArray<NSString *> *columnNames;
+    @property (nonatomic, readwrite, getter=isExhausted) BOOL exhausted;
+    @property (nonatomic, strong, nullable) DBConnection *connection;
+    @property (nonatomic, nullable) sqlite3_stmt *compiledStatement;
+@end
+
+@implementation DBCursor
+
+-(instancetype)initWithConnection:(DBConnection *)connection query:(const char *)query arguments:(NSArray *)arguments batchSize:(NSUInteger)batchSize{
+    self = [super init];
+    if (self) {
+        self.connection = connection;
+        self.batchSize = MAX(batchSize, (NSUInteger)1);
+
+        // Check out a compiled statement for the query and bind its parameters.
+        self.compiledStatement = [connection acquireStatement:query];
+        if (self.compiledStatement == NULL) {
+            return nil;
+        }
+        if (![connection bindArguments:arguments toStatement:self.compiledStatement]) {
+            [self close];
+            return nil;
+        }
+
+        // The column names are known as soon as the statement is compiled.
+        int totalColumns = sqlite3_column_count(self.compiledStatement);
+        NSMutableArray<NSString *> *columnNames = [[NSMutableArray alloc] initWithCapacity:totalColumns];
+        for (int i=0; i<totalColumns; i++){
+            [columnNames addObject:[NSString stringWithUTF8String:sqlite3_column_name(self.compiledStatement, i)]];
+        }
+        self.columnNames = columnNames;
+    }
+    return self;
+}
+
+-(void)dealloc{
+    [self close];
+}
+
+-(BOOL)stepStatement{
+    // Advance to the next row, closing the cursor once the result set is exhausted.
+    int stepResult = sqlite3_step(self.compiledStatement);
+    if (stepResult == SQLITE_ROW) {
+        return YES;
+    }
+    if (stepResult != SQLITE_DONE) {
+        NSLog(@"DB Error: %s", sqlite3_errmsg(self.connection.database));
+    }
+    [self close];
+    return NO;
+}
+
+-(NSArray<NSArray *> *)nextBatch{
+    if (self.exhausted) {
+        return nil;
+    }
+
+    NSMutableArray<NSArray *> *arrResults = [[NSMutableArray alloc] initWithCapacity:self.batchSize];
+    int totalColumns = (int)self.columnNames.count;
+    while (arrResults.count < self.batchSize && [self stepStatement]) {
+        // Initialize the mutable array that will contain the data of a fetched row.
+        NSMutableArray *arrDataRow = [[NSMutableArray alloc] initWithCapacity:totalColumns];
+
+        // Go through all columns and fetch each column data, skipping NULLs.
+        for (int i=0; i<totalColumns; i++){
+            char *dbDataAsChars = (char *)sqlite3_column_text(self.compiledStatement, i);
+            if (dbDataAsChars != NULL) {
+                [arrDataRow addObject:[NSString stringWithUTF8String:dbDataAsChars]];
+            }
+        }
+
+        // Store the row, but first check if there is actually data.
+        if (arrDataRow.count > 0) {
+            [arrResults addObject:arrDataRow];
+        }
+    }
+    return (arrResults.count > 0 || !self.exhausted) ? arrResults : nil;
+}
+
+-(NSUInteger)nextBatchIntoResult:(DBColumnarResult *)result{
+    // Reuse the caller's buffers; after the first batch they are already large enough.
+    [result removeAllRows];
+    [result reserveCapacity:self.batchSize];
+
+    while (!self.exhausted && result.rowCount < self.batchSize && [self stepStatement]) {
+        if (![result appendRowFromStatement:self.compiledStatement]) {
+            [self close];
+        }
+    }
+    return result.rowCount;
+}
+
+-(void)close{
+    if (self.compiledStatement != NULL) {
+        [self.connection releaseStatement:self.compiledStatement];
+        self.compiledStatement = NULL;
+    }
+    self.connection = nil;
+    self.exhausted = YES;
+    
+    void (^closeHandler)(void) = self.closeHandler;
+    self.closeHandler = nil;
+    if (closeHandler != nil) {
+        closeHandler();
+    }
+}
+@end
@@ -8,23 +8,54 @@
 
 #import <Foundation/Foundation.h>
 #import <sqlite3.h>
+#import "DBColumnarResult.h"
+#import "DBCursor.h"
+#import "DBQueryResult.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
+// Thread-safe access to one database. Reads run concurrently on a pool of read-only connections and
+// writes are serialized on a single WAL connection. Prefer the methods returning DBQueryResult when
+// querying from several queues; the shared arrResults/arrColumnNames/affectedRows/lastInsertedRowID
+// properties only reflect whichever query finished last.
+// A database that is only in the app bundle is read where it is, as an immutable file, whatever its
+// schema. The first write copies it into the documents directory, migrates the copy and moves every
+// later query onto it. Until then an older recording has no TRACK table, and the track methods return
+// no rows for it.
 @interface DBManager : NSObject
 
     @property (nonatomic, strong) NSString *documentsDirectory;
     @property (nonatomic, strong) NSString *databaseFilename;
+    @property (nonatomic, readonly) NSString *databasePath;
+    @property (nonatomic, readonly, getter=isOpenedInPlace) BOOL openedInPlace;
     @property (nonatomic, strong) NSMutableArray *arrColumnNames;
     @property (nonatomic, strong) NSMutableArray *arrResults;
     @property (nonatomic) int affectedRows;
     
     @property (nonatomic) long long lastInsertedRowID;
+    @property (nonatomic) NSUInteger statementCacheCapacity;
+    @property (nonatomic) NSUInteger readerConnectionCount;
     -(instancetype)initWithDatabaseFilename:(NSString *)dbFilename;
     -(void)copyDatabaseIntoDocumentsDirectory;
+    -(BOOL)migrateTrackStoreIfNeeded;
+    -(BOOL)promoteToWritableCopyIfNeeded;
+    -(DBQueryResult *)resultOfQuery:(NSString *)query arguments:(nullable NSArray *)arguments;
+    -(DBQueryResult *)resultOfExecutingQuery:(NSString *)query arguments:(nullable NSArray *)arguments;
     -(void)runQuery:(const char *)query isQueryExecutable:(BOOL)queryExecutable;
+    -(void)runQuery:(const char *)query arguments:(nullable NSArray *)arguments isQueryExecutable:(BOOL)queryExecutable;
     -(NSArray *)loadDataFromDB:(NSString *)query;
+    -(NSArray *)loadDataFromDB:(NSString *)query arguments:(nullable NSArray *)arguments;
+    -(nullable DBCursor *)cursorForQuery:(NSString *)query arguments:(nullable NSArray *)arguments batchSize:(NSUInteger)batchSize;
+    -(void)enumerateBatchesOfQuery:(NSString *)query arguments:(nullable NSArray *)arguments batchSize:(NSUInteger)batchSize usingBlock:(void (^)(NSArray<NSArray *> *rows, BOOL *stop))block;
+    -(nullable DBColumnarResult *)loadColumnsFromDB:(NSString *)query arguments:(nullable NSArray *)arguments columnTypes:(const DBColumnType *)columnTypes count:(NSUInteger)columnCount;
+    -(BOOL)loadColumnsFromDB:(NSString *)query arguments:(nullable NSArray *)arguments intoResult:(DBColumnarResult *)result;
+    -(NSArray *)loadSamplesFromTable:(NSString *)table fromTime:(long long)startTime toTime:(long long)endTime;
+    -(BOOL)loadSamplesFromTable:(NSString *)table fromTime:(long long)startTime toTime:(long long)endTime intoResult:(DBColumnarResult *)result;
+    -(BOOL)loadStatesOfAllTracksAtTime:(long long)time maximumAge:(long long)maximumAge intoResult:(DBColumnarResult *)result;
+    -(BOOL)loadHistoryOfTrack:(long long)trackId fromTime:(long long)startTime toTime:(long long)endTime intoResult:(DBColumnarResult *)result;
     -(void)executeQuery:(NSString *)query;
+    -(void)executeQuery:(NSString *)query arguments:(nullable NSArray *)arguments;
+    -(void)closeDatabase;
 @end
 
 NS_ASSUME_NONNULL_END
@@ -7,6 +7,24 @@
 //
 
 #import "DBManager.h"
+#import "DBConnection.h"
+#import "DBConnectionPool.h"
+#import "DBTrackStoreMigrator.h"
+
+@interface DBManager ()
+
+    @property (nonatomic, readwrite) NSString *databasePath;
+    @property (nonatomic, readwrite, getter=isOpenedInPlace) BOOL openedInPlace;
+    // user_version of the bundled file while it is read in place.
+    @property (nonatomic) int inPlaceSchemaVersion;
+
+    // The single read-write connection. It is only used on writerQueue.
+    @property (nonatomic, strong, nullable) DBConnection *writerConnection;
+    @property (nonatomic, strong) dispatch_queue_t writerQueue;
+
+    // Read-only connections shared by concurrent queries.
+    @property (nonatomic, strong, nullable) DBConnectionPool *readerPool;
+@end
 
 @implementation DBManager
 
@@ -20,8 +38,30 @@
         // Keep the database filename.
         self.databaseFilename = dbFilename;
         
-        // Copy the database file into the documents directory if necessary.
-        [self copyDatabaseIntoDocumentsDirectory];
+        // Serialize writes on one connection and let reads run on up to one connection per core.
+        self.writerQueue = dispatch_queue_create("DBManager.writer", DISPATCH_QUEUE_SERIAL);
+        self.readerConnectionCount = [[NSProcessInfo processInfo] activeProcessorCount];
+        
+        // Keep a bounded number of compiled statements per connection.
+        self.statementCacheCapacity = DBConnectionDefaultStatementCacheCapacity;
+        
+        // Read a bundled database where it is until the first write, so opening does not depend on its size.
+        NSString *documentsPath = [self.documentsDirectory stringByAppendingPathComponent:self.databaseFilename];
+        NSString *bundledPath = [[[NSBundle mainBundle] resourcePath] stringByAppendingPathComponent:self.databaseFilename];
+        if (![[NSFileManager defaultManager] fileExistsAtPath:documentsPath] && [[NSFileManager defaultManager] fileExistsAtPath:bundledPath]) {
+            self.databasePath = bundledPath;
+            self.openedInPlace = YES;
+            
+            // An older recording is read as it is, TRAF/OWN without clustering; it is migrated when the
+            // first write promotes it. Reading the version only looks at the header page.
+            self.inPlaceSchemaVersion = [DBTrackStoreMigrator schemaVersionOfDatabaseAtPath:bundledPath];
+        }
+        else {
+            self.databasePath = documentsPath;
+            
+            // Rewrite older recordings up to the current track store schema.
+            [self migrateTrackStoreIfNeeded];
+        }
     }
     return self;
 }
@@ -42,119 +82,351 @@
     }
 }
     
--(void)runQuery:(const char *)query isQueryExecutable:(BOOL)queryExecutable{
-    // Create a sqlite object.
-    sqlite3 *sqlite3Database;
-    
-    // Set the database file path.
-    NSString *databasePath = [self.documentsDirectory stringByAppendingPathComponent:self.databaseFilename];
-    
-    // Initialize the results array.
-    if (self.arrResults != nil) {
-        [self.arrResults removeAllObjects];
-        self.arrResults = nil;
-    }
-    self.arrResults = [[NSMutableArray alloc] init];
-    
-    // Initialize the column names array.
-    if (self.arrColumnNames != nil) {
-        [self.arrColumnNames removeAllObjects];
-        self.arrColumnNames = nil;
-    }
-    self.arrColumnNames = [[NSMutableArray alloc] init];
-    
-    
-    // Open the database.
-    BOOL openDatabaseResult = sqlite3_open([databasePath UTF8String], &sqlite3Database);
-    if(openDatabaseResult == SQLITE_OK) {
-        // Declare a sqlite3_stmt object in which will be stored the query after having been compiled into a SQLite statement.
-        sqlite3_stmt *compiledStatement;
-        
-        // Load all data from database to memory.
-        BOOL prepareStatementResult = sqlite3_prepare_v2(sqlite3Database, query, -1, &compiledStatement, NULL);
-        if(prepareStatementResult == SQLITE_OK) {
-            // Check if the query is non-executable.
-            if (!queryExecutable){
-                // In this case data must be loaded from the database.
-                
-                // Declare an array to keep the data for each fetched row.
-                NSMutableArray *arrDataRow;
-                
-                // Loop through the results and add them to the results array row by row.
-                while(sqlite3_step(compiledStatement) == SQLITE_ROW) {
-                    // Initialize the mutable array that will contain the data of a fetched row.
-                    arrDataRow = [[NSMutableArray alloc] init];
-                    
-                    // Get the total number of columns.
-                    int totalColumns = sqlite3_column_count(compiledStatement);
-                    
-                    // Go through all columns and fetch each column data.
-                    for (int i=0; i<totalColumns; i++){
-                        // Convert the column data to text (characters).
-                        char *dbDataAsChars = (char *)sqlite3_column_text(compiledStatement, i);
-                        
-                        // If there are contents in the currenct column (field) then add them to the current row array.
-                        if (dbDataAsChars != NULL) {
-                            // Convert the characters to string.
-                            [arrDataRow addObject:[NSString  stringWithUTF8String:dbDataAsChars]];
-                        }
-                        
-                        // Keep the current column name.
-                        if (self.arrColumnNames.count != totalColumns) {
-                            dbDataAsChars = (char *)sqlite3_column_name(compiledStatement, i);
-                            [self.arrColumnNames addObject:[NSString stringWithUTF8String:dbDataAsChars]];
-                        }
-                    }
-                    
-                    // Store each fetched data row in the results array, but first check if there is actually data.
-                    if (arrDataRow.count > 0) {
-                        [self.arrResults addObject:arrDataRow];
-                    }
-                }
+-(BOOL)migrateTrackStoreIfNeeded{
+    // The bundle cannot be modified; its copy is migrated when it is promoted.
+    NSString *databasePath = self.databasePath;
+    if (self.openedInPlace || [DBTrackStoreMigrator schemaVersionOfDatabaseAtPath:databasePath] >= DBTrackStoreCurrentSchemaVersion) {
+        return YES;
+    }
+    
+    // The migration replaces the tables, so drop any statements compiled against the old ones.
+    [self closeDatabase];
+    return [DBTrackStoreMigrator migrateDatabaseAtPath:databasePath];
+}
+
+-(BOOL)promoteToWritableCopyIfNeeded{
+    @synchronized (self) {
+        if (!self.openedInPlace) {
+            return YES;
+        }
+        
+        // Stop handing out connections to the bundled file; queries already running finish on it.
+        [self.readerPool close];
+        self.readerPool = nil;
+        
+        // Copy the database file into the documents directory and switch every new connection to it.
+        [self copyDatabaseIntoDocumentsDirectory];
+        NSString *documentsPath = [self.documentsDirectory stringByAppendingPathComponent:self.databaseFilename];
+        if (![[NSFileManager defaultManager] fileExistsAtPath:documentsPath]) {
+            return NO;
+        }
+        self.databasePath = documentsPath;
+        self.openedInPlace = NO;
+        return [self migrateTrackStoreIfNeeded];
+    }
+}
+    
+-(DBConnection *)openWriterConnection{
+    // Open the database on first use and keep the connection for the lifetime of the manager.
+    @synchronized (self) {
+        if (self.writerConnection == nil) {
+            // The first write needs a copy of a bundled database it can modify.
+            if (![self promoteToWritableCopyIfNeeded]) {
+                return nil;
+            }
+            DBConnection *connection = [[DBConnection alloc] initWithDatabasePath:self.databasePath flags:SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX];
+            
+            // WAL lets the readers keep going while the writer appends.
+            if (connection != nil && sqlite3_exec(connection.database, "PRAGMA journal_mode=WAL", NULL, NULL, NULL) != SQLITE_OK) {
+                NSLog(@"DB Error: %s", sqlite3_errmsg(connection.database));
+            }
+            connection.statementCacheCapacity = self.statementCacheCapacity;
+            self.writerConnection = connection;
+        }
+        return self.writerConnection;
+    }
+}
+
+-(DBConnectionPool *)openReaderPool{
+    @synchronized (self) {
+        if (self.readerPool == nil) {
+            if (self.openedInPlace) {
+                // immutable=1 tells SQLite the bundled file can never change, so readers take no locks
+                // and never look for a journal next to it.
+                NSString *databaseURI = [[[NSURL fileURLWithPath:self.databasePath] absoluteString] stringByAppendingString:@"?immutable=1"];
+                self.readerPool = [[DBConnectionPool alloc] initWithDatabasePath:databaseURI flags:SQLITE_OPEN_READONLY | SQLITE_OPEN_URI capacity:self.readerConnectionCount];
             }
             else {
-                // This is the case of an executable query (insert, update, ...).
-                
-                // Execute the query.
-                BOOL executeQueryResults = sqlite3_step(compiledStatement);
-                if (executeQueryResults == SQLITE_DONE) {
-                    // Keep the affected rows.
-                    self.affectedRows = sqlite3_changes(sqlite3Database);
-                    
-                    // Keep the last inserted row ID.
-                    self.lastInsertedRowID = sqlite3_last_insert_rowid(sqlite3Database);
-                }
-                else {
-                    // If could not execute the query show the error message on the debugger.
-                    NSLog(@"DB Error: %s", sqlite3_errmsg(sqlite3Database));
+                // The writer puts the file into WAL mode before any reader opens it.
+                if ([self openWriterConnection] == nil) {
+                    return nil;
                 }
+                self.readerPool = [[DBConnectionPool alloc] initWithDatabasePath:self.databasePath flags:SQLITE_OPEN_READONLY capacity:self.readerConnectionCount];
             }
+            self.readerPool.statementCacheCapacity = self.statementCacheCapacity;
         }
-        else {
-            // In the database cannot be opened then show the error message on the debugger.
-            NSLog(@"%s", sqlite3_errmsg(sqlite3Database));
+        return self.readerPool;
+    }
+}
+
+-(void)setStatementCacheCapacity:(NSUInteger)statementCacheCapacity{
+    @synchronized (self) {
+        _statementCacheCapacity = statementCacheCapacity;
+        self.readerPool.statementCacheCapacity = statementCacheCapacity;
+        DBConnection *writerConnection = self.writerConnection;
+        dispatch_async(self.writerQueue, ^{
+            writerConnection.statementCacheCapacity = statementCacheCapacity;
+        });
+    }
+}
+
+-(void)closeDatabase{
+    DBConnection *writerConnection;
+    @synchronized (self) {
+        [self.readerPool close];
+        self.readerPool = nil;
+        writerConnection = self.writerConnection;
+        self.writerConnection = nil;
+    }
+    
+    // Let any write already queued finish before closing the handle under it.
+    if (writerConnection != nil) {
+        dispatch_sync(self.writerQueue, ^{
+            [writerConnection close];
+        });
+    }
+}
+
+-(void)dealloc{
+    [self closeDatabase];
+}
+
+-(DBConnection *)acquireReaderConnectionFromPool:(DBConnectionPool **)readerPool{
+    // A promotion can close the pool between fetching it and acquiring from it; retry once on its replacement.
+    for (int attempt=0; attempt<2; attempt++) {
+        DBConnectionPool *pool = [self openReaderPool];
+        DBConnection *connection = [pool acquireConnection];
+        if (connection != nil) {
+            *readerPool = pool;
+            return connection;
+        }
+    }
+    return nil;
+}
+
+-(DBQueryResult *)resultOfQuery:(NSString *)query arguments:(NSArray *)arguments{
+    // Borrow a read-only connection for the duration of the query.
+    DBConnectionPool *readerPool;
+    DBConnection *connection = [self acquireReaderConnectionFromPool:&readerPool];
+    if (connection == nil) {
+        return [DBQueryResult failedResult];
+    }
+    
+    // Load the data from the database, one batch of rows at a time.
+    DBQueryResult *result = [DBQueryResult failedResult];
+    DBCursor *cursor = [[DBCursor alloc] initWithConnection:connection query:[query UTF8String] arguments:arguments batchSize:DBCursorDefaultBatchSize];
+    if (cursor != nil) {
+        NSMutableArray *arrResults = [[NSMutableArray alloc] init];
+        NSArray *arrBatch;
+        while ((arrBatch = [cursor nextBatch]) != nil) {
+            [arrResults addObjectsFromArray:arrBatch];
+        }
+        result = [[DBQueryResult alloc] initWithColumnNames:cursor.columnNames rows:arrResults affectedRows:0 lastInsertedRowID:0 succeeded:YES];
+        [cursor close];
+    }
+    
+    [readerPool releaseConnection:connection];
+    return result;
+}
+
+-(DBQueryResult *)resultOfExecutingQuery:(NSString *)query arguments:(NSArray *)arguments{
+    DBConnection *connection = [self openWriterConnection];
+    if (connection == nil) {
+        return [DBQueryResult failedResult];
+    }
+    
+    // All writes go through the one writer connection, one at a time.
+    __block DBQueryResult *result = [DBQueryResult failedResult];
+    dispatch_sync(self.writerQueue, ^{
+        // Get a compiled statement for the query, reusing a cached one when the same SQL ran before.
+        sqlite3_stmt *compiledStatement = [connection acquireStatement:[query UTF8String]];
+        if (compiledStatement == NULL) {
+            return;
         }
         
-        // Release the compiled statement from memory.
-        sqlite3_finalize(compiledStatement);
+        // Bind the query parameters, if any, and execute the query.
+        if ([connection bindArguments:arguments toStatement:compiledStatement]) {
+            int executeQueryResults = sqlite3_step(compiledStatement);
+            if (executeQueryResults == SQLITE_DONE) {
+                // Keep the affected rows and the last inserted row ID.
+                result = [[DBQueryResult alloc] initWithColumnNames:@[] rows:@[]
+                                                       affectedRows:sqlite3_changes(connection.database)
+                                                  lastInsertedRowID:sqlite3_last_insert_rowid(connection.database)
+                                                          succeeded:YES];
+            }
+            else {
+                // If could not execute the query show the error message on the debugger.
+                NSLog(@"DB Error: %s", sqlite3_errmsg(connection.database));
+            }
+        }
         
-    }
+        // Hand the statement back to the connection's cache instead of finalizing it.
+        [connection releaseStatement:compiledStatement];
+    });
+    return result;
+}
+
+-(void)runQuery:(const char *)query isQueryExecutable:(BOOL)queryExecutable{
+    [self runQuery:query arguments:nil isQueryExecutable:queryExecutable];
+}
+
+-(void)runQuery:(const char *)query arguments:(NSArray *)arguments isQueryExecutable:(BOOL)queryExecutable{
+    NSString *queryString = [NSString stringWithUTF8String:query];
+    DBQueryResult *result = queryExecutable ? [self resultOfExecutingQuery:queryString arguments:arguments] : [self resultOfQuery:queryString arguments:arguments];
     
-    // Close the database.
-    sqlite3_close(sqlite3Database);
+    // Publish the result through the shared properties for callers of the original API. Callers on
+    // several queues should use the returned DBQueryResult instead.
+    @synchronized (self) {
+        self.arrResults = [result.rows mutableCopy];
+        self.arrColumnNames = [result.columnNames mutableCopy];
+        if (queryExecutable && result.succeeded) {
+            self.affectedRows = result.affectedRows;
+            self.lastInsertedRowID = result.lastInsertedRowID;
+        }
+    }
 }
     
     -(NSArray *)loadDataFromDB:(NSString *)query{
+        return [self loadDataFromDB:query arguments:nil];
+    }
+    
+    -(NSArray *)loadDataFromDB:(NSString *)query arguments:(NSArray *)arguments{
         // Run the query and indicate that is not executable.
-        // The query string is converted to a char* object.
-        [self runQuery:[query UTF8String] isQueryExecutable:NO];
+        DBQueryResult *result = [self resultOfQuery:query arguments:arguments];
+        @synchronized (self) {
+            self.arrResults = [result.rows mutableCopy];
+            self.arrColumnNames = [result.columnNames mutableCopy];
+        }
         
         // Returned the loaded results.
-        return (NSArray *)self.arrResults;
+        return result.rows;
+    }
+    
+    -(DBCursor *)cursorForQuery:(NSString *)query arguments:(NSArray *)arguments batchSize:(NSUInteger)batchSize{
+        DBConnectionPool *readerPool;
+        DBConnection *connection = [self acquireReaderConnectionFromPool:&readerPool];
+        if (connection == nil) {
+            return nil;
+        }
+        
+        // The cursor keeps the connection checked out until it is closed.
+        DBCursor *cursor = [[DBCursor alloc] initWithConnection:connection query:[query UTF8String] arguments:arguments batchSize:batchSize];
+        if (cursor == nil) {
+            [readerPool releaseConnection:connection];
+            return nil;
+        }
+        cursor.closeHandler = ^{
+            [readerPool releaseConnection:connection];
+        };
+        return cursor;
+    }
+    
+    -(void)enumerateBatchesOfQuery:(NSString *)query arguments:(NSArray *)arguments batchSize:(NSUInteger)batchSize usingBlock:(void (^)(NSArray<NSArray *> *, BOOL *))block{
+        DBCursor *cursor = [self cursorForQuery:query arguments:arguments batchSize:batchSize];
+        
+        // Hand each batch to the block and let it go before stepping the next one.
+        BOOL stop = NO;
+        while (!stop) {
+            @autoreleasepool {
+                NSArray *arrBatch = [cursor nextBatch];
+                if (arrBatch == nil) {
+                    break;
+                }
+                block(arrBatch, &stop);
+            }
+        }
+        [cursor close];
+    }
+    
+    -(DBColumnarResult *)loadColumnsFromDB:(NSString *)query arguments:(NSArray *)arguments columnTypes:(const DBColumnType *)columnTypes count:(NSUInteger)columnCount{
+        DBColumnarResult *result = [[DBColumnarResult alloc] initWithColumnTypes:columnTypes count:columnCount];
+        return [self loadColumnsFromDB:query arguments:arguments intoResult:result] ? result : nil;
+    }
+    
+    -(BOOL)loadColumnsFromDB:(NSString *)query arguments:(NSArray *)arguments intoResult:(DBColumnarResult *)result{
+        // Refill the result, keeping its buffers from any previous query.
+        [result removeAllRows];
+        
+        DBConnectionPool *readerPool;
+        DBConnection *connection = [self acquireReaderConnectionFromPool:&readerPool];
+        if (connection == nil) {
+            return NO;
+        }
+        
+        sqlite3_stmt *compiledStatement = [connection acquireStatement:[query UTF8String]];
+        if (compiledStatement == NULL) {
+            [readerPool releaseConnection:connection];
+            return NO;
+        }
+        
+        // Step through the rows, writing each typed value straight into the column buffers.
+        BOOL succeeded = [connection bindArguments:arguments toStatement:compiledStatement];
+        if (succeeded) {
+            int stepResult;
+            while ((stepResult = sqlite3_step(compiledStatement)) == SQLITE_ROW) {
+                if (![result appendRowFromStatement:compiledStatement]) {
+                    succeeded = NO;
+                    break;
+                }
+            }
+            if (succeeded && stepResult != SQLITE_DONE) {
+                NSLog(@"DB Error: %s", sqlite3_errmsg(connection.database));
+                succeeded = NO;
+            }
+        }
+        
+        [connection releaseStatement:compiledStatement];
+        [readerPool releaseConnection:connection];
+        return succeeded;
+    }
+    
+    -(NSString *)timeWindowQueryForTable:(NSString *)table{
+        // On a clustered recording this is a single range read of the table b-tree.
+        return [NSString stringWithFormat:@"select * from %@ where m_timeOfApplicability between ? and ? order by m_timeOfApplicability", table];
+    }
+    
+    -(NSArray *)loadSamplesFromTable:(NSString *)table fromTime:(long long)startTime toTime:(long long)endTime{
+        return [self loadDataFromDB:[self timeWindowQueryForTable:table] arguments:@[@(startTime), @(endTime)]];
+    }
+    
+    -(BOOL)loadSamplesFromTable:(NSString *)table fromTime:(long long)startTime toTime:(long long)endTime intoResult:(DBColumnarResult *)result{
+        return [self loadColumnsFromDB:[self timeWindowQueryForTable:table] arguments:@[@(startTime), @(endTime)] intoResult:result];
+    }
+    
+    -(BOOL)loadStatesOfAllTracksAtTime:(long long)time maximumAge:(long long)maximumAge intoResult:(DBColumnarResult *)result{
+        // SQLite fills the bare columns from the row holding max(), so each group yields the latest sample
+        // of one track. The covering time index limits the read to the window itself.
+        static NSString * const query = @"select m_trackId, max(m_timeOfApplicability), m_horizontalPosition1, m_horizontalPosition2, m_Altitude, m_horizontalVelocity1, m_horizontalVelocity2, m_verticalSpeed from TRACK where m_timeOfApplicability between ? and ? group by m_trackId";
+        return [self loadTrackColumnsFromDB:query arguments:@[@(time - maximumAge), @(time)] intoResult:result];
+    }
+    
+    -(BOOL)loadHistoryOfTrack:(long long)trackId fromTime:(long long)startTime toTime:(long long)endTime intoResult:(DBColumnarResult *)result{
+        // A single range read of the primary key.
+        static NSString * const query = @"select m_trackId, m_timeOfApplicability, m_horizontalPosition1, m_horizontalPosition2, m_Altitude, m_horizontalVelocity1, m_horizontalVelocity2, m_verticalSpeed from TRACK where m_trackId = ? and m_timeOfApplicability between ? and ? order by m_timeOfApplicability";
+        return [self loadTrackColumnsFromDB:query arguments:@[@(trackId), @(startTime), @(endTime)] intoResult:result];
+    }
+    
+    -(BOOL)loadTrackColumnsFromDB:(NSString *)query arguments:(NSArray *)arguments intoResult:(DBColumnarResult *)result{
+        // A bundled recording older than the TRACK table, read in place, holds no tracks.
+        if (self.openedInPlace && self.inPlaceSchemaVersion < DBTrackStoreMultiTargetSchemaVersion) {
+            [result removeAllRows];
+            return YES;
+        }
+        return [self loadColumnsFromDB:query arguments:arguments intoResult:result];
     }
     
     -(void)executeQuery:(NSString *)query{
+        [self executeQuery:query arguments:nil];
+    }
+    
+    -(void)executeQuery:(NSString *)query arguments:(NSArray *)arguments{
         // Run the query and indicate that is executable.
-        [self runQuery:[query UTF8String] isQueryExecutable:YES];
+        DBQueryResult *result = [self resultOfExecutingQuery:query arguments:arguments];
+        @synchronized (self) {
+            if (result.succeeded) {
+                self.affectedRows = result.affectedRows;
+                self.lastInsertedRowID = result.lastInsertedRowID;
+            }
+        }
     }
 @end
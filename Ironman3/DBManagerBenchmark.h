@@ -0,0 +1,32 @@
+//
+//  DBManagerBenchmark.h
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 21/06/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Launch argument that makes the app run the database benchmarks at startup (debug builds only).
+extern NSString * const DBManagerBenchmarkLaunchArgument;
+
+// Replays the recorded TRAF/OWN query mix and track loads and inserts against a database and logs the throughput.
+@interface DBManagerBenchmark : NSObject
+
+    +(void)runAllWithDatabaseFilename:(NSString *)dbFilename;
+    +(void)logColdStartWithDatabaseFilename:(NSString *)dbFilename;
+    +(double)queriesPerSecondOpeningPerQuery:(NSString *)dbFilename passes:(NSUInteger)passes;
+    +(double)queriesPerSecondWithCachedStatements:(NSString *)dbFilename passes:(NSUInteger)passes;
+    +(double)rowsPerSecondLoadingStrings:(NSString *)dbFilename passes:(NSUInteger)passes;
+    +(double)rowsPerSecondLoadingColumns:(NSString *)dbFilename passes:(NSUInteger)passes;
+    +(double)rowsPerSecondReadingArchive:(NSString *)dbFilename passes:(NSUInteger)passes;
+    +(double)rowsPerSecondInsertingPerQuery:(NSUInteger)sampleCount;
+    +(double)rowsPerSecondRecordingWithWriter:(NSUInteger)sampleCount;
+    +(BOOL)runConcurrentReaderStressTest:(NSString *)dbFilename readers:(NSUInteger)readerCount queriesPerReader:(NSUInteger)queriesPerReader;
+    +(BOOL)runMultiTargetBenchmarkWithTracks:(NSUInteger)trackCount duration:(NSUInteger)duration;
+@end
+
+NS_ASSUME_NONNULL_END
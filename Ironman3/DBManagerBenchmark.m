@@ -0,0 +1,441 @@
+//
+//  DBManagerBenchmark.m
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 21/06/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import "DBManagerBenchmark.h"
+#import "DBManager.h"
+#import "ironman/DBTrackArchive.h"
+#import "DBTrackStoreMigrator.h"
+#import "DBTrackWriter.h"
+#import <QuartzCore/QuartzCore.h>
+#import <stdatomic.h>
+
+NSString * const DBManagerBenchmarkLaunchArgument = @"-RunDBManagerBenchmarks";
+
+// The per-tick query mix of a 1 Hz replay: one TRAF and one OWN sample lookup by time.
+static const char *kReplayQueries[] = {
+    "select * from TRAF where m_timeOfApplicability = ?",
+    "select * from OWN where m_timeOfApplicability = ?",
+};
+static const int kReplayQueryCount = sizeof(kReplayQueries) / sizeof(kReplayQueries[0]);
+
+@implementation DBManagerBenchmark
+
++(void)runAllWithDatabaseFilename:(NSString *)dbFilename{
+    NSUInteger passes = 200;
+
+    [self logColdStartWithDatabaseFilename:dbFilename];
+
+    double before = [self queriesPerSecondOpeningPerQuery:dbFilename passes:passes];
+    double after = [self queriesPerSecondWithCachedStatements:dbFilename passes:passes];
+    NSLog(@"Replay query mix on %@: %.0f queries/sec opening per query, %.0f queries/sec with cached statements (%.1fx)",
+          dbFilename, before, after, before > 0 ? after / before : 0);
+
+    double stringRows = [self rowsPerSecondLoadingStrings:dbFilename passes:passes];
+    double columnRows = [self rowsPerSecondLoadingColumns:dbFilename passes:passes];
+    NSLog(@"Track load on %@: %.0f rows/sec as NSString rows, %.0f rows/sec as typed columns (%.1fx)",
+          dbFilename, stringRows, columnRows, stringRows > 0 ? columnRows / stringRows : 0);
+
+    double archiveRows = [self rowsPerSecondReadingArchive:dbFilename passes:passes];
+    NSLog(@"Track load on %@: %.0f rows/sec opening the mapped .trk archive each pass (%.1fx typed columns)",
+          dbFilename, archiveRows, columnRows > 0 ? archiveRows / columnRows : 0);
+
+    // Measure the bundled recording, which is still in the recorder's original layout.
+    NSString *bundledPath = [[[NSBundle mainBundle] resourcePath] stringByAppendingPathComponent:dbFilename];
+    [DBTrackStoreMigrator logClusteringIOReductionForDatabaseAtPath:bundledPath];
+
+    double perQueryRows = [self rowsPerSecondInsertingPerQuery:2000];
+    double writerRows = [self rowsPerSecondRecordingWithWriter:200000];
+    NSLog(@"Recording: %.0f rows/sec with one executeQuery: per row, %.0f rows/sec with DBTrackWriter (%.1fx)",
+          perQueryRows, writerRows, perQueryRows > 0 ? writerRows / perQueryRows : 0);
+
+    [self runConcurrentReaderStressTest:dbFilename readers:64 queriesPerReader:2000];
+
+    [self runMultiTargetBenchmarkWithTracks:1000 duration:3600];
+}
+
++(void)logColdStartWithDatabaseFilename:(NSString *)dbFilename{
+    // Time from creating the manager to the first row, reading the bundled file in place. Nothing is
+    // copied or migrated on this path, whatever the bundled recording's schema.
+    CFTimeInterval start = CACurrentMediaTime();
+    DBManager *dbManager = [[DBManager alloc] initWithDatabaseFilename:dbFilename];
+    [dbManager resultOfQuery:@"select * from OWN order by m_timeOfApplicability limit 1" arguments:nil];
+    CFTimeInterval inPlaceElapsed = CACurrentMediaTime() - start;
+    BOOL openedInPlace = dbManager.openedInPlace;
+    [dbManager closeDatabase];
+
+    // The same with the copy into Documents that every first launch used to make, on a scratch name.
+    NSString *scratchFilename = [self scratchDatabaseFilename];
+    NSString *scratchPath = [dbManager.documentsDirectory stringByAppendingPathComponent:scratchFilename];
+    NSString *bundledPath = [[[NSBundle mainBundle] resourcePath] stringByAppendingPathComponent:dbFilename];
+    start = CACurrentMediaTime();
+    [[NSFileManager defaultManager] copyItemAtPath:bundledPath toPath:scratchPath error:nil];
+    DBManager *copiedManager = [[DBManager alloc] initWithDatabaseFilename:scratchFilename];
+    [copiedManager resultOfQuery:@"select * from OWN order by m_timeOfApplicability limit 1" arguments:nil];
+    CFTimeInterval copiedElapsed = CACurrentMediaTime() - start;
+    [copiedManager closeDatabase];
+    [self removeScratchDatabaseAtPath:scratchPath];
+
+    NSLog(@"Cold start on %@: %.2f ms to first row %@, %.2f ms copying into Documents first",
+          dbFilename, inPlaceElapsed * 1000, openedInPlace ? @"reading the bundle in place" : @"from an existing Documents copy", copiedElapsed * 1000);
+}
+
++(DBTrackSample)syntheticSampleAtIndex:(NSUInteger)index{
+    // A target circling near the recorded F-15 track, one sample per time step.
+    double angle = index * 0.001;
+    DBTrackSample sample = {
+        .timeOfApplicability = 1540233423 + (int64_t)index,
+        .latitude = 33.7 + 0.05 * sin(angle),
+        .longitude = -112.75 + 0.05 * cos(angle),
+        .altitude = 5000 + 100 * sin(angle * 3),
+        .horizontalVelocity1 = 105,
+        .horizontalVelocity2 = fmod(angle * 57.29577951308232 + 90, 360),
+        .verticalSpeed = 300 * cos(angle * 3),
+    };
+    return sample;
+}
+
++(NSString *)scratchDatabaseFilename{
+    return [NSString stringWithFormat:@"benchmark-%@.db", [[NSUUID UUID] UUIDString]];
+}
+
++(void)removeScratchDatabaseAtPath:(NSString *)databasePath{
+    for (NSString *suffix in @[@"", @"-wal", @"-shm", @"-journal"]) {
+        [[NSFileManager defaultManager] removeItemAtPath:[databasePath stringByAppendingString:suffix] error:nil];
+    }
+}
+
++(double)rowsPerSecondInsertingPerQuery:(NSUInteger)sampleCount{
+    NSString *dbFilename = [self scratchDatabaseFilename];
+    DBManager *dbManager = [[DBManager alloc] initWithDatabaseFilename:dbFilename];
+    [dbManager executeQuery:@"CREATE TABLE TRAF(m_timeOfApplicability INTEGER PRIMARY KEY,m_horizontalPosition1 FLOAT,m_horizontalPosition2 FLOAT,m_Altitude FLOAT,m_horizontalVelocity1 FLOAT,m_horizontalVelocity2 FLOAT,m_verticalSpeed FLOAT)"];
+
+    // Each insert commits its own implicit transaction.
+    NSString *query = @"INSERT INTO TRAF VALUES(?,?,?,?,?,?,?)";
+    CFTimeInterval start = CACurrentMediaTime();
+    for (NSUInteger i=0; i<sampleCount; i++) {
+        @autoreleasepool {
+            DBTrackSample sample = [self syntheticSampleAtIndex:i];
+            [dbManager executeQuery:query arguments:@[@(sample.timeOfApplicability), @(sample.latitude), @(sample.longitude), @(sample.altitude),
+                                                      @(sample.horizontalVelocity1), @(sample.horizontalVelocity2), @(sample.verticalSpeed)]];
+        }
+    }
+    CFTimeInterval elapsed = CACurrentMediaTime() - start;
+
+    NSString *databasePath = dbManager.databasePath;
+    [dbManager closeDatabase];
+    [self removeScratchDatabaseAtPath:databasePath];
+    return elapsed > 0 ? sampleCount / elapsed : 0;
+}
+
++(double)rowsPerSecondRecordingWithWriter:(NSUInteger)sampleCount{
+    NSString *databasePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[self scratchDatabaseFilename]];
+    DBTrackWriter *writer = [[DBTrackWriter alloc] initWithDatabasePath:databasePath];
+
+    // Time from the first append until everything is committed.
+    CFTimeInterval start = CACurrentMediaTime();
+    for (NSUInteger i=0; i<sampleCount; i++) {
+        [writer appendTrafficSample:[self syntheticSampleAtIndex:i]];
+    }
+    [writer flushAndWait];
+    CFTimeInterval elapsed = CACurrentMediaTime() - start;
+
+    [writer close];
+    [self removeScratchDatabaseAtPath:databasePath];
+    return elapsed > 0 ? sampleCount / elapsed : 0;
+}
+
++(NSArray<NSNumber *> *)replayTimestamps:(DBManager *)dbManager{
+    // Every recorded tick of either table, in replay order.
+    NSArray *rows = [dbManager loadDataFromDB:@"select m_timeOfApplicability from OWN union select m_timeOfApplicability from TRAF order by 1"];
+    NSMutableArray<NSNumber *> *timestamps = [[NSMutableArray alloc] initWithCapacity:rows.count];
+    for (NSArray *row in rows) {
+        [timestamps addObject:@([row[0] longLongValue])];
+    }
+    return timestamps;
+}
+
++(double)queriesPerSecondOpeningPerQuery:(NSString *)dbFilename passes:(NSUInteger)passes{
+    DBManager *dbManager = [[DBManager alloc] initWithDatabaseFilename:dbFilename];
+    NSArray<NSNumber *> *timestamps = [self replayTimestamps:dbManager];
+    // The file the manager reads, which is the bundled recording until something writes to it. It is
+    // opened read-only so a missing file fails rather than being created empty.
+    NSString *databasePath = dbManager.databasePath;
+    [dbManager closeDatabase];
+
+    // Reproduce the open/prepare/step/finalize/close cycle of a connection-per-query manager.
+    NSUInteger queryCount = 0;
+    CFTimeInterval start = CACurrentMediaTime();
+    for (NSUInteger pass=0; pass<passes; pass++) {
+        for (NSNumber *timestamp in timestamps) {
+            for (int q=0; q<kReplayQueryCount; q++) {
+                @autoreleasepool {
+                    sqlite3 *sqlite3Database;
+                    if (sqlite3_open_v2([databasePath UTF8String], &sqlite3Database, SQLITE_OPEN_READONLY, NULL) == SQLITE_OK) {
+                        sqlite3_stmt *compiledStatement;
+                        if (sqlite3_prepare_v2(sqlite3Database, kReplayQueries[q], -1, &compiledStatement, NULL) == SQLITE_OK) {
+                            sqlite3_bind_int64(compiledStatement, 1, [timestamp longLongValue]);
+                            NSMutableArray *arrResults = [[NSMutableArray alloc] init];
+                            while (sqlite3_step(compiledStatement) == SQLITE_ROW) {
+                                NSMutableArray *arrDataRow = [[NSMutableArray alloc] init];
+                                for (int i=0; i<sqlite3_column_count(compiledStatement); i++) {
+                                    const char *dbDataAsChars = (const char *)sqlite3_column_text(compiledStatement, i);
+                                    if (dbDataAsChars != NULL) {
+                                        [arrDataRow addObject:[NSString stringWithUTF8String:dbDataAsChars]];
+                                    }
+                                }
+                                [arrResults addObject:arrDataRow];
+                            }
+                        }
+                        sqlite3_finalize(compiledStatement);
+                    }
+                    sqlite3_close(sqlite3Database);
+                    queryCount++;
+                }
+            }
+        }
+    }
+    CFTimeInterval elapsed = CACurrentMediaTime() - start;
+    return elapsed > 0 ? queryCount / elapsed : 0;
+}
+
++(double)queriesPerSecondWithCachedStatements:(NSString *)dbFilename passes:(NSUInteger)passes{
+    DBManager *dbManager = [[DBManager alloc] initWithDatabaseFilename:dbFilename];
+    NSArray<NSNumber *> *timestamps = [self replayTimestamps:dbManager];
+
+    NSString *queries[kReplayQueryCount];
+    for (int q=0; q<kReplayQueryCount; q++) {
+        queries[q] = [NSString stringWithUTF8String:kReplayQueries[q]];
+    }
+
+    NSUInteger queryCount = 0;
+    CFTimeInterval start = CACurrentMediaTime();
+    for (NSUInteger pass=0; pass<passes; pass++) {
+        for (NSNumber *timestamp in timestamps) {
+            for (int q=0; q<kReplayQueryCount; q++) {
+                @autoreleasepool {
+                    [dbManager loadDataFromDB:queries[q] arguments:@[timestamp]];
+                    queryCount++;
+                }
+            }
+        }
+    }
+    CFTimeInterval elapsed = CACurrentMediaTime() - start;
+    return elapsed > 0 ? queryCount / elapsed : 0;
+}
+
++(double)rowsPerSecondLoadingStrings:(NSString *)dbFilename passes:(NSUInteger)passes{
+    DBManager *dbManager = [[DBManager alloc] initWithDatabaseFilename:dbFilename];
+
+    // Load each track and parse the numbers back out of the strings, as callers of loadDataFromDB: must.
+    NSUInteger rowCount = 0;
+    double checksum = 0;
+    CFTimeInterval start = CACurrentMediaTime();
+    for (NSUInteger pass=0; pass<passes; pass++) {
+        for (NSString *table in @[@"TRAF", @"OWN"]) {
+            @autoreleasepool {
+                NSArray *rows = [dbManager loadDataFromDB:[NSString stringWithFormat:@"select * from %@ order by m_timeOfApplicability", table]];
+                for (NSArray *row in rows) {
+                    checksum += [row[1] doubleValue] + [row[2] doubleValue] + [row[3] doubleValue];
+                }
+                rowCount += rows.count;
+            }
+        }
+    }
+    CFTimeInterval elapsed = CACurrentMediaTime() - start;
+    NSLog(@"String load checksum %f", checksum);
+    return elapsed > 0 ? rowCount / elapsed : 0;
+}
+
++(double)rowsPerSecondLoadingColumns:(NSString *)dbFilename passes:(NSUInteger)passes{
+    DBManager *dbManager = [[DBManager alloc] initWithDatabaseFilename:dbFilename];
+    DBColumnarResult *result = [[DBColumnarResult alloc] initWithColumnTypes:DBTrackSampleColumnTypes count:DBTrackSampleColumnCount];
+
+    // Refill the same result each pass so the buffers are allocated once.
+    NSUInteger rowCount = 0;
+    double checksum = 0;
+    CFTimeInterval start = CACurrentMediaTime();
+    for (NSUInteger pass=0; pass<passes; pass++) {
+        for (NSString *table in @[@"TRAF", @"OWN"]) {
+            [dbManager loadColumnsFromDB:[NSString stringWithFormat:@"select * from %@ order by m_timeOfApplicability", table] arguments:nil intoResult:result];
+            const double *latitudes = [result doubleColumnAtIndex:1];
+            const double *longitudes = [result doubleColumnAtIndex:2];
+            const double *altitudes = [result doubleColumnAtIndex:3];
+            for (NSUInteger row=0; row<result.rowCount; row++) {
+                checksum += latitudes[row] + longitudes[row] + altitudes[row];
+            }
+            rowCount += result.rowCount;
+        }
+    }
+    CFTimeInterval elapsed = CACurrentMediaTime() - start;
+    NSLog(@"Column load checksum %f", checksum);
+    return elapsed > 0 ? rowCount / elapsed : 0;
+}
+
++(double)rowsPerSecondReadingArchive:(NSString *)dbFilename passes:(NSUInteger)passes{
+    // Convert the bundled recording once, as the app would when a recording is finished.
+    NSString *databasePath = [[[NSBundle mainBundle] resourcePath] stringByAppendingPathComponent:dbFilename];
+    NSString *archivePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[[dbFilename stringByDeletingPathExtension] stringByAppendingPathExtension:@"trk"]];
+    if (DBTrackArchiveWriteFromDatabase([databasePath UTF8String], [archivePath UTF8String]) != 0) {
+        return 0;
+    }
+
+    // Open, read and close the archive every pass so the cost of opening is included.
+    NSUInteger rowCount = 0;
+    double checksum = 0;
+    CFTimeInterval start = CACurrentMediaTime();
+    for (NSUInteger pass=0; pass<passes; pass++) {
+        DBTrackArchive *archive = DBTrackArchiveOpen([archivePath UTF8String]);
+        if (archive == NULL) {
+            break;
+        }
+        for (int table=0; table<DBTrackArchiveTableCount; table++) {
+            DBTrackArchiveSpan span = DBTrackArchiveGetTable(archive, table);
+            const double *latitudes = span.columns[DBTrackArchiveColumnLatitude];
+            const double *longitudes = span.columns[DBTrackArchiveColumnLongitude];
+            const double *altitudes = span.columns[DBTrackArchiveColumnAltitude];
+            for (size_t row=0; row<span.count; row++) {
+                checksum += latitudes[row] + longitudes[row] + altitudes[row];
+            }
+            rowCount += span.count;
+        }
+        DBTrackArchiveClose(archive);
+    }
+    CFTimeInterval elapsed = CACurrentMediaTime() - start;
+    NSLog(@"Archive load checksum %f", checksum);
+
+    [[NSFileManager defaultManager] removeItemAtPath:archivePath error:nil];
+    return elapsed > 0 ? rowCount / elapsed : 0;
+}
+
++(BOOL)runConcurrentReaderStressTest:(NSString *)dbFilename readers:(NSUInteger)readerCount queriesPerReader:(NSUInteger)queriesPerReader{
+    // Run against a scratch copy of the recording so the writer never touches the real one.
+    NSString *scratchFilename = [self scratchDatabaseFilename];
+    NSString *documentsDirectory = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject;
+    NSString *scratchPath = [documentsDirectory stringByAppendingPathComponent:scratchFilename];
+    NSString *sourcePath = [[[NSBundle mainBundle] resourcePath] stringByAppendingPathComponent:dbFilename];
+    if (![[NSFileManager defaultManager] copyItemAtPath:sourcePath toPath:scratchPath error:nil]) {
+        return NO;
+    }
+    DBManager *dbManager = [[DBManager alloc] initWithDatabaseFilename:scratchFilename];
+    [dbManager executeQuery:@"CREATE TABLE STRESS_LOG(id INTEGER PRIMARY KEY, reader INTEGER)"];
+
+    // Every reader checks its rows against one load of the whole recording.
+    NSArray<NSString *> *tables = @[@"TRAF", @"OWN"];
+    NSMutableArray<NSDictionary<NSNumber *, NSArray *> *> *expectedRows = [[NSMutableArray alloc] init];
+    for (NSString *table in tables) {
+        NSMutableDictionary<NSNumber *, NSArray *> *rowsByTime = [[NSMutableDictionary alloc] init];
+        for (NSArray *row in [dbManager resultOfQuery:[NSString stringWithFormat:@"select * from %@", table] arguments:nil].rows) {
+            rowsByTime[@([row[0] longLongValue])] = row;
+        }
+        [expectedRows addObject:rowsByTime];
+    }
+
+    __block atomic_ulong mismatches = 0;
+    __block atomic_ulong writes = 0;
+    __block atomic_bool readersFinished = false;
+
+    // A single writer keeps appending while the readers run.
+    dispatch_group_t writerGroup = dispatch_group_create();
+    dispatch_group_async(writerGroup, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        while (!atomic_load(&readersFinished)) {
+            [dbManager resultOfExecutingQuery:@"INSERT INTO STRESS_LOG(reader) VALUES(?)" arguments:@[@(-1)]];
+            atomic_fetch_add(&writes, 1);
+        }
+    });
+
+    CFTimeInterval start = CACurrentMediaTime();
+    dispatch_apply(readerCount, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t reader) {
+        for (NSUInteger i=0; i<queriesPerReader; i++) {
+            @autoreleasepool {
+                NSUInteger tableIndex = (reader + i) % tables.count;
+                NSArray<NSNumber *> *times = expectedRows[tableIndex].allKeys;
+                NSNumber *time = times[arc4random_uniform((uint32_t)times.count)];
+                NSString *query = [NSString stringWithFormat:@"select * from %@ where m_timeOfApplicability = ?", tables[tableIndex]];
+                DBQueryResult *result = [dbManager resultOfQuery:query arguments:@[time]];
+                if (!result.succeeded || result.rows.count != 1 || ![result.rows[0] isEqualToArray:expectedRows[tableIndex][time]]) {
+                    atomic_fetch_add(&mismatches, 1);
+                }
+            }
+        }
+    });
+    CFTimeInterval elapsed = CACurrentMediaTime() - start;
+    atomic_store(&readersFinished, true);
+    dispatch_group_wait(writerGroup, DISPATCH_TIME_FOREVER);
+
+    unsigned long totalQueries = readerCount * queriesPerReader;
+    NSLog(@"Concurrent readers: %lu readers, %.0f queries/sec, %lu mismatched results, %lu writes committed meanwhile",
+          (unsigned long)readerCount, elapsed > 0 ? totalQueries / elapsed : 0, atomic_load(&mismatches), atomic_load(&writes));
+
+    [dbManager closeDatabase];
+    [self removeScratchDatabaseAtPath:scratchPath];
+    return atomic_load(&mismatches) == 0;
+}
+
++(BOOL)runMultiTargetBenchmarkWithTracks:(NSUInteger)trackCount duration:(NSUInteger)duration{
+    // Record every track at 1 Hz into a scratch TRACK store, one tick at a time as a live feed would.
+    // Scratch files are never bundled, so the manager below reads this one from the documents directory.
+    NSString *dbFilename = [self scratchDatabaseFilename];
+    NSString *documentsDirectory = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject;
+    NSString *databasePath = [documentsDirectory stringByAppendingPathComponent:dbFilename];
+    DBTrackWriter *writer = [[DBTrackWriter alloc] initWithDatabasePath:databasePath];
+    if (writer == nil) {
+        return NO;
+    }
+
+    DBTrackSample *tick = malloc(trackCount * sizeof(DBTrackSample));
+    CFTimeInterval start = CACurrentMediaTime();
+    for (NSUInteger t=0; t<duration; t++) {
+        for (NSUInteger track=0; track<trackCount; track++) {
+            tick[track] = [self syntheticSampleAtIndex:t + track * 97];
+            tick[track].trackId = (int64_t)track;
+            tick[track].timeOfApplicability = 1540233423 + (int64_t)t;
+        }
+        [writer appendTrackSamples:tick count:trackCount];
+    }
+    [writer flushAndWait];
+    CFTimeInterval recordElapsed = CACurrentMediaTime() - start;
+    free(tick);
+    [writer close];
+
+    DBManager *dbManager = [[DBManager alloc] initWithDatabaseFilename:dbFilename];
+    if (![dbManager.databasePath isEqualToString:databasePath]) {
+        [self removeScratchDatabaseAtPath:databasePath];
+        return NO;
+    }
+    [dbManager executeQuery:@"ANALYZE"];
+    BOOL succeeded = YES;
+
+    // Snapshot every target at random instants, accepting samples up to 5 seconds old.
+    NSUInteger snapshotCount = 200;
+    DBColumnarResult *states = [[DBColumnarResult alloc] initWithColumnTypes:DBTrackStateColumnTypes count:DBTrackStateColumnCount];
+    start = CACurrentMediaTime();
+    for (NSUInteger i=0; i<snapshotCount; i++) {
+        long long time = 1540233423 + 5 + arc4random_uniform((uint32_t)(duration - 5));
+        succeeded = [dbManager loadStatesOfAllTracksAtTime:time maximumAge:5 intoResult:states] && states.rowCount == trackCount && succeeded;
+    }
+    CFTimeInterval snapshotElapsed = CACurrentMediaTime() - start;
+
+    // Pull ten minute histories of random targets.
+    NSUInteger historyCount = 2000;
+    DBColumnarResult *history = [[DBColumnarResult alloc] initWithColumnTypes:DBTrackStateColumnTypes count:DBTrackStateColumnCount];
+    start = CACurrentMediaTime();
+    for (NSUInteger i=0; i<historyCount; i++) {
+        long long trackId = arc4random_uniform((uint32_t)trackCount);
+        succeeded = [dbManager loadHistoryOfTrack:trackId fromTime:1540233423 toTime:1540233423 + 599 intoResult:history] && history.rowCount == MIN(duration, (NSUInteger)600) && succeeded;
+    }
+    CFTimeInterval historyElapsed = CACurrentMediaTime() - start;
+
+    NSLog(@"Multi-target store, %lu tracks x %lu s: %.0f rows/sec recorded, %.2f ms per all-track snapshot, %.3f ms per 10 min track history, results %@",
+          (unsigned long)trackCount, (unsigned long)duration, recordElapsed > 0 ? trackCount * duration / recordElapsed : 0,
+          snapshotElapsed * 1000 / snapshotCount, historyElapsed * 1000 / historyCount, succeeded ? @"complete" : @"INCOMPLETE");
+
+    [dbManager closeDatabase];
+    [self removeScratchDatabaseAtPath:databasePath];
+    return succeeded;
+}
+@end
@@ -0,0 +1,27 @@
+//
+//  DBQueryResult.h
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 05/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// The outcome of one query. Each call returns its own immutable result, so queries running on
+// different queues never see each other's rows.
+@interface DBQueryResult : NSObject
+
+    @property (nonatomic, readonly) NSArray<NSString *> *columnNames;
+    @property (nonatomic, readonly) NSArray<NSArray *> *rows;
+    @property (nonatomic, readonly) int affectedRows;
+    @property (nonatomic, readonly) long long lastInsertedRowID;
+    @property (nonatomic, readonly) BOOL succeeded;
+
+    -(instancetype)initWithColumnNames:(NSArray<NSString *> *)columnNames rows:(NSArray<NSArray *> *)rows affectedRows:(int)affectedRows lastInsertedRowID:(long long)lastInsertedRowID succeeded:(BOOL)succeeded;
+    +(instancetype)failedResult;
+@end
+
+NS_ASSUME_NONNULL_END
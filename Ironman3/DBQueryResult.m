@@ -0,0 +1,28 @@
+//
+//  DBQueryResult.m
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 05/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import "DBQueryResult.h"
+
+@implementation DBQueryResult
+
+-(instancetype)initWithColumnNames:(NSArray<NSString *> *)columnNames rows:(NSArray<NSArray *> *)rows affectedRows:(int)affectedRows lastInsertedRowID:(long long)lastInsertedRowID succeeded:(BOOL)succeeded{
+    self = [super init];
+    if (self) {
+        _columnNames = [columnNames copy];
+        _rows = [rows copy];
+        _affectedRows = affectedRows;
+        _lastInsertedRowID = lastInsertedRowID;
+        _succeeded = succeeded;
+    }
+    return self;
+}
+
++(instancetype)failedResult{
+    return [[self alloc] initWithColumnNames:@[] rows:@[] affectedRows:0 lastInsertedRowID:0 succeeded:NO];
+}
+@end
@@ -0,0 +1,40 @@
+//
+//  DBTrackStoreMigrator.h
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 28/06/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// user_version of a recording whose TRAF/OWN tables are clustered on m_timeOfApplicability.
+extern const int DBTrackStoreClusteredSchemaVersion;
+
+// user_version of a recording that also has the multi-target TRACK table.
+extern const int DBTrackStoreMultiTargetSchemaVersion;
+
+// user_version that migrateDatabaseAtPath: brings recordings up to.
+extern const int DBTrackStoreCurrentSchemaVersion;
+
+// Creates the TRACK table keyed by (m_trackId, m_timeOfApplicability) and its time index.
+extern const char *DBTrackStoreCreateTrackTableQuery;
+
+// Brings recordings up to the current track store schema.
+// Version 1 clusters TRAF/OWN on time. The recorder declares m_timeOfApplicability as INT PRIMARY KEY,
+// which SQLite treats as a separate unique index next to a rowid table, so every time lookup probes two
+// b-trees. Declaring it INTEGER PRIMARY KEY makes the time the rowid itself, and a time-window scan
+// becomes one sequential range read of the table b-tree.
+// Version 2 adds the TRACK table, which gives samples a track id so a recording can hold any number
+// of targets.
+@interface DBTrackStoreMigrator : NSObject
+
+    +(int)schemaVersionOfDatabaseAtPath:(NSString *)databasePath;
+    +(BOOL)migrateDatabaseAtPath:(NSString *)databasePath;
+    +(long long)pagesReadScanningTable:(NSString *)table databasePath:(NSString *)databasePath fromTime:(long long)startTime toTime:(long long)endTime;
+    +(void)logClusteringIOReductionForDatabaseAtPath:(NSString *)databasePath;
+@end
+
+NS_ASSUME_NONNULL_END
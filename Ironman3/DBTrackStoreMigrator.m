@@ -0,0 +1,207 @@
+//
+//  DBTrackStoreMigrator.m
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 28/06/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import "DBTrackStoreMigrator.h"
+#import <sqlite3.h>
+
+const int DBTrackStoreClusteredSchemaVersion = 1;
+const int DBTrackStoreMultiTargetSchemaVersion = 2;
+const int DBTrackStoreCurrentSchemaVersion = DBTrackStoreMultiTargetSchemaVersion;
+
+// TRACK holds any number of targets. The primary key clusters each target's history by time, and the
+// covering time index keeps every target's state at one instant in a single contiguous range.
+const char *DBTrackStoreCreateTrackTableQuery =
+    "CREATE TABLE IF NOT EXISTS TRACK(m_trackId INTEGER NOT NULL,m_timeOfApplicability INTEGER NOT NULL,m_horizontalPosition1 FLOAT,m_horizontalPosition2 FLOAT,m_Altitude FLOAT,m_horizontalVelocity1 FLOAT,m_horizontalVelocity2 FLOAT,m_verticalSpeed FLOAT,PRIMARY KEY(m_trackId,m_timeOfApplicability)) WITHOUT ROWID;"
+    "CREATE INDEX IF NOT EXISTS TRACK_time ON TRACK(m_timeOfApplicability,m_trackId,m_horizontalPosition1,m_horizontalPosition2,m_Altitude,m_horizontalVelocity1,m_horizontalVelocity2,m_verticalSpeed);";
+
+// Tables keyed by m_timeOfApplicability that get clustered.
+static NSString * const kTimeKeyedTables[] = { @"TRAF", @"OWN" };
+static const int kTimeKeyedTableCount = sizeof(kTimeKeyedTables) / sizeof(kTimeKeyedTables[0]);
+
+static NSString * const kTimeColumn = @"m_timeOfApplicability";
+
+@implementation DBTrackStoreMigrator
+
++(BOOL)execute:(NSString *)sql onDatabase:(sqlite3 *)sqlite3Database{
+    char *errorMessage = NULL;
+    if (sqlite3_exec(sqlite3Database, [sql UTF8String], NULL, NULL, &errorMessage) != SQLITE_OK) {
+        NSLog(@"DB Error: %s", errorMessage);
+        sqlite3_free(errorMessage);
+        return NO;
+    }
+    return YES;
+}
+
++(int)schemaVersionOfDatabase:(sqlite3 *)sqlite3Database{
+    int schemaVersion = 0;
+    sqlite3_stmt *compiledStatement;
+    if (sqlite3_prepare_v2(sqlite3Database, "PRAGMA user_version", -1, &compiledStatement, NULL) == SQLITE_OK) {
+        if (sqlite3_step(compiledStatement) == SQLITE_ROW) {
+            schemaVersion = sqlite3_column_int(compiledStatement, 0);
+        }
+    }
+    sqlite3_finalize(compiledStatement);
+    return schemaVersion;
+}
+
++(int)schemaVersionOfDatabaseAtPath:(NSString *)databasePath{
+    sqlite3 *sqlite3Database;
+    int schemaVersion = 0;
+    if (sqlite3_open_v2([databasePath UTF8String], &sqlite3Database, SQLITE_OPEN_READONLY, NULL) == SQLITE_OK) {
+        schemaVersion = [self schemaVersionOfDatabase:sqlite3Database];
+    }
+    sqlite3_close(sqlite3Database);
+    return schemaVersion;
+}
+
++(nullable NSString *)clusteredColumnDefinitionsOfTable:(NSString *)table database:(sqlite3 *)sqlite3Database{
+    // Rebuild the column list from the existing table, turning the time column into the rowid.
+    NSString *query = [NSString stringWithFormat:@"PRAGMA table_info(%@)", table];
+    sqlite3_stmt *compiledStatement;
+    if (sqlite3_prepare_v2(sqlite3Database, [query UTF8String], -1, &compiledStatement, NULL) != SQLITE_OK) {
+        sqlite3_finalize(compiledStatement);
+        return nil;
+    }
+
+    NSMutableArray<NSString *> *columnDefinitions = [[NSMutableArray alloc] init];
+    while (sqlite3_step(compiledStatement) == SQLITE_ROW) {
+        NSString *name = [NSString stringWithUTF8String:(const char *)sqlite3_column_text(compiledStatement, 1)];
+        NSString *type = [NSString stringWithUTF8String:(const char *)sqlite3_column_text(compiledStatement, 2)];
+        if ([name isEqualToString:kTimeColumn]) {
+            [columnDefinitions addObject:[NSString stringWithFormat:@"%@ INTEGER PRIMARY KEY", name]];
+        }
+        else {
+            [columnDefinitions addObject:[NSString stringWithFormat:@"%@ %@", name, type]];
+        }
+    }
+    sqlite3_finalize(compiledStatement);
+
+    // A table that does not exist, or has no time column, is left alone.
+    if (![columnDefinitions containsObject:[NSString stringWithFormat:@"%@ INTEGER PRIMARY KEY", kTimeColumn]]) {
+        return nil;
+    }
+    return [columnDefinitions componentsJoinedByString:@","];
+}
+
++(BOOL)migrateDatabaseAtPath:(NSString *)databasePath{
+    sqlite3 *sqlite3Database;
+    if (sqlite3_open_v2([databasePath UTF8String], &sqlite3Database, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK) {
+        NSLog(@"%s", sqlite3_errmsg(sqlite3Database));
+        sqlite3_close(sqlite3Database);
+        return NO;
+    }
+
+    // Nothing to do if the recording is already current.
+    int schemaVersion = [self schemaVersionOfDatabase:sqlite3Database];
+    if (schemaVersion >= DBTrackStoreCurrentSchemaVersion) {
+        sqlite3_close(sqlite3Database);
+        return YES;
+    }
+
+    // Apply every step the recording is missing, all in one transaction.
+    BOOL succeeded = [self execute:@"BEGIN IMMEDIATE" onDatabase:sqlite3Database];
+
+    // Version 1: copy each table into its clustered replacement in time order.
+    for (int i=0; succeeded && schemaVersion < DBTrackStoreClusteredSchemaVersion && i<kTimeKeyedTableCount; i++) {
+        NSString *table = kTimeKeyedTables[i];
+        NSString *columnDefinitions = [self clusteredColumnDefinitionsOfTable:table database:sqlite3Database];
+        if (columnDefinitions == nil) {
+            continue;
+        }
+
+        NSString *clusteredTable = [table stringByAppendingString:@"_clustered"];
+        NSString *migration = [NSString stringWithFormat:
+                               @"CREATE TABLE %1$@(%2$@);"
+                               @"INSERT INTO %1$@ SELECT * FROM %3$@ WHERE %4$@ IS NOT NULL ORDER BY %4$@;"
+                               @"DROP TABLE %3$@;"
+                               @"ALTER TABLE %1$@ RENAME TO %3$@;",
+                               clusteredTable, columnDefinitions, table, kTimeColumn];
+        succeeded = [self execute:migration onDatabase:sqlite3Database];
+    }
+
+    // Version 2: add the multi-target TRACK table, seeded with the single TRAF intruder as track 0.
+    if (succeeded && schemaVersion < DBTrackStoreMultiTargetSchemaVersion) {
+        succeeded = [self execute:[NSString stringWithUTF8String:DBTrackStoreCreateTrackTableQuery] onDatabase:sqlite3Database];
+        if (succeeded && [self clusteredColumnDefinitionsOfTable:@"TRAF" database:sqlite3Database] != nil) {
+            succeeded = [self execute:@"INSERT OR IGNORE INTO TRACK SELECT 0,* FROM TRAF WHERE m_timeOfApplicability IS NOT NULL" onDatabase:sqlite3Database];
+        }
+    }
+
+    if (succeeded) {
+        NSString *setVersion = [NSString stringWithFormat:@"PRAGMA user_version = %d", DBTrackStoreCurrentSchemaVersion];
+        succeeded = [self execute:setVersion onDatabase:sqlite3Database] && [self execute:@"COMMIT" onDatabase:sqlite3Database];
+    }
+    if (!succeeded) {
+        [self execute:@"ROLLBACK" onDatabase:sqlite3Database];
+    }
+    else if (schemaVersion < DBTrackStoreClusteredSchemaVersion) {
+        // Drop the pages freed by the old tables and their autoindexes.
+        [self execute:@"VACUUM" onDatabase:sqlite3Database];
+    }
+
+    sqlite3_close(sqlite3Database);
+    return succeeded;
+}
+
++(long long)pagesReadScanningTable:(NSString *)table databasePath:(NSString *)databasePath fromTime:(long long)startTime toTime:(long long)endTime{
+    // A fresh connection starts with an empty page cache, so every cache miss is a page read from the file.
+    sqlite3 *sqlite3Database;
+    if (sqlite3_open_v2([databasePath UTF8String], &sqlite3Database, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
+        sqlite3_close(sqlite3Database);
+        return -1;
+    }
+
+    // Load the schema first so only the scan itself is counted.
+    [self schemaVersionOfDatabase:sqlite3Database];
+    int current = 0;
+    int highwater = 0;
+    sqlite3_db_status(sqlite3Database, SQLITE_DBSTATUS_CACHE_MISS, &current, &highwater, 1);
+
+    NSString *query = [NSString stringWithFormat:@"select * from %@ where %@ between ? and ?", table, kTimeColumn];
+    sqlite3_stmt *compiledStatement;
+    if (sqlite3_prepare_v2(sqlite3Database, [query UTF8String], -1, &compiledStatement, NULL) == SQLITE_OK) {
+        sqlite3_bind_int64(compiledStatement, 1, startTime);
+        sqlite3_bind_int64(compiledStatement, 2, endTime);
+        while (sqlite3_step(compiledStatement) == SQLITE_ROW) {
+        }
+    }
+    sqlite3_finalize(compiledStatement);
+
+    sqlite3_db_status(sqlite3Database, SQLITE_DBSTATUS_CACHE_MISS, &current, &highwater, 0);
+    sqlite3_close(sqlite3Database);
+    return current;
+}
+
++(void)logClusteringIOReductionForDatabaseAtPath:(NSString *)databasePath{
+    // Work on a scratch copy so the recording itself is never touched.
+    NSString *scratchPath = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    NSError *error;
+    if (![[NSFileManager defaultManager] copyItemAtPath:databasePath toPath:scratchPath error:&error]) {
+        NSLog(@"%@", [error localizedDescription]);
+        return;
+    }
+
+    // Scan every table over its whole recorded time span.
+    long long pagesBefore[kTimeKeyedTableCount];
+    for (int i=0; i<kTimeKeyedTableCount; i++) {
+        pagesBefore[i] = [self pagesReadScanningTable:kTimeKeyedTables[i] databasePath:scratchPath fromTime:0 toTime:LLONG_MAX];
+    }
+    unsigned long long bytesBefore = [[[NSFileManager defaultManager] attributesOfItemAtPath:scratchPath error:nil] fileSize];
+
+    if ([self migrateDatabaseAtPath:scratchPath]) {
+        unsigned long long bytesAfter = [[[NSFileManager defaultManager] attributesOfItemAtPath:scratchPath error:nil] fileSize];
+        for (int i=0; i<kTimeKeyedTableCount; i++) {
+            long long pagesAfter = [self pagesReadScanningTable:kTimeKeyedTables[i] databasePath:scratchPath fromTime:0 toTime:LLONG_MAX];
+            NSLog(@"%@ time-window scan: %lld pages read before clustering, %lld after", kTimeKeyedTables[i], pagesBefore[i], pagesAfter);
+        }
+        NSLog(@"%@: %llu bytes before clustering, %llu after", [databasePath lastPathComponent], bytesBefore, bytesAfter);
+    }
+
+    [[NSFileManager defaultManager] removeItemAtPath:scratchPath error:nil];
+}
+@end
@@ -0,0 +1,62 @@
+//
+//  DBTrackWriter.h
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 02/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// One recorded TRAF, OWN or TRACK row. Velocity 1 is ground speed and velocity 2 is track angle in
+// every table, whatever order the table stores them in. trackId is only stored in TRACK.
+typedef struct {
+    int64_t trackId;
+    int64_t timeOfApplicability;
+    double latitude;
+    double longitude;
+    double altitude;
+    double horizontalVelocity1;
+    double horizontalVelocity2;
+    double verticalSpeed;
+} DBTrackSample;
+
+// How hard a commit pushes data to storage.
+typedef NS_ENUM(NSInteger, DBTrackWriterDurability) {
+    // synchronous=NORMAL: a commit survives an app crash but the last batches may be lost on power loss.
+    DBTrackWriterDurabilityRelaxed,
+    // synchronous=FULL: every commit is synced before it returns.
+    DBTrackWriterDurabilityFull
+};
+
+// Default number of samples committed per transaction.
+extern const NSUInteger DBTrackWriterDefaultBatchSize;
+
+// Records live TRAF/OWN/TRACK samples. Appends only copy the sample into a buffer; full buffers, and
+// whatever is buffered every maximumLatency seconds, are committed as one transaction on a private
+// queue. The database runs in WAL mode so readers on other connections are never blocked.
+@interface DBTrackWriter : NSObject
+
+    @property (nonatomic, readonly) NSString *databasePath;
+    @property (nonatomic) NSUInteger batchSize;
+    @property (nonatomic) NSTimeInterval maximumLatency;
+    @property (nonatomic) DBTrackWriterDurability durability;
+    // Rows committed so far; a row that fails to insert is logged and not counted.
+    @property (atomic, readonly) unsigned long long committedSampleCount;
+
+    -(nullable instancetype)initWithDatabasePath:(NSString *)databasePath;
+    -(void)appendTrafficSample:(DBTrackSample)sample;
+    -(void)appendOwnshipSample:(DBTrackSample)sample;
+    -(void)appendTrafficSamples:(const DBTrackSample *)samples count:(NSUInteger)count;
+    -(void)appendTrackSample:(DBTrackSample)sample;
+    -(void)appendTrackSamples:(const DBTrackSample *)samples count:(NSUInteger)count;
+    -(void)flush;
+    -(void)flushAndWait;
+    -(void)checkpoint;
+    // Commits whatever is buffered and closes the database; every call after it does nothing.
+    -(void)close;
+@end
+
+NS_ASSUME_NONNULL_END
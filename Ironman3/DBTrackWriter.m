@@ -0,0 +1,358 @@
+//
+//  DBTrackWriter.m
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 02/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import "DBTrackWriter.h"
+#import "DBConnection.h"
+#import "DBTrackStoreMigrator.h"
+#import <os/lock.h>
+
+const NSUInteger DBTrackWriterDefaultBatchSize = 4096;
+
+// New recordings are created directly in the clustered layout.
+static const char *kCreateTablesQuery =
+    "CREATE TABLE IF NOT EXISTS TRAF(m_timeOfApplicability INTEGER PRIMARY KEY,m_horizontalPosition1 FLOAT,m_horizontalPosition2 FLOAT,m_Altitude FLOAT,m_horizontalVelocity1 FLOAT,m_horizontalVelocity2 FLOAT,m_verticalSpeed FLOAT);"
+    "CREATE TABLE IF NOT EXISTS OWN(m_timeOfApplicability INTEGER PRIMARY KEY,m_Latitude FLOAT,m_Longitude FLOAT,m_pressureAltitude FLOAT,m_horizontalVelocity2 FLOAT,m_horizontalVelocity1 FLOAT,m_verticalVelocity FLOAT);";
+
+// Tables the writer buffers samples for, in the order they are committed.
+typedef NS_ENUM(NSUInteger, DBTrackWriterTable) {
+    DBTrackWriterTableTraffic,
+    DBTrackWriterTableOwnship,
+    DBTrackWriterTableTrack,
+    DBTrackWriterTableCount
+};
+
+// Columns are named explicitly because OWN stores the two horizontal velocities in the opposite order.
+// The TRACK insert takes the track id as an eighth parameter.
+static const char * const kInsertQueries[DBTrackWriterTableCount] = {
+    "INSERT OR REPLACE INTO TRAF(m_timeOfApplicability,m_horizontalPosition1,m_horizontalPosition2,m_Altitude,m_horizontalVelocity1,m_horizontalVelocity2,m_verticalSpeed) VALUES(?,?,?,?,?,?,?)",
+    "INSERT OR REPLACE INTO OWN(m_timeOfApplicability,m_Latitude,m_Longitude,m_pressureAltitude,m_horizontalVelocity1,m_horizontalVelocity2,m_verticalVelocity) VALUES(?,?,?,?,?,?,?)",
+    "INSERT OR REPLACE INTO TRACK(m_timeOfApplicability,m_horizontalPosition1,m_horizontalPosition2,m_Altitude,m_horizontalVelocity1,m_horizontalVelocity2,m_verticalSpeed,m_trackId) VALUES(?,?,?,?,?,?,?,?)",
+};
+
+@interface DBTrackWriter ()
+
+    @property (nonatomic, readwrite) NSString *databasePath;
+    // Written on the writer queue and read from any thread.
+    @property (atomic, readwrite) unsigned long long committedSampleCount;
+    @property (nonatomic, strong) DBConnection *connection;
+
+    // Serial queue that owns the connection; all transactions run here.
+    @property (nonatomic, strong) dispatch_queue_t writerQueue;
+    @property (nonatomic, strong, nullable) dispatch_source_t flushTimer;
+
+    // Samples appended since the last hand-off to the writer queue, one buffer per DBTrackWriterTable,
+    // guarded by bufferLock.
+    @property (nonatomic, strong) NSArray<NSMutableData *> *pendingSamples;
+@end
+
+@implementation DBTrackWriter {
+    os_unfair_lock _bufferLock;
+    // Set by close, under bufferLock; every later call is a no-op.
+    BOOL _closed;
+}
+
+-(instancetype)initWithDatabasePath:(NSString *)databasePath{
+    self = [super init];
+    if (self) {
+        self.databasePath = databasePath;
+        // Bring an existing recording up to the current schema before writing to it.
+        if ([[NSFileManager defaultManager] fileExistsAtPath:databasePath] && ![DBTrackStoreMigrator migrateDatabaseAtPath:databasePath]) {
+            return nil;
+        }
+        
+        self.connection = [[DBConnection alloc] initWithDatabasePath:databasePath flags:SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX];
+        if (self.connection == nil) {
+            return nil;
+        }
+
+        // WAL lets readers keep going while a batch commits, and synchronous=NORMAL only syncs at checkpoints.
+        BOOL isNewRecording = ![self tableExists:@"TRAF"];
+        if (![self execute:"PRAGMA journal_mode=WAL"] || ![self execute:kCreateTablesQuery] || ![self execute:DBTrackStoreCreateTrackTableQuery]) {
+            [self.connection close];
+            return nil;
+        }
+        if (isNewRecording) {
+            [self execute:[[NSString stringWithFormat:@"PRAGMA user_version = %d", DBTrackStoreCurrentSchemaVersion] UTF8String]];
+        }
+
+        _bufferLock = OS_UNFAIR_LOCK_INIT;
+        self.pendingSamples = [self emptySampleBuffers];
+        self.writerQueue = dispatch_queue_create("DBTrackWriter", DISPATCH_QUEUE_SERIAL);
+        self.batchSize = DBTrackWriterDefaultBatchSize;
+        self.durability = DBTrackWriterDurabilityRelaxed;
+        self.maximumLatency = 1.0;
+    }
+    return self;
+}
+
+-(void)dealloc{
+    // The last reference can go from a block running on the writer queue, so the final commit and
+    // close are queued behind the pending batches instead of waited for.
+    if (_writerQueue == nil || _closed) {
+        return;
+    }
+    if (_flushTimer != nil) {
+        dispatch_source_cancel(_flushTimer);
+    }
+    NSArray<NSMutableData *> *pendingSamples = _pendingSamples;
+    DBConnection *connection = _connection;
+    dispatch_async(_writerQueue, ^{
+        [DBTrackWriter commitSamples:pendingSamples connection:connection];
+        [connection close];
+    });
+}
+
+// Statements run against the connection rather than the writer, so blocks queued on the writer
+// queue never keep the writer alive.
++(BOOL)execute:(const char *)query connection:(DBConnection *)connection{
+    char *errorMessage = NULL;
+    if (sqlite3_exec(connection.database, query, NULL, NULL, &errorMessage) != SQLITE_OK) {
+        NSLog(@"DB Error: %s", errorMessage);
+        sqlite3_free(errorMessage);
+        return NO;
+    }
+    return YES;
+}
+
+-(BOOL)execute:(const char *)query{
+    return [DBTrackWriter execute:query connection:self.connection];
+}
+
+-(BOOL)isClosed{
+    os_unfair_lock_lock(&_bufferLock);
+    BOOL closed = _closed;
+    os_unfair_lock_unlock(&_bufferLock);
+    return closed;
+}
+
+-(BOOL)tableExists:(NSString *)table{
+    sqlite3_stmt *compiledStatement = [self.connection acquireStatement:"select 1 from sqlite_master where type = 'table' and name = ?"];
+    if (compiledStatement == NULL) {
+        return NO;
+    }
+    [self.connection bindArguments:@[table] toStatement:compiledStatement];
+    BOOL exists = sqlite3_step(compiledStatement) == SQLITE_ROW;
+    [self.connection releaseStatement:compiledStatement];
+    return exists;
+}
+
+#pragma mark - Settings
+
+-(void)setDurability:(DBTrackWriterDurability)durability{
+    _durability = durability;
+    if ([self isClosed]) {
+        return;
+    }
+    const char *query = durability == DBTrackWriterDurabilityFull ? "PRAGMA synchronous=FULL" : "PRAGMA synchronous=NORMAL";
+    DBConnection *connection = self.connection;
+    dispatch_async(self.writerQueue, ^{
+        [DBTrackWriter execute:query connection:connection];
+    });
+}
+
+-(void)setMaximumLatency:(NSTimeInterval)maximumLatency{
+    _maximumLatency = maximumLatency;
+
+    // Restart the periodic flush with the new interval; a non-positive latency disables it.
+    if (self.flushTimer != nil) {
+        dispatch_source_cancel(self.flushTimer);
+        self.flushTimer = nil;
+    }
+    if (maximumLatency <= 0 || [self isClosed]) {
+        return;
+    }
+
+    __weak DBTrackWriter *weakSelf = self;
+    uint64_t interval = (uint64_t)(maximumLatency * NSEC_PER_SEC);
+    self.flushTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.writerQueue);
+    dispatch_source_set_timer(self.flushTimer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)interval), interval, interval / 10);
+    dispatch_source_set_event_handler(self.flushTimer, ^{
+        [weakSelf flush];
+    });
+    dispatch_resume(self.flushTimer);
+}
+
+#pragma mark - Appending
+
+-(NSArray<NSMutableData *> *)emptySampleBuffers{
+    NSMutableArray<NSMutableData *> *buffers = [[NSMutableArray alloc] initWithCapacity:DBTrackWriterTableCount];
+    for (NSUInteger table=0; table<DBTrackWriterTableCount; table++) {
+        [buffers addObject:[[NSMutableData alloc] init]];
+    }
+    return buffers;
+}
+
+-(void)appendSamples:(const DBTrackSample *)samples count:(NSUInteger)count table:(DBTrackWriterTable)table{
+    // Pick the buffer under the lock, since a flush may swap it out at any time.
+    os_unfair_lock_lock(&_bufferLock);
+    if (_closed) {
+        os_unfair_lock_unlock(&_bufferLock);
+        return;
+    }
+    NSMutableData *buffer = self.pendingSamples[table];
+    [buffer appendBytes:samples length:count * sizeof(DBTrackSample)];
+    BOOL isBatchFull = buffer.length / sizeof(DBTrackSample) >= self.batchSize;
+    os_unfair_lock_unlock(&_bufferLock);
+
+    if (isBatchFull) {
+        [self flush];
+    }
+}
+
+-(void)appendTrafficSample:(DBTrackSample)sample{
+    [self appendSamples:&sample count:1 table:DBTrackWriterTableTraffic];
+}
+
+-(void)appendOwnshipSample:(DBTrackSample)sample{
+    [self appendSamples:&sample count:1 table:DBTrackWriterTableOwnship];
+}
+
+-(void)appendTrafficSamples:(const DBTrackSample *)samples count:(NSUInteger)count{
+    [self appendSamples:samples count:count table:DBTrackWriterTableTraffic];
+}
+
+-(void)appendTrackSample:(DBTrackSample)sample{
+    [self appendSamples:&sample count:1 table:DBTrackWriterTableTrack];
+}
+
+-(void)appendTrackSamples:(const DBTrackSample *)samples count:(NSUInteger)count{
+    [self appendSamples:samples count:count table:DBTrackWriterTableTrack];
+}
+
+#pragma mark - Committing
+
+-(NSArray<NSMutableData *> *)takePendingSamples{
+    // Swap the buffers out so appends can continue while the batch commits.
+    NSArray<NSMutableData *> *emptyBuffers = [self emptySampleBuffers];
+    os_unfair_lock_lock(&_bufferLock);
+    NSArray<NSMutableData *> *pendingSamples = self.pendingSamples;
+    self.pendingSamples = emptyBuffers;
+    os_unfair_lock_unlock(&_bufferLock);
+    return pendingSamples;
+}
+
+// Returns the number of rows inserted; a row that fails is logged and left out.
++(NSUInteger)insertSamples:(NSData *)samples query:(const char *)query connection:(DBConnection *)connection{
+    NSUInteger count = samples.length / sizeof(DBTrackSample);
+    if (count == 0) {
+        return 0;
+    }
+
+    sqlite3_stmt *compiledStatement = [connection acquireStatement:query];
+    if (compiledStatement == NULL) {
+        return 0;
+    }
+
+    BOOL bindsTrackId = sqlite3_bind_parameter_count(compiledStatement) > 7;
+    const DBTrackSample *sample = samples.bytes;
+    NSUInteger insertedCount = 0;
+    for (NSUInteger i=0; i<count; i++, sample++) {
+        sqlite3_bind_int64(compiledStatement, 1, sample->timeOfApplicability);
+        sqlite3_bind_double(compiledStatement, 2, sample->latitude);
+        sqlite3_bind_double(compiledStatement, 3, sample->longitude);
+        sqlite3_bind_double(compiledStatement, 4, sample->altitude);
+        sqlite3_bind_double(compiledStatement, 5, sample->horizontalVelocity1);
+        sqlite3_bind_double(compiledStatement, 6, sample->horizontalVelocity2);
+        sqlite3_bind_double(compiledStatement, 7, sample->verticalSpeed);
+        if (bindsTrackId) {
+            sqlite3_bind_int64(compiledStatement, 8, sample->trackId);
+        }
+        if (sqlite3_step(compiledStatement) == SQLITE_DONE) {
+            insertedCount++;
+        }
+        else {
+            NSLog(@"DB Error: %s", sqlite3_errmsg(connection.database));
+        }
+        sqlite3_reset(compiledStatement);
+    }
+    [connection releaseStatement:compiledStatement];
+    return insertedCount;
+}
+
+// Runs on the writer queue and returns the number of rows committed. One transaction per batch
+// amortizes the journal work over every row.
++(NSUInteger)commitSamples:(NSArray<NSMutableData *> *)pendingSamples connection:(DBConnection *)connection{
+    NSUInteger pendingLength = 0;
+    for (NSData *samples in pendingSamples) {
+        pendingLength += samples.length;
+    }
+    if (connection.database == NULL || pendingLength == 0) {
+        return 0;
+    }
+    if (![DBTrackWriter execute:"BEGIN" connection:connection]) {
+        return 0;
+    }
+    NSUInteger insertedCount = 0;
+    for (NSUInteger table=0; table<DBTrackWriterTableCount; table++) {
+        insertedCount += [DBTrackWriter insertSamples:pendingSamples[table] query:kInsertQueries[table] connection:connection];
+    }
+    if (![DBTrackWriter execute:"COMMIT" connection:connection]) {
+        [DBTrackWriter execute:"ROLLBACK" connection:connection];
+        return 0;
+    }
+    return insertedCount;
+}
+
+-(void)flush{
+    if ([self isClosed]) {
+        return;
+    }
+    NSArray<NSMutableData *> *pendingSamples = [self takePendingSamples];
+    DBConnection *connection = self.connection;
+    __weak DBTrackWriter *weakSelf = self;
+    dispatch_async(self.writerQueue, ^{
+        NSUInteger committedCount = [DBTrackWriter commitSamples:pendingSamples connection:connection];
+        DBTrackWriter *writer = weakSelf;
+        writer.committedSampleCount += committedCount;
+    });
+}
+
+-(void)flushAndWait{
+    // Commit everything appended so far, after any batches already queued.
+    if ([self isClosed]) {
+        return;
+    }
+    NSArray<NSMutableData *> *pendingSamples = [self takePendingSamples];
+    dispatch_sync(self.writerQueue, ^{
+        self.committedSampleCount += [DBTrackWriter commitSamples:pendingSamples connection:self.connection];
+    });
+}
+
+-(void)checkpoint{
+    // Fold the WAL back into the database file without waiting for readers.
+    if ([self isClosed]) {
+        return;
+    }
+    DBConnection *connection = self.connection;
+    dispatch_async(self.writerQueue, ^{
+        if (connection.database != NULL) {
+            sqlite3_wal_checkpoint_v2(connection.database, NULL, SQLITE_CHECKPOINT_PASSIVE, NULL, NULL);
+        }
+    });
+}
+
+-(void)close{
+    // Appends racing the close either land in the final batch or are dropped.
+    os_unfair_lock_lock(&_bufferLock);
+    BOOL wasClosed = _closed;
+    _closed = YES;
+    os_unfair_lock_unlock(&_bufferLock);
+    if (wasClosed) {
+        return;
+    }
+    if (self.flushTimer != nil) {
+        dispatch_source_cancel(self.flushTimer);
+        self.flushTimer = nil;
+    }
+    NSArray<NSMutableData *> *pendingSamples = [self takePendingSamples];
+    dispatch_sync(self.writerQueue, ^{
+        self.committedSampleCount += [DBTrackWriter commitSamples:pendingSamples connection:self.connection];
+        [self.connection close];
+    });
+}
+@end
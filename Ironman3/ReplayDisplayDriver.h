@@ -0,0 +1,65 @@
+//
+//  ReplayDisplayDriver.h
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 19/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#ifdef __cplusplus
+#include "ironman/TargetTable.hpp"
+#endif
+
+@class MEMapViewController;
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Recorded tables a driver can replay.
+typedef NS_ENUM(NSInteger, ReplayTable) {
+    ReplayTableTraffic,
+    ReplayTableTrack
+};
+
+// Called on every display frame after its samples are applied and before the engine draws.
+// simulationTime is in the recording's seconds; rebuilt is YES when the targets were cleared and
+// rebuilt after a seek.
+typedef void (^ReplayFrameHandler)(NSTimeInterval simulationTime, NSUInteger appliedSampleCount, BOOL rebuilt);
+
+// Replays a recording through a map view at any rate. While started it owns the engine's loop: the
+// engine's own display link is stopped, and on each tick of the driver's display link the frame's
+// samples are applied in one pass, the frame handler runs, and the engine is updated with the tick's
+// timestamp. Commands are stamped with the last tick's timestamp, and timing and frame contents come
+// from ironman::ReplayScheduler, so once ticking a replay is a pure function of the display timestamps
+// and the commands given.
+@interface ReplayDisplayDriver : NSObject
+
+    @property (nonatomic, readonly) NSTimeInterval startTime;
+    @property (nonatomic, readonly) NSTimeInterval endTime;
+    // The last frame's simulation time.
+    @property (nonatomic, readonly) NSTimeInterval simulationTime;
+    // Multiple of real time, 1 by default; 8 and 64 fast-forward.
+    @property (nonatomic) double rate;
+    @property (nonatomic, readonly, getter=isPlaying) BOOL playing;
+    @property (nonatomic, copy, nullable) ReplayFrameHandler frameHandler;
+
+    // Loads the table's rows up front. Returns nil if the recording cannot be read.
+    -(nullable instancetype)initWithMapViewController:(MEMapViewController *)mapViewController
+                                         databasePath:(NSString *)databasePath
+                                                table:(ReplayTable)table;
+    // Takes over the engine's loop; stop hands it back.
+    -(void)start;
+    -(void)stop;
+    -(void)play;
+    -(void)pause;
+    // Clamped to the recording; the next frame rebuilds the targets.
+    -(void)seekToTime:(NSTimeInterval)time;
+
+#ifdef __cplusplus
+    // Every target's latest sample as of simulationTime, for Objective-C++ callers.
+    -(const ironman::TargetTable &)targets;
+#endif
+@end
+
+NS_ASSUME_NONNULL_END
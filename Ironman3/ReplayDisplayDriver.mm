@@ -0,0 +1,146 @@
+//
+//  ReplayDisplayDriver.mm
+//  Ironman3
+//
+//  Created by Aaron D'Souza on 19/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#import "ReplayDisplayDriver.h"
+#import <AltusMappingEngine/AltusMappingEngine.h>
+#import <QuartzCore/QuartzCore.h>
+#include "ironman/Database.hpp"
+#include "ironman/ReplayScheduler.hpp"
+#include "ironman/TrackReader.hpp"
+#include <memory>
+
+// A display link retains its target, so it fires through this to keep the driver releasable.
+@interface ReplayDisplayLinkTarget : NSObject
+    @property (nonatomic, weak) ReplayDisplayDriver *driver;
+@end
+
+@interface ReplayDisplayDriver ()
+    @property (nonatomic, weak) MEMapViewController *mapViewController;
+    @property (nonatomic, strong, nullable) CADisplayLink *displayLink;
+    -(void)displayLinkFired:(CADisplayLink *)displayLink;
+@end
+
+@implementation ReplayDisplayLinkTarget
+
+-(void)displayLinkFired:(CADisplayLink *)displayLink{
+    [self.driver displayLinkFired:displayLink];
+}
+
+@end
+
+@implementation ReplayDisplayDriver {
+    ironman::TrackColumns _recording;
+    ironman::TargetTable _targets;
+    std::unique_ptr<ironman::ReplayScheduler> _scheduler;
+    // The last tick's timestamp, 0 until the display link first fires after starting.
+    CFTimeInterval _lastTimestamp;
+}
+
+-(instancetype)initWithMapViewController:(MEMapViewController *)mapViewController databasePath:(NSString *)databasePath table:(ReplayTable)table{
+    self = [super init];
+    if (self) {
+        ironman::Database database;
+        if (!database.open(databasePath.UTF8String)) {
+            return nil;
+        }
+        ironman::TrackReader reader(database);
+        if (!reader.load(table == ReplayTableTrack ? ironman::TrackTable::Track : ironman::TrackTable::Traffic, _recording) || _recording.empty()) {
+            return nil;
+        }
+        _scheduler.reset(new ironman::ReplayScheduler(_recording));
+        self.mapViewController = mapViewController;
+    }
+    return self;
+}
+
+-(void)dealloc{
+    [self stop];
+}
+
+#pragma mark - Engine loop
+
+-(void)start{
+    if (self.displayLink != nil) {
+        return;
+    }
+    [self.mapViewController stopDisplayLink];
+    ReplayDisplayLinkTarget *target = [[ReplayDisplayLinkTarget alloc] init];
+    target.driver = self;
+    self.displayLink = [CADisplayLink displayLinkWithTarget:target selector:@selector(displayLinkFired:)];
+    [self.displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+}
+
+-(void)stop{
+    if (self.displayLink == nil) {
+        return;
+    }
+    [self.displayLink invalidate];
+    self.displayLink = nil;
+    _lastTimestamp = 0;
+    [self.mapViewController startDisplayLink];
+}
+
+-(void)displayLinkFired:(CADisplayLink *)displayLink{
+    _lastTimestamp = displayLink.timestamp;
+    ironman::ReplayFrame frame = _scheduler->advance(displayLink.timestamp);
+    ironman::applyFrame(_recording, frame, _targets);
+    if (self.frameHandler != nil) {
+        self.frameHandler(frame.time, frame.end - frame.begin, frame.rebuild);
+    }
+    [self.mapViewController updateWithTimestamp:displayLink.timestamp];
+}
+
+#pragma mark - Commands
+
+// Commands are stamped with the last tick's timestamp, so they take effect from that frame on and never
+// precede it. Before the first tick there is no frame to stamp them with, and the current time stands in.
+-(CFTimeInterval)commandTimestamp{
+    return _lastTimestamp > 0 ? _lastTimestamp : CACurrentMediaTime();
+}
+
+-(void)play{
+    _scheduler->play([self commandTimestamp]);
+}
+
+-(void)pause{
+    _scheduler->pause([self commandTimestamp]);
+}
+
+-(void)seekToTime:(NSTimeInterval)time{
+    _scheduler->seek(time, [self commandTimestamp]);
+}
+
+-(void)setRate:(double)rate{
+    _scheduler->setRate(rate, [self commandTimestamp]);
+}
+
+-(double)rate{
+    return _scheduler->clock().rate();
+}
+
+-(BOOL)isPlaying{
+    return _scheduler->clock().playing();
+}
+
+-(NSTimeInterval)startTime{
+    return _scheduler->startTime();
+}
+
+-(NSTimeInterval)endTime{
+    return _scheduler->endTime();
+}
+
+-(NSTimeInterval)simulationTime{
+    return _scheduler->time();
+}
+
+-(const ironman::TargetTable &)targets{
+    return _targets;
+}
+
+@end
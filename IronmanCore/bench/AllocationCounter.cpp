@@ -0,0 +1,43 @@
+//
+//  AllocationCounter.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 25/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Replaces the global operator new and delete for the benchmarks that link it, counting every
+// allocation in the process.
+
+#include "BenchmarkSupport.hpp"
+#include <cstdlib>
+#include <new>
+
+static size_t gAllocationCount = 0;
+
+void *operator new(size_t size){
+    gAllocationCount++;
+    void *memory = std::malloc(size > 0 ? size : 1);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void *memory) noexcept{
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept{
+    std::free(memory);
+}
+
+namespace ironman {
+namespace bench {
+
+size_t allocationCount(){
+    return gAllocationCount;
+}
+
+} // namespace bench
+} // namespace ironman
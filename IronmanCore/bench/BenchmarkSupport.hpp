@@ -0,0 +1,77 @@
+//
+//  BenchmarkSupport.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 08/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_BENCHMARK_SUPPORT_HPP
+#define IRONMAN_BENCHMARK_SUPPORT_HPP
+
+#include "ironman/Database.hpp"
+#include "ironman/TrackReader.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace ironman {
+namespace bench {
+
+// Seconds since construction, on the monotonic clock.
+class Stopwatch {
+public:
+    Stopwatch() : _start(std::chrono::steady_clock::now()) {}
+    double elapsed() const{
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point _start;
+};
+
+// The recording to measure: the first argument, or the one bundled with the app.
+inline std::string databasePath(int argc, char **argv){
+#ifdef IRONMAN_BENCH_DATABASE
+    return argc > 1 ? argv[1] : IRONMAN_BENCH_DATABASE;
+#else
+    return argc > 1 ? argv[1] : "";
+#endif
+}
+
+inline std::string scratchPath(const char *name){
+    const char *directory = std::getenv("TMPDIR");
+    return std::string(directory != nullptr ? directory : "/tmp") + "/" + name;
+}
+
+// Opens the recording and decodes its ownship and traffic tables, logging what failed.
+inline bool loadRecording(const std::string &path, TrackColumns &ownship, TrackColumns &traffic){
+    Database database;
+    if (!database.open(path)) {
+        return false;
+    }
+    TrackReader reader(database);
+    if (!reader.load(TrackTable::Ownship, ownship) || !reader.load(TrackTable::Traffic, traffic)) {
+        return false;
+    }
+    if (ownship.empty() || traffic.empty()) {
+        std::fprintf(stderr, "%s has no OWN or TRAF samples\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Heap allocations in the process so far, so a stretch of code can be shown not to allocate. Defined
+// in AllocationCounter.cpp, which only the benchmarks that call it link.
+size_t allocationCount();
+
+// One result per line, "name value unit", so runs can be diffed and plotted.
+inline void report(const char *name, double value, const char *unit){
+    std::printf("%-40s %14.3f %s\n", name, value, unit);
+}
+
+} // namespace bench
+} // namespace ironman
+
+#endif // IRONMAN_BENCHMARK_SUPPORT_HPP
@@ -0,0 +1,283 @@
+//
+//  conflict_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 13/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks the CPA/TCPA conflict detector and measures it at 1k, 10k and 100k intruders.
+//  - Intruders are the recorded traffic's speeds and climb rates placed at random bearings within
+//    20 nm of the recorded ownship, at random tracks and within 3000 ft of its altitude.
+//  - Every intruder's closest approach and alert level is checked against a direct evaluation of the
+//    TCAS tests, and the closest approaches of the first thousand against stepping both aircraft along
+//    great circles.
+//  - An intruder sampled long before the ownship is held at the staleness horizon and never alerts,
+//    even on a collision course.
+//  - The ownship flies its recording; the reported transitions must reproduce the alert levels.
+//
+//   conflict_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/ConflictDetector.hpp"
+#include "ironman/Geodesy.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+
+using namespace ironman;
+
+static TrackState stateOfSample(const TrackSample &sample){
+    return TrackState{(double)sample.timeOfApplicability, sample.latitude, sample.longitude, sample.altitude,
+                      sample.groundSpeed, sample.trackAngle, sample.verticalSpeed};
+}
+
+static void fillIntruders(const TrackState &ownship, const TrackColumns &traffic, size_t count, TargetTable &targets){
+    std::mt19937 random(11);
+    std::uniform_real_distribution<double> bearing(0, 360);
+    std::uniform_real_distribution<double> range(0, 20);
+    std::uniform_real_distribution<double> height(-3000, 3000);
+    std::uniform_real_distribution<double> age(0, 2);
+    targets.clear();
+    for (size_t i=0; i<count; i++) {
+        TrackSample sample = traffic[i % traffic.size()];
+        geodesy::GeoPoint position = geodesy::pointOnRadial(geodesy::GeoPoint{ownship.latitude, ownship.longitude}, bearing(random), range(random));
+        sample.trackId = (int64_t)i;
+        sample.timeOfApplicability = (int64_t)std::floor(ownship.time - age(random));
+        sample.latitude = position.latitude;
+        sample.longitude = position.longitude;
+        sample.altitude = ownship.altitude + height(random);
+        sample.trackAngle = bearing(random);
+        sample.groundSpeed = std::isfinite(sample.groundSpeed) ? sample.groundSpeed : 250;
+        sample.verticalSpeed = std::isfinite(sample.verticalSpeed) ? sample.verticalSpeed : 0;
+        targets.update(sample);
+    }
+}
+
+// The TCAS tests written out with branches and divisions, in the same east/north frame.
+static bool checkRow(const TrackState &ownship, const TargetTable &targets, size_t i, const ConflictColumns &conflicts,
+                     double horizon){
+    double age = std::min(std::max(ownship.time - targets.sampleTime()[i], 0.0), horizon);
+    bool stale = ownship.time - targets.sampleTime()[i] > horizon;
+    double ownTrack = geodesy::toRadians(ownship.trackAngle);
+    double east = (targets.longitude()[i] - ownship.longitude) * 60.0 * std::cos(geodesy::toRadians(ownship.latitude))
+                + targets.eastVelocity()[i] / 3600.0 * age;
+    double north = (targets.latitude()[i] - ownship.latitude) * 60.0 + targets.northVelocity()[i] / 3600.0 * age;
+    double above = targets.altitude()[i] + targets.verticalSpeed()[i] / 60.0 * age - ownship.altitude;
+    double vEast = (targets.eastVelocity()[i] - ownship.groundSpeed * std::sin(ownTrack)) / 3600.0;
+    double vNorth = (targets.northVelocity()[i] - ownship.groundSpeed * std::cos(ownTrack)) / 3600.0;
+    double vClimb = (targets.verticalSpeed()[i] - ownship.verticalSpeed) / 60.0;
+
+    double range = std::hypot(east, north);
+    double rangeRate = (east * vEast + north * vNorth) / range;
+    double time = rangeRate < 0 ? -(east * vEast + north * vNorth) / (vEast * vEast + vNorth * vNorth) : 0;
+    double missRange = std::hypot(east + vEast * time, north + vNorth * time);
+
+    AlertThresholds thresholds = alertThresholdsForAltitude(ownship.altitude);
+    auto horizontal = [&](double tau, double dmod){
+        if (range <= dmod) {
+            return true;
+        }
+        return rangeRate < 0 && -(range * range - dmod * dmod) / (range * rangeRate) <= tau;
+    };
+    auto vertical = [&](double tau, double zthr){
+        if (std::fabs(above) <= zthr) {
+            return true;
+        }
+        return above * vClimb < 0 && -above / vClimb <= tau;
+    };
+    AlertLevel level = AlertLevel::None;
+    if (stale) {
+        // Held, not alerting.
+    }
+    else if (horizontal(thresholds.trafficTau, thresholds.trafficDmod) && vertical(thresholds.trafficTau, thresholds.trafficZthr)) {
+        level = AlertLevel::TrafficAdvisory;
+    }
+    if (!stale && thresholds.sensitivityLevel >= 3 && horizontal(thresholds.resolutionTau, thresholds.resolutionDmod)
+        && vertical(thresholds.resolutionTau, thresholds.resolutionZthr)) {
+        level = AlertLevel::ResolutionAdvisory;
+    }
+
+    if (std::fabs(conflicts.timeToClosestApproach[i] - time) > 1e-6 * std::max(1.0, time)
+        || std::fabs(conflicts.closestApproachRange[i] - missRange) > 1e-9
+        || std::fabs(conflicts.closestApproachAltitude[i] - (above + vClimb * time)) > 1e-6 || conflicts.level[i] != level) {
+        std::fprintf(stderr, "intruder %zu: cpa %.6f s %.6f nm level %d, expected %.6f s %.6f nm level %d\n", i,
+                     conflicts.timeToClosestApproach[i], conflicts.closestApproachRange[i], (int)conflicts.level[i],
+                     time, missRange, (int)level);
+        return false;
+    }
+    return true;
+}
+
+// Closest approach found by flying both aircraft along great circles in 0.05 s steps.
+static double steppedMissRange(const TrackState &ownship, const TargetTable &targets, size_t i, double horizon){
+    double age = ownship.time - targets.sampleTime()[i];
+    geodesy::GeoPoint ownStart{ownship.latitude, ownship.longitude};
+    geodesy::GeoPoint targetStart{targets.latitude()[i], targets.longitude()[i]};
+    double best = INFINITY;
+    for (double time=0; time<=horizon; time+=0.05) {
+        geodesy::GeoPoint own = geodesy::pointOnRadial(ownStart, ownship.trackAngle, ownship.groundSpeed * time / 3600.0);
+        geodesy::GeoPoint target = geodesy::pointOnRadial(targetStart, targets.trackAngle()[i], targets.groundSpeed()[i] * (time + age) / 3600.0);
+        best = std::min(best, geodesy::nauticalMilesBetween(own, target));
+    }
+    return best;
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownship;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownship, traffic)) {
+        return 1;
+    }
+    TrackState start = stateOfSample(ownship[ownship.size() / 2]);
+    if (!std::isfinite(start.groundSpeed) || !std::isfinite(start.trackAngle) || !std::isfinite(start.verticalSpeed)) {
+        std::fprintf(stderr, "the ownship has no velocity to fly\n");
+        return 1;
+    }
+    bench::report("ownship.sensitivityLevel", alertThresholdsForAltitude(start.altitude).sensitivityLevel, "");
+
+    // Every intruder against the direct evaluation.
+    TargetTable targets;
+    fillIntruders(start, traffic, 100000, targets);
+    ConflictDetector detector;
+    ConflictColumns conflicts;
+    std::vector<AlertTransition> transitions;
+    detector.update(start, targets, conflicts, transitions);
+    size_t levelCounts[3] = {0, 0, 0};
+    for (size_t i=0; i<targets.size(); i++) {
+        if (!checkRow(start, targets, i, conflicts, detector.stalenessHorizon())) {
+            return 1;
+        }
+        levelCounts[(int)conflicts.level[i]]++;
+    }
+    bench::report("intruders.trafficAdvisory", (double)levelCounts[1], "intruders");
+    bench::report("intruders.resolutionAdvisory", (double)levelCounts[2], "intruders");
+    if (transitions.size() != levelCounts[1] + levelCounts[2]) {
+        std::fprintf(stderr, "the first update reported %zu transitions for %zu alerts\n", transitions.size(), levelCounts[1] + levelCounts[2]);
+        return 1;
+    }
+
+    // The flat frame against great circles, for intruders that close within two minutes.
+    double flatError = 0;
+    for (size_t i=0; i<1000; i++) {
+        double time = conflicts.timeToClosestApproach[i];
+        if (time > 0 && time < 120) {
+            flatError = std::max(flatError, std::fabs(steppedMissRange(start, targets, i, 180) - conflicts.closestApproachRange[i]));
+        }
+    }
+    bench::report("cpa.maxError.flatFrame", flatError * geodesy::kMetersPerNauticalMile, "m");
+    if (flatError * geodesy::kMetersPerNauticalMile > 50) {
+        std::fprintf(stderr, "closest approaches are more than 50 m off the great circles\n");
+        return 1;
+    }
+
+    // The same intruder head on a mile out, sampled just now and then a minute ago: only the fresh one alerts.
+    TrackSample headOn = traffic[0];
+    geodesy::GeoPoint ahead = geodesy::pointOnRadial(geodesy::GeoPoint{start.latitude, start.longitude}, start.trackAngle, 1);
+    headOn.trackId = -1;
+    headOn.latitude = ahead.latitude;
+    headOn.longitude = ahead.longitude;
+    headOn.altitude = start.altitude;
+    headOn.groundSpeed = start.groundSpeed;
+    headOn.trackAngle = std::fmod(start.trackAngle + 180, 360);
+    headOn.verticalSpeed = start.verticalSpeed;
+    TargetTable single;
+    const int64_t ages[] = {0, 60};
+    AlertLevel headOnLevels[2];
+    for (size_t k=0; k<2; k++) {
+        headOn.timeOfApplicability = (int64_t)std::floor(start.time) - ages[k];
+        single.update(headOn);
+        ConflictDetector headOnDetector;
+        headOnDetector.update(start, single, conflicts, transitions);
+        if (!checkRow(start, single, 0, conflicts, headOnDetector.stalenessHorizon())) {
+            return 1;
+        }
+        headOnLevels[k] = conflicts.level[0];
+    }
+    if (headOnLevels[0] != AlertLevel::ResolutionAdvisory && headOnLevels[0] != AlertLevel::TrafficAdvisory) {
+        std::fprintf(stderr, "a fresh head-on intruder does not alert\n");
+        return 1;
+    }
+    if (headOnLevels[1] != AlertLevel::None) {
+        std::fprintf(stderr, "a stale intruder alerts at level %d\n", (int)headOnLevels[1]);
+        return 1;
+    }
+    bench::report("staleIntruder.level", (double)headOnLevels[1], "");
+
+    // Fly the recorded ownship through 10k intruders; the transitions must track the levels.
+    fillIntruders(start, traffic, 10000, targets);
+    ConflictDetector flight;
+    std::map<int64_t, AlertLevel> alerting;
+    size_t transitionCount = 0;
+    for (size_t tick=0; tick<ownship.size(); tick++) {
+        TrackState state = stateOfSample(ownship[tick]);
+        if (!std::isfinite(state.groundSpeed) || !std::isfinite(state.trackAngle)) {
+            continue;
+        }
+        // Drop a target every tick so transitions for removed targets are exercised.
+        targets.remove((int64_t)(tick * 97));
+        flight.update(state, targets, conflicts, transitions);
+        for (const AlertTransition &transition : transitions) {
+            auto current = alerting.find(transition.trackId);
+            AlertLevel from = current != alerting.end() ? current->second : AlertLevel::None;
+            if (from != transition.from || from == transition.to) {
+                std::fprintf(stderr, "track %lld: transition from %d does not follow level %d\n",
+                             (long long)transition.trackId, (int)transition.from, (int)from);
+                return 1;
+            }
+            if (transition.to == AlertLevel::None) {
+                alerting.erase(transition.trackId);
+            }
+            else {
+                alerting[transition.trackId] = transition.to;
+            }
+        }
+        transitionCount += transitions.size();
+        size_t expected = 0;
+        for (size_t i=0; i<targets.size(); i++) {
+            if (conflicts.level[i] != AlertLevel::None) {
+                expected++;
+                auto current = alerting.find(targets.trackId()[i]);
+                if (current == alerting.end() || current->second != conflicts.level[i]) {
+                    std::fprintf(stderr, "track %lld: transitions do not reproduce its level\n", (long long)targets.trackId()[i]);
+                    return 1;
+                }
+            }
+        }
+        if (expected != alerting.size() || expected != flight.alertCount()) {
+            std::fprintf(stderr, "%zu alerts reported for %zu alerting targets\n", alerting.size(), expected);
+            return 1;
+        }
+    }
+    bench::report("flight.transitions", (double)transitionCount, "transitions");
+
+    // Cost per update, as the ownship advances through a minute at 60 fps.
+    const size_t sizes[] = {1000, 10000, 100000};
+    for (size_t count : sizes) {
+        fillIntruders(start, traffic, count, targets);
+        ConflictDetector timed;
+        int frames = count >= 100000 ? 600 : 3600;
+        double checksum = 0;
+        bench::Stopwatch timer;
+        for (int frame=0; frame<frames; frame++) {
+            TrackState state = start;
+            state.time += frame / 60.0;
+            geodesy::GeoPoint position = geodesy::pointOnRadial(geodesy::GeoPoint{start.latitude, start.longitude}, start.trackAngle,
+                                                                start.groundSpeed * frame / 60.0 / 3600.0);
+            state.latitude = position.latitude;
+            state.longitude = position.longitude;
+            timed.update(state, targets, conflicts, transitions);
+            checksum += conflicts.closestApproachRange[frame % count] + transitions.size();
+        }
+        double perFrame = timer.elapsed() / frames;
+        char name[64];
+        std::snprintf(name, sizeof(name), "update.%zuk", count / 1000);
+        bench::report(name, perFrame * 1e6, "us/update");
+        std::snprintf(name, sizeof(name), "update.%zuk.perIntruder", count / 1000);
+        bench::report(name, perFrame / count * 1e9, "ns/intruder");
+        std::printf("checksum %.6f\n", checksum);
+    }
+    return 0;
+}
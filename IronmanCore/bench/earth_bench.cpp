@@ -0,0 +1,183 @@
+//
+//  earth_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 22/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks the WGS84 earth model and measures both models through the same templated loops.
+//  - Reference geodesics from Karney's GeographicLib, including Vincenty's own Flinders Peak to
+//    Buninyong line, one across the antimeridian, one along the equator and one at 89 degrees: the
+//    WGS84 inverse must be within 1e-6 nm (2 mm) and 1e-6 degrees, and the direct solution along the
+//    reference course and distance must land within 1e-9 degrees of the far point. The near-antipodal
+//    lines, beyond Vincenty's convergence, are reported but not checked.
+//  - 200k random pairs: the direct solution along each inverse must return to the far point.
+//  - 10k targets within 250 nm of the recorded ownship: the spherical model's worst range error
+//    against the ellipsoid, and the cost per target of ranges and courses from each model.
+//
+//   earth_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/EarthModel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace ironman;
+using geodesy::GeoPoint;
+
+struct Geodesic {
+    GeoPoint point1;
+    GeoPoint point2;
+    // Nautical miles and degrees, from GeographicLib.
+    double distance;
+    double course;
+    bool antipodal;
+};
+
+static const Geodesic kReference[] = {
+    {{-37.95103341666667, 144.42486788888888}, {-37.65282113888889, 143.92649552777777}, 29.682651803024, 306.868159202881, false},
+    {{40.6413, -73.7781}, {51.47, -0.4543}, 2999.410794032128, 51.381647858369, false},
+    {{0, 0}, {0.5, 179.7}, 10768.967289822062, 15.556882793491, true},
+    {{1, 10}, {-1, 10}, 119.410786779480, 180.000000000000, false},
+    {{60, 25}, {60.1, 25.2}, 8.508362121591, 44.918123336116, false},
+    {{-89.9, 0}, {89.9, 179.999}, 10801.258837106194, 108.738601735283, true},
+    {{33.9425, -118.4081}, {35.772, 140.3929}, 4736.382219678922, 305.768034649652, false},
+    {{10, -179.5}, {12, 179.5}, 133.233690593082, 333.804298807014, false},
+    {{45, 0}, {45, 1}, 42.573614854101, 89.646442106813, false},
+    {{0, 0}, {1, 0}, 59.705393389740, 0.000000000000, false},
+    {{89, 0}, {89, 90}, 85.288859952486, 45.004363541669, false},
+    {{0, 100}, {0, 101}, 60.107716411055, 90.000000000000, false},
+};
+
+static double degreesApart(double a, double b){
+    double difference = std::fmod(std::fabs(a - b), 360.0);
+    return std::min(difference, 360.0 - difference);
+}
+
+static double pointsApart(GeoPoint a, GeoPoint b){
+    return std::max(std::fabs(a.latitude - b.latitude), degreesApart(a.longitude, b.longitude));
+}
+
+static bool checkReference(){
+    double distanceError = 0, courseError = 0, directError = 0, sphericalError = 0, antipodalError = 0;
+    for (const Geodesic &line : kReference) {
+        double distance, course;
+        geodesy::WGS84::inverse(line.point1, line.point2, distance, course);
+        if (line.antipodal) {
+            antipodalError = std::max(antipodalError, std::fabs(distance - line.distance));
+            continue;
+        }
+        distanceError = std::max(distanceError, std::fabs(distance - line.distance));
+        courseError = std::max(courseError, degreesApart(course, line.course));
+        directError = std::max(directError, pointsApart(geodesy::WGS84::pointOnRadial(line.point1, line.course, line.distance), line.point2));
+        double spherical = geodesy::Spherical::nauticalMilesBetween(line.point1, line.point2);
+        sphericalError = std::max(sphericalError, std::fabs(spherical - line.distance) / line.distance);
+    }
+    bench::report("reference.distance", distanceError * 1852 * 1000, "mm");
+    bench::report("reference.course", courseError * 1e9, "deg x 1e-9");
+    bench::report("reference.direct", directError * 1e9, "deg x 1e-9");
+    bench::report("reference.antipodal", antipodalError * 1852, "m");
+    bench::report("reference.spherical", sphericalError * 100, "% range error");
+    if (distanceError > 1e-6 || courseError > 1e-6 || directError > 1e-9) {
+        std::fprintf(stderr, "WGS84 model off the reference geodesics\n");
+        return false;
+    }
+    return true;
+}
+
+static bool checkRoundTrips(){
+    std::mt19937 random(41);
+    std::uniform_real_distribution<double> unit(-1, 1);
+    std::uniform_real_distribution<double> longitude(-180, 180);
+    double worst = 0;
+    int checked = 0;
+    for (int i=0; i<200000; i++) {
+        GeoPoint point1{geodesy::toDegrees(std::asin(unit(random))), longitude(random)};
+        GeoPoint point2{geodesy::toDegrees(std::asin(unit(random))), longitude(random)};
+        // Vincenty's inverse does not converge close to the antipode.
+        if (geodesy::nauticalMilesBetween(point1, point2) > 179 * 60) {
+            continue;
+        }
+        double distance, course;
+        geodesy::WGS84::inverse(point1, point2, distance, course);
+        worst = std::max(worst, pointsApart(geodesy::WGS84::pointOnRadial(point1, course, distance), point2));
+        checked++;
+    }
+    bench::report("roundtrip.pairs", checked, "pairs");
+    bench::report("roundtrip.error", worst * 1e9, "deg x 1e-9");
+    if (worst > 1e-9) {
+        std::fprintf(stderr, "WGS84 direct does not invert the inverse\n");
+        return false;
+    }
+    return true;
+}
+
+// The loops a consumer templated on the model runs: one inverse per target, or the model's array
+// kernel.
+template <class Model>
+static double timeInverse(GeoPoint origin, const std::vector<double> &latitudes, const std::vector<double> &longitudes,
+                          std::vector<double> &ranges, std::vector<double> &courses, int frames){
+    bench::Stopwatch timer;
+    for (int frame=0; frame<frames; frame++) {
+        for (size_t i=0; i<latitudes.size(); i++) {
+            Model::inverse(origin, GeoPoint{latitudes[i], longitudes[i]}, ranges[i], courses[i]);
+        }
+    }
+    return timer.elapsed() / frames / latitudes.size() * 1e9;
+}
+
+template <class Model>
+static double timeArrays(GeoPoint origin, const std::vector<double> &latitudes, const std::vector<double> &longitudes,
+                         std::vector<double> &ranges, std::vector<double> &courses, int frames){
+    bench::Stopwatch timer;
+    for (int frame=0; frame<frames; frame++) {
+        Model::rangesAndCourses(origin, latitudes.data(), longitudes.data(), ranges.data(), courses.data(), latitudes.size());
+    }
+    return timer.elapsed() / frames / latitudes.size() * 1e9;
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownship;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownship, traffic)) {
+        return 1;
+    }
+    if (!checkReference() || !checkRoundTrips()) {
+        return 1;
+    }
+
+    const size_t count = 10000;
+    GeoPoint origin{ownship.latitude[0], ownship.longitude[0]};
+    std::mt19937 random(43);
+    std::uniform_real_distribution<double> bearing(0, 360);
+    std::uniform_real_distribution<double> range(1, 250);
+    std::vector<double> latitudes(count), longitudes(count);
+    for (size_t i=0; i<count; i++) {
+        GeoPoint point = geodesy::pointOnRadial(origin, bearing(random), range(random));
+        latitudes[i] = point.latitude;
+        longitudes[i] = point.longitude;
+    }
+
+    std::vector<double> sphericalRanges(count), ellipsoidRanges(count), courses(count);
+    const int frames = 50;
+    double sphericalInverse = timeInverse<geodesy::Spherical>(origin, latitudes, longitudes, sphericalRanges, courses, frames);
+    double sphericalArrays = timeArrays<geodesy::Spherical>(origin, latitudes, longitudes, sphericalRanges, courses, frames);
+    double ellipsoidInverse = timeInverse<geodesy::WGS84>(origin, latitudes, longitudes, ellipsoidRanges, courses, frames);
+    double ellipsoidArrays = timeArrays<geodesy::WGS84>(origin, latitudes, longitudes, ellipsoidRanges, courses, frames);
+
+    double worst = 0;
+    for (size_t i=0; i<count; i++) {
+        worst = std::max(worst, std::fabs(sphericalRanges[i] - ellipsoidRanges[i]) / ellipsoidRanges[i]);
+    }
+    bench::report("ownship.latitude", origin.latitude, "deg");
+    bench::report("radar.spherical.error", worst * 100, "% range error");
+    bench::report("spherical.inverse", sphericalInverse, "ns/target");
+    bench::report("spherical.arrays", sphericalArrays, "ns/target");
+    bench::report("wgs84.inverse", ellipsoidInverse, "ns/target");
+    bench::report("wgs84.arrays", ellipsoidArrays, "ns/target");
+    return 0;
+}
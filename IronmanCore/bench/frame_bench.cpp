@@ -0,0 +1,169 @@
+//
+//  frame_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 21/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks the ownship-anchored local frame against the great circle kernels and measures it.
+//  - 10k targets at random bearings up to 250 nm from the recorded ownship, between the surface and
+//    45000 ft. Every target's bearing in the frame must be its great circle course from the anchor,
+//    its horizontal range R sin(d / R) for its great circle distance d, and it must transform back to
+//    its position and altitude, all within the bounds LocalFrame.hpp states. The worst shortfall of
+//    the flat range is reported out to 25, 50, 100, 200 and 250 nm.
+//  - Points on the plane at and beyond the earth radius come back on the horizon with finite altitudes.
+//  - The ownship flies its recording: after every update it is within the re-anchor distance of the
+//    anchor, and the number of re-anchors is reported.
+//  - Cost of bringing 10k targets into the frame, against ranges and courses from the scalar and the
+//    batch great circle kernels.
+//
+//   frame_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/GeodesyBatch.hpp"
+#include "ironman/LocalFrame.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace ironman;
+
+static const double kRanges[] = {25, 50, 100, 200, 250};
+
+static bool checkTargets(const LocalFrame &frame, const std::vector<double> &latitudes, const std::vector<double> &longitudes,
+                         const std::vector<double> &altitudes){
+    size_t count = latitudes.size();
+    std::vector<double> east(count), north(count), up(count);
+    std::vector<double> backLatitudes(count), backLongitudes(count), backAltitudes(count);
+    frame.toLocal(latitudes.data(), longitudes.data(), altitudes.data(), east.data(), north.data(), up.data(), count);
+    frame.toGeodetic(east.data(), north.data(), up.data(), backLatitudes.data(), backLongitudes.data(),
+                     backAltitudes.data(), count);
+
+    double courseError = 0, rangeError = 0, positionError = 0, altitudeError = 0;
+    double shortfall[5] = {0};
+    for (size_t i=0; i<count; i++) {
+        geodesy::GeoPoint point{latitudes[i], longitudes[i]};
+        double distance = geodesy::nauticalMilesBetween(frame.origin(), point);
+        double range = std::hypot(east[i], north[i]);
+        if (distance > 1e-6) {
+            double bearing = geodesy::toDegrees(std::atan2(east[i], north[i]));
+            double difference = std::fabs(bearing + (bearing < 0 ? 360 : 0) - geodesy::courseDegrees(frame.origin(), point));
+            courseError = std::max(courseError, std::min(difference, 360 - difference));
+        }
+        double expected = geodesy::kNauticalMilesPerRadian * std::sin(distance / geodesy::kNauticalMilesPerRadian);
+        rangeError = std::max(rangeError, std::fabs(range - expected));
+        for (int band=0; band<5; band++) {
+            if (distance <= kRanges[band]) {
+                shortfall[band] = std::max(shortfall[band], distance - range);
+            }
+        }
+        positionError = std::max(positionError, std::fabs(backLatitudes[i] - latitudes[i]));
+        positionError = std::max(positionError, std::fabs(backLongitudes[i] - longitudes[i]));
+        altitudeError = std::max(altitudeError, std::fabs(backAltitudes[i] - altitudes[i]));
+    }
+    bench::report("accuracy.bearing", courseError * 1e9, "deg x 1e-9");
+    bench::report("accuracy.range", rangeError * 1e9, "nm x 1e-9");
+    bench::report("accuracy.roundtrip.position", positionError * 1e12, "deg x 1e-12");
+    bench::report("accuracy.roundtrip.altitude", altitudeError * 1e6, "ft x 1e-6");
+    for (int band=0; band<5; band++) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "flat.shortfall.%.0fnm", kRanges[band]);
+        bench::report(name, shortfall[band], "nm");
+    }
+    if (courseError > 1e-9 || rangeError > 1e-9 || positionError > 1e-11 || altitudeError > 1e-6) {
+        std::fprintf(stderr, "local frame outside its stated bounds\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownship;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownship, traffic)) {
+        return 1;
+    }
+
+    LocalFrame frame;
+    int reanchors = 0;
+    for (size_t i=0; i<ownship.size(); i++) {
+        geodesy::GeoPoint position{ownship.latitude[i], ownship.longitude[i]};
+        reanchors += frame.update(position, ownship.altitude[i]);
+        double east, north, up;
+        frame.toLocal(position, ownship.altitude[i], east, north, up);
+        if (std::hypot(east, north) > frame.settings().reanchorDistance + 1e-9) {
+            std::fprintf(stderr, "ownship sample %zu is %.3f nm from the anchor\n", i, std::hypot(east, north));
+            return 1;
+        }
+    }
+    bench::report("ownship.samples", (double)ownship.size(), "samples");
+    bench::report("ownship.reanchors", reanchors, "reanchors");
+
+    const size_t count = 10000;
+    geodesy::GeoPoint origin{ownship.latitude[0], ownship.longitude[0]};
+    frame.anchor(origin, ownship.altitude[0]);
+    std::mt19937 random(37);
+    std::uniform_real_distribution<double> bearing(0, 360);
+    std::uniform_real_distribution<double> range(0, 250);
+    std::uniform_real_distribution<double> height(0, 45000);
+    std::vector<double> latitudes(count), longitudes(count), altitudes(count);
+    for (size_t i=0; i<count; i++) {
+        geodesy::GeoPoint point = geodesy::pointOnRadial(origin, bearing(random), range(random));
+        latitudes[i] = point.latitude;
+        longitudes[i] = point.longitude;
+        altitudes[i] = height(random);
+    }
+    if (!checkTargets(frame, latitudes, longitudes, altitudes)) {
+        return 1;
+    }
+
+    // Past the near hemisphere: 90 degrees from the anchor, on the horizon, and finite.
+    const double beyond[] = {geodesy::kNauticalMilesPerRadian, 4000, 1e6};
+    for (double distance : beyond) {
+        geodesy::GeoPoint position;
+        double altitude;
+        frame.toGeodetic(distance, 0, 0, position, altitude);
+        double fromAnchor = geodesy::nauticalMilesBetween(origin, position) / geodesy::kNauticalMilesPerRadian;
+        if (!std::isfinite(altitude) || std::fabs(fromAnchor - geodesy::kPi / 2) > 1e-6) {
+            std::fprintf(stderr, "a point %.0f nm out comes back %.6f rad from the anchor at %g ft\n", distance, fromAnchor, altitude);
+            return 1;
+        }
+    }
+
+    const int frames = 200;
+    std::vector<double> east(count), north(count), up(count), ranges(count), courses(count);
+    double checksum = 0;
+    bench::Stopwatch frameTimer;
+    for (int i=0; i<frames; i++) {
+        frame.toLocal(latitudes.data(), longitudes.data(), altitudes.data(), east.data(), north.data(), up.data(), count);
+        checksum += east[i] + north[i];
+    }
+    double local = frameTimer.elapsed();
+
+    bench::Stopwatch scalarTimer;
+    for (int i=0; i<frames; i++) {
+        for (size_t j=0; j<count; j++) {
+            geodesy::GeoPoint point{latitudes[j], longitudes[j]};
+            ranges[j] = geodesy::nauticalMilesBetween(origin, point);
+            courses[j] = geodesy::courseDegrees(origin, point);
+        }
+        checksum += ranges[i];
+    }
+    double scalar = scalarTimer.elapsed();
+
+    bench::Stopwatch batchTimer;
+    for (int i=0; i<frames; i++) {
+        geodesy::rangesAndCourses(origin, latitudes.data(), longitudes.data(), ranges.data(), courses.data(), count);
+        checksum -= ranges[i];
+    }
+    double batch = batchTimer.elapsed();
+
+    bench::report("frame.toLocal", local / frames * 1e6, "us per 10k targets");
+    bench::report("frame.scalar.rangeCourse", scalar / frames * 1e6, "us per 10k targets");
+    bench::report("frame.batch.rangeCourse", batch / frames * 1e6, "us per 10k targets");
+    bench::report("checksum", checksum, "");
+    return 0;
+}
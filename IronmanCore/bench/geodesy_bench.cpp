@@ -0,0 +1,186 @@
+//
+//  geodesy_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 20/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks the batch geodesy kernels against the scalar ones and measures both.
+//  - 200k random pairs over the whole globe, plus pairs across the antimeridian, at and next to the
+//    poles, coincident and nearly antipodal, must agree with the scalar kernels within the tolerances
+//    GeodesyBatch.hpp states, with its exceptions: courses are not compared from a pole, between
+//    coincident points or near the antipode, nor radial positions at a pole, and distances within a
+//    mile of the antipode only to the looser bound.
+//  - Throughput of ranges and courses from the recorded ownship to 10k targets within 100 nm, and of
+//    the pairwise kernels, against a loop over the scalar kernels.
+//
+//   geodesy_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/GeodesyBatch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace ironman;
+
+static const double kAntipodeDistance = geodesy::kPi * geodesy::kNauticalMilesPerRadian;
+
+struct Pairs {
+    std::vector<double> latitude1, longitude1, latitude2, longitude2;
+
+    void add(double lat1, double lon1, double lat2, double lon2){
+        latitude1.push_back(lat1);
+        longitude1.push_back(lon1);
+        latitude2.push_back(lat2);
+        longitude2.push_back(lon2);
+    }
+    size_t size() const { return latitude1.size(); }
+};
+
+static Pairs buildPairs(){
+    std::mt19937 random(23);
+    std::uniform_real_distribution<double> unit(-1, 1);
+    std::uniform_real_distribution<double> longitude(-180, 180);
+    std::uniform_real_distribution<double> small(-0.5, 0.5);
+    Pairs pairs;
+    for (int i=0; i<200000; i++) {
+        // Uniform on the sphere rather than in latitude.
+        pairs.add(geodesy::toDegrees(std::asin(unit(random))), longitude(random),
+                  geodesy::toDegrees(std::asin(unit(random))), longitude(random));
+    }
+    for (int i=0; i<1000; i++) {
+        double latitude = small(random) * 120;
+        pairs.add(latitude, 179.9 + small(random) * 0.1, latitude + small(random), -179.9 + small(random) * 0.1);
+        pairs.add(90, longitude(random), 90 - std::fabs(small(random)), longitude(random));
+        pairs.add(-90 + std::fabs(small(random)) * 1e-6, longitude(random), small(random) * 160, longitude(random));
+        double lon = longitude(random);
+        pairs.add(latitude, lon, latitude, lon);
+        pairs.add(latitude, lon, -latitude + small(random) * 1e-3, lon + 180 + small(random) * 1e-3);
+    }
+    return pairs;
+}
+
+static double degreesApart(double a, double b){
+    double difference = std::fmod(std::fabs(a - b), 360.0);
+    return std::min(difference, 360.0 - difference);
+}
+
+static bool checkPairs(const Pairs &pairs){
+    size_t n = pairs.size();
+    std::vector<double> distances(n), courses(n), latitudes(n), longitudes(n);
+    geodesy::nauticalMilesBetween(pairs.latitude1.data(), pairs.longitude1.data(), pairs.latitude2.data(),
+                                  pairs.longitude2.data(), distances.data(), n);
+    geodesy::coursesDegrees(pairs.latitude1.data(), pairs.longitude1.data(), pairs.latitude2.data(),
+                            pairs.longitude2.data(), courses.data(), n);
+    // The second point's coordinates double as a radial and a distance.
+    std::vector<double> radials(n), ranges(n);
+    for (size_t i=0; i<n; i++) {
+        radials[i] = pairs.longitude2[i] + 180;
+        ranges[i] = (pairs.latitude2[i] + 90) * 60;
+    }
+    geodesy::pointsOnRadial(pairs.latitude1.data(), pairs.longitude1.data(), radials.data(), ranges.data(),
+                            latitudes.data(), longitudes.data(), n);
+
+    double distanceError = 0, antipodeError = 0, courseError = 0, radialError = 0;
+    for (size_t i=0; i<n; i++) {
+        geodesy::GeoPoint point1{pairs.latitude1[i], pairs.longitude1[i]};
+        geodesy::GeoPoint point2{pairs.latitude2[i], pairs.longitude2[i]};
+        double distance = geodesy::nauticalMilesBetween(point1, point2);
+        // Within a mile of the antipode the scalar kernel's asin has lost half its digits.
+        if (distance < kAntipodeDistance - 1) {
+            distanceError = std::max(distanceError, std::fabs(distances[i] - distance));
+        }
+        else {
+            antipodeError = std::max(antipodeError, std::fabs(distances[i] - distance));
+        }
+        if (distance > 1e-6 && distance < kAntipodeDistance - 1 && std::fabs(pairs.latitude1[i]) < 89.99) {
+            courseError = std::max(courseError, degreesApart(courses[i], geodesy::courseDegrees(point1, point2)));
+        }
+        if (!(courses[i] >= 0 && courses[i] < 360)) {
+            std::fprintf(stderr, "course %.17g out of range\n", courses[i]);
+            return false;
+        }
+        geodesy::GeoPoint point = geodesy::pointOnRadial(point1, radials[i], ranges[i]);
+        if (std::fabs(point.latitude) < 89.99 && std::fabs(pairs.latitude1[i]) < 89.99) {
+            radialError = std::max(radialError, std::fabs(latitudes[i] - point.latitude));
+            radialError = std::max(radialError, degreesApart(longitudes[i], point.longitude));
+        }
+    }
+    bench::report("accuracy.distance", distanceError * 1e9, "nm x 1e-9");
+    bench::report("accuracy.distance.antipode", antipodeError * 1e9, "nm x 1e-9");
+    bench::report("accuracy.course", courseError * 1e9, "deg x 1e-9");
+    bench::report("accuracy.radial", radialError * 1e9, "deg x 1e-9");
+    if (distanceError > 1e-9 || antipodeError > 1e-5 || courseError > 1e-9 || radialError > 1e-10) {
+        std::fprintf(stderr, "batch kernels outside their stated tolerances\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownshipTrack;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownshipTrack, traffic)) {
+        return 1;
+    }
+    if (!checkPairs(buildPairs())) {
+        return 1;
+    }
+
+    const size_t count = 10000;
+    const int frames = 200;
+    geodesy::GeoPoint ownship{ownshipTrack[0].latitude, ownshipTrack[0].longitude};
+    std::mt19937 random(31);
+    std::uniform_real_distribution<double> bearing(0, 360);
+    std::uniform_real_distribution<double> range(0, 100);
+    std::vector<double> latitudes(count), longitudes(count), ownLatitudes(count, ownship.latitude),
+        ownLongitudes(count, ownship.longitude);
+    for (size_t i=0; i<count; i++) {
+        geodesy::GeoPoint point = geodesy::pointOnRadial(ownship, bearing(random), range(random));
+        latitudes[i] = point.latitude;
+        longitudes[i] = point.longitude;
+    }
+    std::vector<double> ranges(count), courses(count);
+
+    double checksum = 0;
+    bench::Stopwatch scalarTimer;
+    for (int frame=0; frame<frames; frame++) {
+        for (size_t i=0; i<count; i++) {
+            geodesy::GeoPoint point{latitudes[i], longitudes[i]};
+            ranges[i] = geodesy::nauticalMilesBetween(ownship, point);
+            courses[i] = geodesy::courseDegrees(ownship, point);
+        }
+        checksum += ranges[frame] + courses[frame];
+    }
+    double scalar = scalarTimer.elapsed();
+
+    bench::Stopwatch batchTimer;
+    for (int frame=0; frame<frames; frame++) {
+        geodesy::rangesAndCourses(ownship, latitudes.data(), longitudes.data(), ranges.data(), courses.data(), count);
+        checksum -= ranges[frame] + courses[frame];
+    }
+    double batch = batchTimer.elapsed();
+
+    bench::Stopwatch pairwiseTimer;
+    for (int frame=0; frame<frames; frame++) {
+        geodesy::nauticalMilesBetween(ownLatitudes.data(), ownLongitudes.data(), latitudes.data(), longitudes.data(),
+                                      ranges.data(), count);
+        geodesy::coursesDegrees(ownLatitudes.data(), ownLongitudes.data(), latitudes.data(), longitudes.data(),
+                                courses.data(), count);
+    }
+    double pairwise = pairwiseTimer.elapsed();
+
+    double targets = (double)count * frames;
+    bench::report("range.course.scalar", targets / scalar / 1e6, "M targets/s");
+    bench::report("range.course.batch", targets / batch / 1e6, "M targets/s");
+    bench::report("range.course.pairwise", targets / pairwise / 1e6, "M targets/s");
+    bench::report("range.course.frame", batch / frames * 1e6, "us per 10k targets");
+    bench::report("speedup", scalar / batch, "x");
+    // The scalar and batch passes cancel to within the kernels' agreement.
+    bench::report("checksum", checksum, "");
+    return 0;
+}
@@ -0,0 +1,190 @@
+//
+//  history_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 17/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks the trail history's deltas and measures what they save over resending whole trails.
+//  - 2000 targets report at random, some stop and some are removed and come back. A renderer that
+//    only applies each frame's removals, evictions and appends holds exactly the trails of a plain
+//    deque per target with the same capacity and age limit.
+//  - 10k targets reporting at 1 Hz into 600-point trails, drawn at 60 fps: the cost of a frame's
+//    appends and changes, points pushed as deltas against points resent as whole trails, and heap
+//    allocations once every target has a slot.
+//
+//   history_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/TrailHistory.hpp"
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <unordered_map>
+
+using namespace ironman;
+
+typedef std::unordered_map<int64_t, std::deque<TrailPoint>> Trails;
+
+// The same rules as the history, a deque per target.
+struct Reference {
+    TrailHistorySettings settings;
+    Trails trails;
+
+    void append(int64_t trackId, const TrailPoint &point){
+        std::deque<TrailPoint> &trail = trails[trackId];
+        if (!trail.empty() && !(point.time > trail.back().time)) {
+            return;
+        }
+        expire(trail, point.time);
+        if (trail.size() == settings.capacity) {
+            trail.pop_front();
+        }
+        trail.push_back(point);
+    }
+
+    void expire(std::deque<TrailPoint> &trail, double time){
+        while (!trail.empty() && trail.front().time < time - settings.maxAge) {
+            trail.pop_front();
+        }
+    }
+};
+
+// Applies one frame's deltas to the renderer's copies.
+static void apply(const std::vector<TrailChange> &changed, const std::vector<int64_t> &removed, Trails &rendered){
+    for (int64_t trackId : removed) {
+        rendered.erase(trackId);
+    }
+    for (const TrailChange &change : changed) {
+        std::deque<TrailPoint> &trail = rendered[change.trackId];
+        if (change.created) {
+            trail.clear();
+        }
+        trail.erase(trail.begin(), trail.begin() + change.evicted);
+        for (const TrailSpan &span : change.appended) {
+            trail.insert(trail.end(), span.points, span.points + span.count);
+        }
+    }
+}
+
+static bool same(const Trails &rendered, const Reference &reference, const TrailHistory &history){
+    for (const auto &entry : reference.trails) {
+        auto found = rendered.find(entry.first);
+        size_t renderedCount = found == rendered.end() ? 0 : found->second.size();
+        if (renderedCount != entry.second.size() || history.count(entry.first) != entry.second.size()) {
+            std::fprintf(stderr, "target %lld: %zu points rendered, %zu held, %zu expected\n", (long long)entry.first, renderedCount,
+                         history.count(entry.first), entry.second.size());
+            return false;
+        }
+        TrailSpan spans[2];
+        int spanCount = history.points(entry.first, spans);
+        size_t index = 0;
+        for (int s=0; s<spanCount; s++) {
+            for (size_t i=0; i<spans[s].count; i++, index++) {
+                if (spans[s].points[i].time != entry.second[index].time || found->second[index].time != entry.second[index].time) {
+                    std::fprintf(stderr, "target %lld: point %zu differs\n", (long long)entry.first, index);
+                    return false;
+                }
+            }
+        }
+    }
+    if (rendered.size() != reference.trails.size() || history.size() != reference.trails.size()) {
+        std::fprintf(stderr, "%zu trails rendered, %zu held, %zu expected\n", rendered.size(), history.size(), reference.trails.size());
+        return false;
+    }
+    return true;
+}
+
+static TrailPoint pointAt(const TrackColumns &traffic, int64_t trackId, double time){
+    TrackSample sample = traffic[(size_t)trackId % traffic.size()];
+    return TrailPoint{time, sample.latitude + trackId * 1e-4, sample.longitude + time * 1e-5, sample.altitude};
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownship;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownship, traffic)) {
+        return 1;
+    }
+
+    // Random traffic, small rings and a short age limit so both kinds of eviction happen often.
+    TrailHistorySettings settings;
+    settings.capacity = 48;
+    settings.maxAge = 30;
+    TrailHistory history(settings);
+    Reference reference;
+    reference.settings = settings;
+    Trails rendered;
+    std::vector<TrailChange> changed;
+    std::vector<int64_t> removed;
+    std::mt19937 random(11);
+    std::uniform_real_distribution<double> chance(0, 1);
+    for (int frame=0; frame<3000; frame++) {
+        double time = frame / 10.0;
+        for (int64_t trackId=0; trackId<2000; trackId++) {
+            double roll = chance(random);
+            // Targets above 1500 go quiet for long stretches.
+            if (roll < (trackId > 1500 ? 0.01 : 0.3)) {
+                TrailPoint point = pointAt(traffic, trackId, time);
+                history.append(trackId, point);
+                reference.append(trackId, point);
+            }
+            else if (roll > 0.9995) {
+                history.remove(trackId);
+                reference.trails.erase(trackId);
+            }
+        }
+        if (frame % 7 == 0) {
+            history.expire(time);
+            for (auto &entry : reference.trails) {
+                reference.expire(entry.second, time);
+            }
+        }
+        history.changes(changed, removed);
+        apply(changed, removed, rendered);
+        if (frame % 100 == 99 && !same(rendered, reference, history)) {
+            std::fprintf(stderr, "frame %d\n", frame);
+            return 1;
+        }
+    }
+    bench::report("deltas.frames", 3000, "frames matched");
+
+    // 10k targets at 1 Hz, a sixtieth of them per frame, after the trails have filled.
+    const int64_t targets = 10000;
+    TrailHistory timed;
+    for (int second=0; second<700; second++) {
+        for (int64_t trackId=0; trackId<targets; trackId++) {
+            timed.append(trackId, pointAt(traffic, trackId, second + trackId % 60 / 60.0));
+        }
+    }
+    timed.changes(changed, removed);
+    size_t allocationsBefore = bench::allocationCount();
+    double elapsed = 0;
+    size_t deltaPoints = 0;
+    size_t wholePoints = 0;
+    const int frames = 600;
+    for (int frame=0; frame<frames; frame++) {
+        double time = 700 + frame / 60.0;
+        bench::Stopwatch timer;
+        for (int64_t trackId=frame%60; trackId<targets; trackId+=60) {
+            timed.append(trackId, pointAt(traffic, trackId, time));
+        }
+        timed.changes(changed, removed);
+        elapsed += timer.elapsed();
+        for (const TrailChange &change : changed) {
+            deltaPoints += change.evicted + change.appended[0].count + change.appended[1].count;
+            wholePoints += timed.count(change.trackId);
+        }
+    }
+    bench::report("frame.10k", elapsed / frames * 1e6, "us/frame");
+    bench::report("frame.deltaPoints", (double)deltaPoints / frames, "points/frame");
+    bench::report("frame.wholeTrailPoints", (double)wholePoints / frames, "points/frame");
+    bench::report("frame.allocations", (double)(bench::allocationCount() - allocationsBefore), "allocations");
+    if (bench::allocationCount() != allocationsBefore) {
+        std::fprintf(stderr, "steady frames allocated\n");
+        return 1;
+    }
+    return 0;
+}
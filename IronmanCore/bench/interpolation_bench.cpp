@@ -0,0 +1,136 @@
+//
+//  interpolation_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 11/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks the Hermite track interpolator and measures its cost at 60 fps playback.
+//  - Every recorded sample is reproduced exactly at its own time.
+//  - A target flying a standard rate turn is sampled at 1 Hz and evaluated at 60 fps; the position
+//    error against the true circle is compared with straight-line interpolation.
+//  - Evaluation cost for forward playback (cached segment) and for random seeks.
+//
+//   interpolation_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/Geodesy.hpp"
+#include "ironman/TrackInterpolator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace ironman;
+
+static bool reproducesSamples(const TrackColumns &track){
+    TrackInterpolator interpolator(track);
+    for (size_t i=0; i<track.size(); i++) {
+        TrackState state = interpolator.evaluate((double)track.timeOfApplicability[i]);
+        if (std::fabs(state.latitude - track.latitude[i]) > 1e-9 || std::fabs(state.longitude - track.longitude[i]) > 1e-9
+            || std::fabs(state.altitude - track.altitude[i]) > 1e-6) {
+            std::fprintf(stderr, "sample %zu is not reproduced\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+// A 3 degree/second turn of the given radius around center, clockwise.
+struct Turn {
+    geodesy::GeoPoint center;
+    double radius;
+    double rate;
+
+    geodesy::GeoPoint position(double time) const{
+        return geodesy::pointOnRadial(center, rate * time, radius);
+    }
+    double groundSpeed() const{
+        return radius * geodesy::toRadians(rate) * 3600.0;
+    }
+};
+
+static TrackColumns sampleTurn(const Turn &turn, int64_t duration){
+    TrackColumns track;
+    for (int64_t time=0; time<=duration; time++) {
+        geodesy::GeoPoint position = turn.position((double)time);
+        TrackSample sample;
+        sample.timeOfApplicability = time;
+        sample.latitude = position.latitude;
+        sample.longitude = position.longitude;
+        sample.altitude = 10000 + 25.0 * time;
+        sample.groundSpeed = turn.groundSpeed();
+        sample.trackAngle = std::fmod(turn.rate * time + 90.0 + 360.0, 360.0);
+        sample.verticalSpeed = 25.0 * 60.0;
+        track.push_back(sample);
+    }
+    return track;
+}
+
+static geodesy::GeoPoint linearPosition(const TrackColumns &track, double time){
+    size_t i = std::min((size_t)time, track.size() - 2);
+    double u = time - (double)track.timeOfApplicability[i];
+    return geodesy::GeoPoint{track.latitude[i] + u * (track.latitude[i + 1] - track.latitude[i]),
+                             track.longitude[i] + u * (track.longitude[i + 1] - track.longitude[i])};
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownship;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownship, traffic)) {
+        return 1;
+    }
+    if (!reproducesSamples(ownship) || !reproducesSamples(traffic)) {
+        return 1;
+    }
+
+    // Error against the true turn at 60 fps, Hermite against straight lines between samples.
+    Turn turn{geodesy::GeoPoint{ownship.latitude[0], ownship.longitude[0]}, 2.0, 3.0};
+    const int64_t duration = 3600;
+    TrackColumns track = sampleTurn(turn, duration);
+    TrackInterpolator interpolator(track);
+    double hermiteError = 0;
+    double linearError = 0;
+    double climbError = 0;
+    for (int64_t frame=0; frame<=duration * 60; frame++) {
+        double time = frame / 60.0;
+        geodesy::GeoPoint truth = turn.position(time);
+        TrackState state = interpolator.evaluate(time);
+        hermiteError = std::max(hermiteError, geodesy::nauticalMilesBetween(truth, geodesy::GeoPoint{state.latitude, state.longitude}));
+        linearError = std::max(linearError, geodesy::nauticalMilesBetween(truth, linearPosition(track, time)));
+        climbError = std::max(climbError, std::fabs(state.altitude - (10000 + 25.0 * time)));
+    }
+    bench::report("turn.maxError.hermite", hermiteError * geodesy::kMetersPerNauticalMile, "m");
+    bench::report("turn.maxError.linear", linearError * geodesy::kMetersPerNauticalMile, "m");
+    bench::report("turn.maxError.altitude", climbError, "ft");
+    if (hermiteError >= linearError || climbError > 1e-6) {
+        std::fprintf(stderr, "Hermite interpolation is no closer to the turn than straight lines\n");
+        return 1;
+    }
+
+    // Forward playback at 60 fps over the hour.
+    double checksum = 0;
+    size_t evaluations = 0;
+    bench::Stopwatch playbackTimer;
+    for (int pass=0; pass<5; pass++) {
+        for (int64_t frame=0; frame<=duration * 60; frame++, evaluations++) {
+            checksum += interpolator.evaluate(frame / 60.0).latitude;
+        }
+    }
+    bench::report("evaluate.playback60fps", playbackTimer.elapsed() / evaluations * 1e9, "ns/eval");
+
+    // Seeks to random times.
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> times(0, (double)duration);
+    std::vector<double> seeks(evaluations);
+    std::generate(seeks.begin(), seeks.end(), [&]{ return times(random); });
+    bench::Stopwatch seekTimer;
+    for (double time : seeks) {
+        checksum += interpolator.evaluate(time).latitude;
+    }
+    bench::report("evaluate.randomSeek", seekTimer.elapsed() / evaluations * 1e9, "ns/eval");
+
+    std::printf("checksum %.6f\n", checksum);
+    return 0;
+}
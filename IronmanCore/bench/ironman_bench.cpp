@@ -0,0 +1,284 @@
+//
+//  ironman_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 08/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Baseline for the core: rows/sec decoded from a recording, through SQLite and through its .trk
+// archive, the per-frame cost of ranging the ownship against a field of targets, and the throughput
+// of the ownship/traffic merge join, checked against a brute-force join.
+//
+//   ironman_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/DBTrackArchive.h"
+#include "ironman/Geodesy.hpp"
+#include "ironman/MergeJoin.hpp"
+#include "ironman/TrackReader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace ironman;
+
+static bool columnsMatch(const TrackColumns &expected, const TrackColumns &actual){
+    if (expected.size() != actual.size()) {
+        return false;
+    }
+    for (size_t i=0; i<expected.size(); i++) {
+        TrackSample a = expected[i];
+        TrackSample b = actual[i];
+        if (a.timeOfApplicability != b.timeOfApplicability || a.latitude != b.latitude || a.longitude != b.longitude
+            || a.altitude != b.altitude || a.groundSpeed != b.groundSpeed || a.trackAngle != b.trackAngle
+            || a.verticalSpeed != b.verticalSpeed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Joins by trying every traffic sample against every tick.
+static std::vector<std::vector<RelativeGeometry>> bruteForceJoin(const TrackColumns &ownship, const TrackColumns &traffic, int64_t tolerance){
+    std::vector<int64_t> trackIds(traffic.trackId);
+    std::sort(trackIds.begin(), trackIds.end());
+    trackIds.erase(std::unique(trackIds.begin(), trackIds.end()), trackIds.end());
+
+    std::vector<std::vector<RelativeGeometry>> ticks;
+    for (size_t tick=0; tick<ownship.size(); tick++) {
+        int64_t time = ownship.timeOfApplicability[tick];
+        std::vector<RelativeGeometry> targets;
+        for (int64_t trackId : trackIds) {
+            long nearest = -1;
+            for (size_t i=0; i<traffic.size(); i++) {
+                int64_t distance = std::llabs(traffic.timeOfApplicability[i] - time);
+                if (traffic.trackId[i] != trackId || distance > tolerance) {
+                    continue;
+                }
+                if (nearest < 0 || distance < std::llabs(traffic.timeOfApplicability[nearest] - time)
+                    || (distance == std::llabs(traffic.timeOfApplicability[nearest] - time) && traffic.timeOfApplicability[i] < traffic.timeOfApplicability[nearest])) {
+                    nearest = (long)i;
+                }
+            }
+            if (nearest >= 0) {
+                targets.push_back(relativeGeometry(ownship[tick], traffic[nearest], time));
+            }
+        }
+        ticks.push_back(targets);
+    }
+    return ticks;
+}
+
+static bool joinMatchesBruteForce(TrackSource &ownshipSource, TrackSource &trafficSource, const TrackColumns &ownship, const TrackColumns &traffic, int64_t tolerance, size_t *pairCount){
+    std::vector<std::vector<RelativeGeometry>> expected = bruteForceJoin(ownship, traffic, tolerance);
+    MergeJoin join(ownshipSource, trafficSource, tolerance);
+    size_t tick = 0;
+    *pairCount = 0;
+    for (; join.next(); tick++) {
+        const std::vector<RelativeGeometry> &targets = join.targets();
+        if (tick >= expected.size() || targets.size() != expected[tick].size()) {
+            return false;
+        }
+        for (size_t i=0; i<targets.size(); i++) {
+            const RelativeGeometry &a = targets[i];
+            const RelativeGeometry &b = expected[tick][i];
+            if (a.trackId != b.trackId || a.sampleTime != b.sampleTime || a.range != b.range || a.bearing != b.bearing
+                || a.relativeAltitude != b.relativeAltitude || a.closureRate != b.closureRate) {
+                return false;
+            }
+        }
+        *pairCount += targets.size();
+    }
+    return tick == expected.size();
+}
+
+// Targets circling the first ownship position, each on its own irregular time base, interleaved in time
+// order as TRACK streams them.
+static TrackColumns syntheticTraffic(const TrackSample &origin, size_t targetCount, int64_t duration){
+    std::vector<TrackSample> samples;
+    for (size_t target=0; target<targetCount; target++) {
+        int64_t period = 1 + (int64_t)(target % 3);
+        for (int64_t time=(int64_t)(target % 5); time<duration; time+=period) {
+            double angle = (double)(target * 37 % 360) + time * 0.1;
+            geodesy::GeoPoint position = geodesy::pointOnRadial(geodesy::GeoPoint{origin.latitude, origin.longitude}, angle, 2 + (target % 40) * 0.5);
+            TrackSample sample;
+            sample.trackId = (int64_t)target;
+            sample.timeOfApplicability = origin.timeOfApplicability + time;
+            sample.latitude = position.latitude;
+            sample.longitude = position.longitude;
+            sample.altitude = origin.altitude + (double)(target % 20) * 100 - 1000;
+            sample.groundSpeed = 120 + (double)(target % 7) * 10;
+            sample.trackAngle = std::fmod(angle + 90, 360);
+            sample.verticalSpeed = (double)(target % 5) * 100 - 200;
+            samples.push_back(sample);
+        }
+    }
+    std::stable_sort(samples.begin(), samples.end(), [](const TrackSample &a, const TrackSample &b){
+        return a.timeOfApplicability < b.timeOfApplicability;
+    });
+    TrackColumns columns;
+    columns.reserve(samples.size());
+    for (const TrackSample &sample : samples) {
+        columns.push_back(sample);
+    }
+    return columns;
+}
+
+// Ownship flying straight and level at 1 Hz from the first recorded ownship sample.
+static TrackColumns syntheticOwnship(const TrackSample &origin, int64_t duration){
+    TrackColumns columns;
+    for (int64_t time=0; time<duration; time++) {
+        TrackSample sample = origin;
+        geodesy::GeoPoint position = geodesy::pointOnRadial(geodesy::GeoPoint{origin.latitude, origin.longitude}, origin.trackAngle, origin.groundSpeed * time / 3600.0);
+        sample.timeOfApplicability = origin.timeOfApplicability + time;
+        sample.latitude = position.latitude;
+        sample.longitude = position.longitude;
+        columns.push_back(sample);
+    }
+    return columns;
+}
+
+static bool runJoinBenchmarks(Database &database, const TrackColumns &ownship, const TrackColumns &traffic){
+    // The recording streamed straight from SQLite, checked against the brute-force join.
+    StatementTrackSource recordedOwnship(database, TrackTable::Ownship);
+    StatementTrackSource recordedTraffic(database, TrackTable::Traffic);
+    size_t pairCount = 0;
+    if (!joinMatchesBruteForce(recordedOwnship, recordedTraffic, ownship, traffic, 1, &pairCount)) {
+        std::fprintf(stderr, "merge join does not match the brute-force join on the recording\n");
+        return false;
+    }
+    bench::report("join.recording.pairs", (double)pairCount, "pairs");
+
+    // Irregular time bases, duplicates within the window and targets dropping in and out.
+    for (int64_t tolerance=0; tolerance<=3; tolerance++) {
+        TrackColumns smallOwnship = syntheticOwnship(ownship[0], 300);
+        TrackColumns smallTraffic = syntheticTraffic(ownship[0], 40, 300);
+        ColumnsTrackSource ownshipSource(smallOwnship);
+        ColumnsTrackSource trafficSource(smallTraffic);
+        if (!joinMatchesBruteForce(ownshipSource, trafficSource, smallOwnship, smallTraffic, tolerance, &pairCount)) {
+            std::fprintf(stderr, "merge join does not match the brute-force join with tolerance %lld\n", (long long)tolerance);
+            return false;
+        }
+    }
+
+    // Throughput over an hour of 1000 targets.
+    const int64_t duration = 3600;
+    TrackColumns longOwnship = syntheticOwnship(ownship[0], duration);
+    TrackColumns longTraffic = syntheticTraffic(ownship[0], 1000, duration);
+    ColumnsTrackSource ownshipSource(longOwnship);
+    ColumnsTrackSource trafficSource(longTraffic);
+    MergeJoin join(ownshipSource, trafficSource, 1);
+    size_t tickCount = 0;
+    pairCount = 0;
+    double checksum = 0;
+    bench::Stopwatch joinTimer;
+    while (join.next()) {
+        tickCount++;
+        pairCount += join.targets().size();
+        for (const RelativeGeometry &geometry : join.targets()) {
+            checksum += geometry.closureRate;
+        }
+    }
+    double elapsed = joinTimer.elapsed();
+    bench::report("join.1000targets.ticks", tickCount / elapsed, "ticks/s");
+    bench::report("join.1000targets.pairs", pairCount / elapsed, "pairs/s");
+    bench::report("join.1000targets.rows", (longOwnship.size() + longTraffic.size()) / elapsed, "rows/s");
+    std::printf("join checksum %.6f\n", checksum);
+    return true;
+}
+
+int main(int argc, char **argv){
+    std::string databasePath = bench::databasePath(argc, argv);
+    Database database;
+    if (!database.open(databasePath)) {
+        return 1;
+    }
+    std::printf("%s\n", databasePath.c_str());
+
+    // Decode both tables repeatedly, refilling the same columns.
+    const int passes = 20000;
+    TrackReader reader(database);
+    TrackColumns traffic;
+    TrackColumns ownship;
+    size_t rowCount = 0;
+    double checksum = 0;
+    bench::Stopwatch decodeTimer;
+    for (int pass=0; pass<passes; pass++) {
+        traffic.clear();
+        ownship.clear();
+        if (!reader.load(TrackTable::Traffic, traffic) || !reader.load(TrackTable::Ownship, ownship)) {
+            return 1;
+        }
+        rowCount += traffic.size() + ownship.size();
+        checksum += traffic.latitude.back() + ownship.latitude.back();
+    }
+    bench::report("decode.sqlite", rowCount / decodeTimer.elapsed(), "rows/s");
+
+    // The same through the archive, opening it every pass.
+    std::string archivePath = bench::scratchPath("ironman_bench.trk");
+    if (DBTrackArchiveWriteFromDatabase(databasePath.c_str(), archivePath.c_str()) != 0) {
+        return 1;
+    }
+    TrackColumns archivedTraffic;
+    TrackColumns archivedOwnship;
+    rowCount = 0;
+    bench::Stopwatch archiveTimer;
+    for (int pass=0; pass<passes; pass++) {
+        DBTrackArchive *archive = DBTrackArchiveOpen(archivePath.c_str());
+        if (archive == nullptr) {
+            return 1;
+        }
+        archivedTraffic.clear();
+        archivedOwnship.clear();
+        appendArchiveSpan(DBTrackArchiveGetTable(archive, DBTrackArchiveTableTraffic), archivedTraffic);
+        appendArchiveSpan(DBTrackArchiveGetTable(archive, DBTrackArchiveTableOwnship), archivedOwnship);
+        DBTrackArchiveClose(archive);
+        rowCount += archivedTraffic.size() + archivedOwnship.size();
+    }
+    bench::report("decode.archive", rowCount / archiveTimer.elapsed(), "rows/s");
+    std::remove(archivePath.c_str());
+    if (!columnsMatch(traffic, archivedTraffic) || !columnsMatch(ownship, archivedOwnship)) {
+        std::fprintf(stderr, "archive does not match the database\n");
+        return 1;
+    }
+    if (traffic.empty() || ownship.empty()) {
+        std::fprintf(stderr, "recording has no TRAF or OWN samples\n");
+        return 1;
+    }
+
+    // Spread a field of targets around the recorded intruder positions.
+    const size_t targetCount = 1000;
+    std::vector<geodesy::GeoPoint> targets;
+    std::vector<double> targetAltitudes;
+    for (size_t i=0; i<targetCount; i++) {
+        TrackSample base = traffic[i % traffic.size()];
+        targets.push_back(geodesy::pointOnRadial(geodesy::GeoPoint{base.latitude, base.longitude}, (i * 37) % 360, (i % 50) * 0.5));
+        targetAltitudes.push_back(base.altitude + (double)(i % 20) * 100 - 1000);
+    }
+
+    // Every ownship sample is a frame: range, bearing and relative altitude to every target.
+    const int framePasses = 200;
+    size_t frameCount = 0;
+    bench::Stopwatch frameTimer;
+    for (int pass=0; pass<framePasses; pass++) {
+        for (size_t frame=0; frame<ownship.size(); frame++, frameCount++) {
+            geodesy::GeoPoint position{ownship.latitude[frame], ownship.longitude[frame]};
+            for (size_t i=0; i<targetCount; i++) {
+                double range = geodesy::nauticalMilesBetween(position, targets[i]);
+                double bearing = geodesy::courseDegrees(position, targets[i]);
+                double relativeAltitude = targetAltitudes[i] - ownship.altitude[frame];
+                checksum += range + bearing * 1e-3 + relativeAltitude * 1e-6;
+            }
+        }
+    }
+    double frameElapsed = frameTimer.elapsed();
+    bench::report("frame.rangeBearing.1000targets", frameElapsed / frameCount * 1e6, "us/frame");
+    bench::report("frame.rangeBearing.perTarget", frameElapsed / (frameCount * targetCount) * 1e9, "ns/target");
+
+    std::printf("checksum %.6f\n", checksum);
+
+    return runJoinBenchmarks(database, ownship, traffic) ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+//
+//  prediction_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 12/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks the dead-reckoning predictor and measures its per-frame cost.
+//  - 10,000 targets are scattered around the recorded traffic with the recorded speeds and climb rates
+//    and last-update ages of up to 15 seconds.
+//  - Every prediction is compared with the great-circle position along the target's track, and every
+//    status with its age.
+//  - A target flying east across the antimeridian is predicted on the far side, within [-180, 180].
+//  - predict is timed over a minute of 60 fps frames.
+//
+//   prediction_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/DeadReckoning.hpp"
+#include "ironman/Geodesy.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace ironman;
+
+static const size_t kTargetCount = 10000;
+
+static void fillTargets(const TrackColumns &traffic, double now, TargetTable &targets){
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> offset(-1.0, 1.0);
+    std::uniform_real_distribution<double> heading(0, 360);
+    std::uniform_real_distribution<double> age(0, 15);
+    for (size_t i=0; i<kTargetCount; i++) {
+        TrackSample sample = traffic[i % traffic.size()];
+        sample.trackId = (int64_t)i;
+        sample.latitude += offset(random);
+        sample.longitude += offset(random);
+        sample.trackAngle = heading(random);
+        if (!std::isfinite(sample.groundSpeed)) {
+            sample.groundSpeed = 450;
+        }
+        if (!std::isfinite(sample.verticalSpeed)) {
+            sample.verticalSpeed = 0;
+        }
+        // Whole-second sample times, as in the recording.
+        sample.timeOfApplicability = (int64_t)std::floor(now - age(random));
+        targets.update(sample);
+    }
+}
+
+static TargetStatus expectedStatus(double age, const PredictorSettings &settings){
+    if (age > settings.stalenessHorizon) {
+        return TargetStatus::Stale;
+    }
+    return age > settings.coastAfter ? TargetStatus::Coasting : TargetStatus::Current;
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownship;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownship, traffic)) {
+        return 1;
+    }
+
+    double now = (double)traffic.timeOfApplicability.back() + 0.5;
+    TargetTable targets;
+    fillTargets(traffic, now, targets);
+
+    DeadReckoningPredictor predictor;
+    const PredictorSettings &settings = predictor.settings();
+    PredictedTargets predicted;
+    predictor.predict(targets, now, predicted);
+
+    // Against the great circle along each target's track.
+    double positionError = 0;
+    double altitudeError = 0;
+    size_t statusCounts[3] = {0, 0, 0};
+    for (size_t i=0; i<targets.size(); i++) {
+        double age = now - targets.sampleTime()[i];
+        double step = std::min(std::max(age, 0.0), settings.stalenessHorizon);
+        geodesy::GeoPoint truth = geodesy::pointOnRadial(geodesy::GeoPoint{targets.latitude()[i], targets.longitude()[i]},
+                                                         targets.trackAngle()[i], targets.groundSpeed()[i] * step / 3600.0);
+        positionError = std::max(positionError, geodesy::nauticalMilesBetween(truth, geodesy::GeoPoint{predicted.latitude[i], predicted.longitude[i]}));
+        altitudeError = std::max(altitudeError, std::fabs(predicted.altitude[i] - (targets.altitude()[i] + targets.verticalSpeed()[i] * step / 60.0)));
+        if (predicted.status[i] != expectedStatus(age, settings)) {
+            std::fprintf(stderr, "target %zu has the wrong status at age %.1f s\n", i, age);
+            return 1;
+        }
+        statusCounts[(int)predicted.status[i]]++;
+    }
+    bench::report("targets.current", (double)statusCounts[0], "targets");
+    bench::report("targets.coasting", (double)statusCounts[1], "targets");
+    bench::report("targets.stale", (double)statusCounts[2], "targets");
+    bench::report("predict.maxError.position", positionError * geodesy::kMetersPerNauticalMile, "m");
+    bench::report("predict.maxError.altitude", altitudeError, "ft");
+    if (positionError * geodesy::kMetersPerNauticalMile > 1.0 || altitudeError > 1e-6) {
+        std::fprintf(stderr, "Dead reckoning is more than a metre off the great circle\n");
+        return 1;
+    }
+
+    // Eastbound at 450 knots from 0.01 degrees short of the antimeridian, ten seconds ago.
+    TargetTable crossing;
+    TrackSample eastbound = traffic[0];
+    eastbound.trackId = 0;
+    eastbound.latitude = 0;
+    eastbound.longitude = 179.99;
+    eastbound.groundSpeed = 450;
+    eastbound.trackAngle = 90;
+    eastbound.verticalSpeed = 0;
+    eastbound.timeOfApplicability = (int64_t)std::floor(now) - 10;
+    crossing.update(eastbound);
+    predictor.predict(crossing, now, predicted);
+    double crossingStep = std::min(now - crossing.sampleTime()[0], settings.stalenessHorizon);
+    geodesy::GeoPoint across = geodesy::pointOnRadial(geodesy::GeoPoint{0, 179.99}, 90, 450 * crossingStep / 3600.0);
+    double crossingError = geodesy::nauticalMilesBetween(across, geodesy::GeoPoint{predicted.latitude[0], predicted.longitude[0]});
+    bench::report("predict.antimeridian.longitude", predicted.longitude[0], "deg");
+    if (predicted.longitude[0] < -180 || predicted.longitude[0] > -179.9 || crossingError * geodesy::kMetersPerNauticalMile > 1.0) {
+        std::fprintf(stderr, "a target crossing the antimeridian is predicted at %.6f\n", predicted.longitude[0]);
+        return 1;
+    }
+    predictor.predict(targets, now, predicted);
+
+    // A minute of frames at 60 fps.
+    const int frames = 3600;
+    double checksum = 0;
+    bench::Stopwatch timer;
+    for (int frame=0; frame<frames; frame++) {
+        predictor.predict(targets, now + frame / 60.0, predicted);
+        checksum += predicted.latitude[frame % predicted.size()];
+    }
+    double perFrame = timer.elapsed() / frames;
+    bench::report("predict.10kTargets", perFrame * 1e6, "us/frame");
+    bench::report("predict.perTarget", perFrame / kTargetCount * 1e9, "ns/target");
+
+    std::printf("checksum %.6f\n", checksum);
+    return 0;
+}
@@ -0,0 +1,218 @@
+//
+//  proximity_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 14/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks the proximity grid against comparing every pair, and measures it as targets move.
+//  - Targets fly the recorded traffic's speeds on random tracks, scattered over a 300 nm square
+//    around the recorded ownship; the separation is 5 nm.
+//  - Pairs and neighbours match an all-pairs search after insertion, after two minutes of
+//    dead-reckoned motion with every crossing handled in place, and after removals.
+//  - Per-frame cost of moving every target and of listing the pairs, at 1k, 10k and 50k targets,
+//    against the all-pairs search.
+//
+//   proximity_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/DeadReckoning.hpp"
+#include "ironman/Geodesy.hpp"
+#include "ironman/ProximityGrid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <tuple>
+
+using namespace ironman;
+
+static const double kSeparation = 5.0;
+
+static void fillTargets(geodesy::GeoPoint center, const TrackColumns &traffic, size_t count, TargetTable &targets){
+    std::mt19937 random(23);
+    std::uniform_real_distribution<double> offset(-150, 150);
+    std::uniform_real_distribution<double> heading(0, 360);
+    targets.clear();
+    for (size_t i=0; i<count; i++) {
+        TrackSample sample = traffic[i % traffic.size()];
+        sample.trackId = (int64_t)i;
+        sample.timeOfApplicability = 0;
+        sample.latitude = center.latitude + offset(random) / 60.0;
+        sample.longitude = center.longitude + offset(random) / (60.0 * std::cos(geodesy::toRadians(center.latitude)));
+        sample.trackAngle = heading(random);
+        sample.groundSpeed = std::isfinite(sample.groundSpeed) ? sample.groundSpeed : 250;
+        targets.update(sample);
+    }
+}
+
+// Every pair, compared in the grid's frame.
+static std::vector<ProximityPair> allPairs(geodesy::GeoPoint origin, const std::vector<int64_t> &trackIds,
+                                           const std::vector<geodesy::GeoPoint> &positions){
+    double milesPerDegreeEast = 60.0 * std::cos(geodesy::toRadians(origin.latitude));
+    std::vector<double> east(positions.size());
+    std::vector<double> north(positions.size());
+    for (size_t i=0; i<positions.size(); i++) {
+        east[i] = (positions[i].longitude - origin.longitude) * milesPerDegreeEast;
+        north[i] = (positions[i].latitude - origin.latitude) * 60.0;
+    }
+    std::vector<ProximityPair> pairs;
+    for (size_t i=0; i<positions.size(); i++) {
+        for (size_t j=i+1; j<positions.size(); j++) {
+            double deltaEast = east[i] - east[j];
+            double deltaNorth = north[i] - north[j];
+            double range2 = deltaEast * deltaEast + deltaNorth * deltaNorth;
+            if (range2 <= kSeparation * kSeparation) {
+                bool ordered = trackIds[i] < trackIds[j];
+                pairs.push_back(ProximityPair{ordered ? trackIds[i] : trackIds[j], ordered ? trackIds[j] : trackIds[i], std::sqrt(range2)});
+            }
+        }
+    }
+    return pairs;
+}
+
+static void sortPairs(std::vector<ProximityPair> &pairs){
+    std::sort(pairs.begin(), pairs.end(), [](const ProximityPair &a, const ProximityPair &b){
+        return std::tie(a.first, a.second) < std::tie(b.first, b.second);
+    });
+}
+
+static bool pairsMatch(const char *stage, const ProximityGrid &grid, geodesy::GeoPoint origin,
+                       const std::vector<int64_t> &trackIds, const std::vector<geodesy::GeoPoint> &positions){
+    std::vector<ProximityPair> expected = allPairs(origin, trackIds, positions);
+    std::vector<ProximityPair> found;
+    grid.pairs(found);
+    sortPairs(expected);
+    sortPairs(found);
+    bool match = expected.size() == found.size();
+    for (size_t i=0; match && i<found.size(); i++) {
+        match = found[i].first == expected[i].first && found[i].second == expected[i].second
+             && std::fabs(found[i].range - expected[i].range) < 1e-9;
+    }
+    if (!match) {
+        std::fprintf(stderr, "%s: the grid found %zu pairs, all-pairs %zu\n", stage, found.size(), expected.size());
+        return false;
+    }
+
+    // Neighbours of every target are the other side of its pairs.
+    std::vector<size_t> neighborCounts(trackIds.size(), 0);
+    std::vector<int64_t> neighbors;
+    for (size_t i=0; i<trackIds.size(); i++) {
+        neighbors.clear();
+        grid.neighbors(trackIds[i], neighbors);
+        neighborCounts[i] = neighbors.size();
+    }
+    size_t total = 0;
+    for (size_t count : neighborCounts) {
+        total += count;
+    }
+    if (total != 2 * expected.size()) {
+        std::fprintf(stderr, "%s: %zu neighbours for %zu pairs\n", stage, total, expected.size());
+        return false;
+    }
+    return true;
+}
+
+static void snapshot(const TargetTable &targets, const PredictedTargets &predicted, std::vector<int64_t> &trackIds,
+                     std::vector<geodesy::GeoPoint> &positions){
+    trackIds.assign(targets.trackId(), targets.trackId() + targets.size());
+    positions.resize(targets.size());
+    for (size_t i=0; i<targets.size(); i++) {
+        positions[i] = geodesy::GeoPoint{predicted.latitude[i], predicted.longitude[i]};
+    }
+}
+
+static void move(ProximityGrid &grid, const TargetTable &targets, const PredictedTargets &predicted){
+    for (size_t i=0; i<targets.size(); i++) {
+        grid.update(targets.trackId()[i], geodesy::GeoPoint{predicted.latitude[i], predicted.longitude[i]});
+    }
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownship;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownship, traffic)) {
+        return 1;
+    }
+    geodesy::GeoPoint center{ownship.latitude[0], ownship.longitude[0]};
+
+    // The predictor moves targets for two minutes without going stale.
+    PredictorSettings settings;
+    settings.stalenessHorizon = 3600;
+    DeadReckoningPredictor predictor(settings);
+    PredictedTargets predicted;
+    std::vector<int64_t> trackIds;
+    std::vector<geodesy::GeoPoint> positions;
+
+    TargetTable targets;
+    fillTargets(center, traffic, 3000, targets);
+    ProximityGrid grid(center, kSeparation);
+    grid.update(targets);
+    predictor.predict(targets, 0, predicted);
+    snapshot(targets, predicted, trackIds, positions);
+    if (!pairsMatch("inserted", grid, center, trackIds, positions)) {
+        return 1;
+    }
+    for (int second=1; second<=120; second++) {
+        predictor.predict(targets, second, predicted);
+        move(grid, targets, predicted);
+    }
+    snapshot(targets, predicted, trackIds, positions);
+    if (!pairsMatch("moved", grid, center, trackIds, positions)) {
+        return 1;
+    }
+    for (int64_t trackId=0; trackId<3000; trackId+=7) {
+        grid.remove(trackId);
+        targets.remove(trackId);
+    }
+    predictor.predict(targets, 120, predicted);
+    snapshot(targets, predicted, trackIds, positions);
+    if (grid.size() != targets.size() || !pairsMatch("removed", grid, center, trackIds, positions)) {
+        return 1;
+    }
+
+    // Frames at 60 fps: move every target, then list the pairs.
+    const size_t sizes[] = {1000, 10000, 50000};
+    std::vector<ProximityPair> pairs;
+    for (size_t count : sizes) {
+        fillTargets(center, traffic, count, targets);
+        ProximityGrid timed(center, kSeparation);
+        timed.update(targets);
+        double moveTime = 0;
+        double pairTime = 0;
+        size_t pairCount = 0;
+        int frames = count >= 50000 ? 60 : 600;
+        for (int frame=0; frame<frames; frame++) {
+            predictor.predict(targets, frame / 60.0, predicted);
+            bench::Stopwatch moveTimer;
+            move(timed, targets, predicted);
+            moveTime += moveTimer.elapsed();
+            bench::Stopwatch pairTimer;
+            timed.pairs(pairs);
+            pairTime += pairTimer.elapsed();
+            pairCount += pairs.size();
+        }
+
+        // One all-pairs pass for comparison.
+        snapshot(targets, predicted, trackIds, positions);
+        bench::Stopwatch bruteTimer;
+        size_t bruteCount = allPairs(center, trackIds, positions).size();
+        double bruteTime = bruteTimer.elapsed();
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "grid.%zuk.pairs", count / 1000);
+        bench::report(name, (double)pairCount / frames, "pairs/frame");
+        std::snprintf(name, sizeof(name), "grid.%zuk.move", count / 1000);
+        bench::report(name, moveTime / frames * 1e6, "us/frame");
+        std::snprintf(name, sizeof(name), "grid.%zuk.pairQuery", count / 1000);
+        bench::report(name, pairTime / frames * 1e6, "us/frame");
+        std::snprintf(name, sizeof(name), "allPairs.%zuk", count / 1000);
+        bench::report(name, bruteTime * 1e6, "us/frame");
+        if (bruteCount != pairs.size()) {
+            std::fprintf(stderr, "%zu targets: the grid found %zu pairs, all-pairs %zu\n", count, pairs.size(), bruteCount);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,210 @@
+//
+//  replay_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 19/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks the replay scheduler and measures its frames and seeks.
+//  - A half-hour recording of 1000 targets at 1 Hz is built around the recorded traffic.
+//  - The same display timestamps and commands, jittered like a real display link, give identical
+//    frames on two schedulers.
+//  - Played through at 8x, the targets after every frame are exactly the latest sample of each at the
+//    frame's time. After each of 200 random seeks they are the latest sample of every target heard in
+//    the rebuild window.
+//  - Frame cost at 1x, 8x, 64x and 4096x, where the cap applies, with 60 fps timestamps, the samples
+//    each frame applied, and the cost of a seek.
+//
+//   replay_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/ReplayScheduler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+
+using namespace ironman;
+
+static const int64_t kTargets = 1000;
+static const int64_t kSeconds = 1800;
+
+static void buildRecording(const TrackColumns &traffic, TrackColumns &recording){
+    std::mt19937 random(19);
+    std::uniform_real_distribution<double> offset(-1.0, 1.0);
+    std::uniform_real_distribution<double> chance(0, 1);
+    recording.reserve((size_t)(kTargets * kSeconds));
+    for (int64_t second=0; second<kSeconds; second++) {
+        for (int64_t trackId=0; trackId<kTargets; trackId++) {
+            // Some reports are missed, so targets fall in and out of the rebuild window.
+            if (chance(random) < 0.1) {
+                continue;
+            }
+            TrackSample sample = traffic[(size_t)(trackId + second) % traffic.size()];
+            sample.trackId = trackId;
+            sample.timeOfApplicability = 1000000 + second;
+            sample.latitude += offset(random) * 0.01;
+            sample.longitude += offset(random) * 0.01;
+            recording.push_back(sample);
+        }
+    }
+}
+
+// The latest sample time of every target heard in [from, to].
+static std::unordered_map<int64_t, int64_t> latestSamples(const TrackColumns &recording, double from, double to){
+    std::unordered_map<int64_t, int64_t> latest;
+    for (size_t i=0; i<recording.size(); i++) {
+        double time = (double)recording.timeOfApplicability[i];
+        if (time >= from && time <= to) {
+            latest[recording.trackId[i]] = recording.timeOfApplicability[i];
+        }
+    }
+    return latest;
+}
+
+static bool matches(const TargetTable &targets, const std::unordered_map<int64_t, int64_t> &expected){
+    if (targets.size() != expected.size()) {
+        std::fprintf(stderr, "%zu targets, %zu expected\n", targets.size(), expected.size());
+        return false;
+    }
+    for (size_t row=0; row<targets.size(); row++) {
+        auto found = expected.find(targets.trackId()[row]);
+        if (found == expected.end() || (int64_t)targets.sampleTime()[row] != found->second) {
+            std::fprintf(stderr, "target %lld has the wrong sample\n", (long long)targets.trackId()[row]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// A minute of commands at 60 fps with a jittered display link: play, 8x, pause, seek, 64x.
+static std::vector<ReplayFrame> script(const TrackColumns &recording){
+    ReplayScheduler scheduler(recording);
+    std::mt19937 random(5);
+    std::uniform_real_distribution<double> jitter(-0.002, 0.002);
+    std::vector<ReplayFrame> frames;
+    double timestamp = 100;
+    scheduler.play(timestamp);
+    for (int frame=0; frame<3600; frame++) {
+        timestamp += 1.0 / 60 + jitter(random);
+        if (frame == 600) {
+            scheduler.setRate(8, timestamp);
+        }
+        else if (frame == 1200) {
+            scheduler.pause(timestamp);
+        }
+        else if (frame == 1500) {
+            scheduler.seek(scheduler.startTime() + 900, timestamp);
+            scheduler.play(timestamp);
+        }
+        else if (frame == 2400) {
+            scheduler.setRate(64, timestamp);
+        }
+        frames.push_back(scheduler.advance(timestamp));
+    }
+    return frames;
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownship;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownship, traffic)) {
+        return 1;
+    }
+    TrackColumns recording;
+    buildRecording(traffic, recording);
+    bench::report("recording.samples", (double)recording.size(), "samples");
+
+    std::vector<ReplayFrame> first = script(recording);
+    std::vector<ReplayFrame> second = script(recording);
+    for (size_t i=0; i<first.size(); i++) {
+        if (first[i].time != second[i].time || first[i].begin != second[i].begin || first[i].end != second[i].end
+            || first[i].rebuild != second[i].rebuild) {
+            std::fprintf(stderr, "frame %zu differs between identical runs\n", i);
+            return 1;
+        }
+    }
+
+    // 8x straight through, every frame checked.
+    ReplaySettings unlimited;
+    unlimited.maxSamplesPerFrame = recording.size();
+    ReplayScheduler scheduler(recording, unlimited);
+    TargetTable targets;
+    std::unordered_map<int64_t, int64_t> latest;
+    size_t cursor = 0;
+    double timestamp = 0;
+    scheduler.setRate(8, timestamp);
+    scheduler.play(timestamp);
+    int frames = 0;
+    while (!scheduler.finished()) {
+        timestamp += 1.0 / 60;
+        ReplayFrame frame = scheduler.advance(timestamp);
+        applyFrame(recording, frame, targets);
+        for (; cursor<recording.size() && (double)recording.timeOfApplicability[cursor] <= frame.time; cursor++) {
+            latest[recording.trackId[cursor]] = recording.timeOfApplicability[cursor];
+        }
+        if (!matches(targets, latest)) {
+            std::fprintf(stderr, "8x frame %d at %.3f\n", frames, frame.time);
+            return 1;
+        }
+        frames++;
+    }
+    bench::report("playthrough.8x.frames", frames, "frames matched");
+
+    // Random seeks, forwards and backwards.
+    std::mt19937 random(29);
+    std::uniform_real_distribution<double> anywhere(scheduler.startTime() - 60, scheduler.endTime() + 60);
+    double seekTime = 0;
+    for (int seek=0; seek<200; seek++) {
+        double time = anywhere(random);
+        timestamp += 1.0 / 60;
+        bench::Stopwatch timer;
+        scheduler.seek(time, timestamp);
+        ReplayFrame frame = scheduler.advance(timestamp);
+        seekTime += timer.elapsed();
+        applyFrame(recording, frame, targets);
+        if (!frame.rebuild || !matches(targets, latestSamples(recording, frame.time - unlimited.rebuildWindow, frame.time))) {
+            std::fprintf(stderr, "seek to %.3f\n", time);
+            return 1;
+        }
+    }
+    bench::report("seek", seekTime / 200 * 1e6, "us");
+
+    // Frame cost with the default cap.
+    const double rates[] = {1, 8, 64, 4096};
+    for (double rate : rates) {
+        ReplayScheduler timed(recording);
+        TargetTable timedTargets;
+        timestamp = 0;
+        timed.setRate(rate, timestamp);
+        timed.play(timestamp);
+        double total = 0;
+        double worst = 0;
+        size_t samples = 0;
+        size_t skipped = 0;
+        int count = 0;
+        while (!timed.finished() && count < 3600) {
+            timestamp += 1.0 / 60;
+            bench::Stopwatch timer;
+            ReplayFrame frame = timed.advance(timestamp);
+            applyFrame(recording, frame, timedTargets);
+            double elapsed = timer.elapsed();
+            total += elapsed;
+            worst = std::max(worst, elapsed);
+            samples += frame.end - frame.begin;
+            skipped += frame.skipped;
+            count++;
+        }
+        char name[64];
+        std::snprintf(name, sizeof(name), "frame.%.0fx.mean", rate);
+        bench::report(name, total / count * 1e6, "us");
+        std::snprintf(name, sizeof(name), "frame.%.0fx.worst", rate);
+        bench::report(name, worst * 1e6, "us");
+        std::snprintf(name, sizeof(name), "frame.%.0fx.samples", rate);
+        bench::report(name, (double)samples / count, "samples/frame");
+        std::snprintf(name, sizeof(name), "frame.%.0fx.skipped", rate);
+        bench::report(name, (double)skipped, "samples");
+    }
+    return 0;
+}
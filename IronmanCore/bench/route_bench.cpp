@@ -0,0 +1,235 @@
+//
+//  route_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 23/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks route tessellation and measures incremental retessellation against redoing the route.
+//  - Legs of every length and direction, across the antimeridian and over a pole: every point within
+//    1e-11 degrees of arc of the great circle kernels' pointBetween at its fraction, and no gap
+//    longer than the node spacing. Whole routes evenly spaced by point count: the first and last
+//    points are the route's ends, and every point is its fraction of the route's length along it.
+//  - A 60-waypoint planned route starting at the recorded ownship, with 5000 waypoint moves: after
+//    every move the polyline is exactly a fresh tessellation of the waypoints, at most two legs were
+//    retessellated, and a renderer copying only the changed range holds the same polyline. Moving a
+//    waypoint past the last, on an empty route or a full one, changes nothing.
+//  - Cost of a move against tessellating the whole route, and heap allocations once the polyline has
+//    grown to its longest.
+//
+//   route_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/RouteTessellator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace ironman;
+using geodesy::GeoPoint;
+
+static double degreesApart(double a, double b){
+    double difference = std::fmod(std::fabs(a - b), 360.0);
+    return std::min(difference, 360.0 - difference);
+}
+
+static bool samePoints(const GeoPoint *a, const GeoPoint *b, size_t count){
+    for (size_t i=0; i<count; i++) {
+        if (a[i].latitude != b[i].latitude || a[i].longitude != b[i].longitude) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool checkLegs(){
+    std::mt19937 random(47);
+    std::uniform_real_distribution<double> unit(-1, 1);
+    std::uniform_real_distribution<double> longitude(-180, 180);
+    std::uniform_real_distribution<double> spacing(0.5, 50);
+    std::vector<GeoPoint> from, to;
+    for (int i=0; i<2000; i++) {
+        from.push_back(GeoPoint{geodesy::toDegrees(std::asin(unit(random))), longitude(random)});
+        to.push_back(GeoPoint{geodesy::toDegrees(std::asin(unit(random))), longitude(random)});
+    }
+    from.push_back(GeoPoint{10, 179.5});
+    to.push_back(GeoPoint{12, -178});
+    from.push_back(GeoPoint{80, 0});
+    to.push_back(GeoPoint{80, 180});
+
+    double pointError = 0, worstGap = 0;
+    std::vector<GeoPoint> points;
+    for (size_t leg=0; leg<from.size(); leg++) {
+        // Nearly antipodal legs have no well defined great circle.
+        if (geodesy::nauticalMilesBetween(from[leg], to[leg]) > 179 * 60) {
+            continue;
+        }
+        double milesPerNode = spacing(random);
+        size_t count = geodesy::legNodeCount(from[leg], to[leg], milesPerNode);
+        points.resize(count);
+        geodesy::tessellateLeg(from[leg], to[leg], count, points.data());
+        for (size_t i=0; i<count; i++) {
+            GeoPoint expected = geodesy::pointBetween(from[leg], to[leg], (double)i / (double)(count - 1));
+            pointError = std::max(pointError, std::fabs(points[i].latitude - expected.latitude));
+            // Longitude error as arc, since it grows without bound towards the poles.
+            double cosLatitude = std::cos(geodesy::toRadians(expected.latitude));
+            pointError = std::max(pointError, degreesApart(points[i].longitude, expected.longitude) * cosLatitude);
+            if (i > 0) {
+                worstGap = std::max(worstGap, geodesy::nauticalMilesBetween(points[i - 1], points[i]) / milesPerNode);
+            }
+        }
+    }
+    bench::report("leg.point.error", pointError * 1e12, "deg x 1e-12");
+    bench::report("leg.gap", worstGap, "x spacing");
+    if (pointError > 1e-11 || worstGap > 1 + 1e-9) {
+        std::fprintf(stderr, "leg tessellation off the great circle\n");
+        return false;
+    }
+
+    // Evenly spaced along whole routes.
+    double alongError = 0;
+    for (int route=0; route<200; route++) {
+        size_t waypointCount = 2 + route % 10;
+        std::vector<GeoPoint> waypoints(from.begin() + route * 10, from.begin() + route * 10 + (ptrdiff_t)waypointCount);
+        std::vector<double> legEnds(1, 0.0);
+        for (size_t i=1; i<waypointCount; i++) {
+            legEnds.push_back(legEnds.back() + geodesy::nauticalMilesBetween(waypoints[i - 1], waypoints[i]));
+        }
+        size_t pointCount = 2 + (size_t)route * 5;
+        points.resize(pointCount);
+        geodesy::tessellateRoute(waypoints.data(), waypointCount, pointCount, points.data());
+        if (!samePoints(&points.front(), &waypoints.front(), 1) || !samePoints(&points.back(), &waypoints.back(), 1)) {
+            std::fprintf(stderr, "route %d does not start and end at its ends\n", route);
+            return false;
+        }
+        size_t leg = 1;
+        for (size_t i=0; i<pointCount; i++) {
+            double along = legEnds.back() * (double)i / (double)(pointCount - 1);
+            while (leg + 1 < waypointCount && along > legEnds[leg]) {
+                leg++;
+            }
+            double measured = legEnds[leg - 1] + geodesy::nauticalMilesBetween(waypoints[leg - 1], points[i]);
+            alongError = std::max(alongError, std::fabs(measured - along));
+        }
+    }
+    bench::report("route.along.error", alongError * 1e6, "nm x 1e-6");
+    if (alongError > 1e-6) {
+        std::fprintf(stderr, "route points not evenly spaced\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownship;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownship, traffic)) {
+        return 1;
+    }
+    if (!checkLegs()) {
+        return 1;
+    }
+
+    // A planned route wandering away from the ownship, 20 to 80 nm a leg.
+    std::mt19937 random(53);
+    std::uniform_real_distribution<double> turn(-60, 60);
+    std::uniform_real_distribution<double> length(20, 80);
+    std::uniform_real_distribution<double> nudge(0, 360);
+    std::uniform_real_distribution<double> distance(0, 10);
+    std::vector<GeoPoint> waypoints(1, GeoPoint{ownship.latitude[0], ownship.longitude[0]});
+    double course = ownship.trackAngle[0];
+    for (int i=1; i<60; i++) {
+        course += turn(random);
+        waypoints.push_back(geodesy::pointOnRadial(waypoints.back(), course, length(random)));
+    }
+
+    RouteTessellator tessellator;
+    tessellator.moveWaypoint(0, waypoints[0]);
+    if (tessellator.waypointCount() != 0 || tessellator.size() != 0 || tessellator.changedEnd() != 0) {
+        std::fprintf(stderr, "moving a waypoint of an empty route changed it\n");
+        return 1;
+    }
+    tessellator.setWaypoints(waypoints.data(), waypoints.size());
+    std::vector<GeoPoint> rendered(tessellator.points(), tessellator.points() + tessellator.size());
+    tessellator.clearChanges();
+    tessellator.moveWaypoint(waypoints.size(), waypoints[0]);
+    if (tessellator.size() != rendered.size() || tessellator.changedEnd() != 0
+        || !samePoints(tessellator.points(), rendered.data(), rendered.size())) {
+        std::fprintf(stderr, "moving a waypoint past the last changed the route\n");
+        return 1;
+    }
+    RouteTessellator fresh;
+    const int moves = 5000;
+    std::vector<GeoPoint> moved(moves);
+    std::vector<size_t> movedIndex(moves);
+    for (int move=0; move<moves; move++) {
+        movedIndex[move] = random() % waypoints.size();
+        moved[move] = geodesy::pointOnRadial(waypoints[movedIndex[move]], nudge(random), distance(random));
+    }
+
+    size_t shifted = 0;
+    for (int move=0; move<moves; move++) {
+        size_t legsBefore = tessellator.legsTessellated();
+        waypoints[movedIndex[move]] = moved[move];
+        tessellator.moveWaypoint(movedIndex[move], moved[move]);
+        fresh.setWaypoints(waypoints.data(), waypoints.size());
+        if (tessellator.legsTessellated() - legsBefore > 2 || tessellator.size() != fresh.size()
+            || !samePoints(tessellator.points(), fresh.points(), fresh.size())) {
+            std::fprintf(stderr, "move %d does not match a fresh tessellation\n", move);
+            return 1;
+        }
+        // The renderer's copy, patched over the changed range.
+        rendered.resize(tessellator.size());
+        std::copy(tessellator.points() + tessellator.changedBegin(), tessellator.points() + tessellator.changedEnd(),
+                  rendered.begin() + (ptrdiff_t)tessellator.changedBegin());
+        shifted += tessellator.changedEnd() == tessellator.size();
+        tessellator.clearChanges();
+        if (!samePoints(rendered.data(), tessellator.points(), rendered.size())) {
+            std::fprintf(stderr, "move %d changed points outside its range\n", move);
+            return 1;
+        }
+    }
+    bench::report("route.points", (double)tessellator.size(), "points");
+    bench::report("moves.checked", moves, "moves");
+    bench::report("moves.shifting", (double)shifted, "moves");
+
+    // Timing, on the route as the moves left it.
+    size_t allocationsBefore = bench::allocationCount();
+    bench::Stopwatch moveTimer;
+    for (int move=0; move<moves; move++) {
+        tessellator.moveWaypoint(movedIndex[move], moved[move]);
+    }
+    double moveTime = moveTimer.elapsed();
+    size_t moveAllocations = bench::allocationCount() - allocationsBefore;
+
+    std::vector<GeoPoint> buffer(tessellator.size() * 2);
+    const int redraws = 500;
+    bench::Stopwatch fullTimer;
+    for (int redraw=0; redraw<redraws; redraw++) {
+        fresh.setWaypoints(waypoints.data(), waypoints.size());
+    }
+    double fullTime = fullTimer.elapsed();
+
+    // MEMath's way: pointBetween: for every node of every leg.
+    bench::Stopwatch scalarTimer;
+    for (int redraw=0; redraw<redraws; redraw++) {
+        size_t written = 0;
+        for (size_t leg=0; leg+1<waypoints.size(); leg++) {
+            size_t count = geodesy::legNodeCount(waypoints[leg], waypoints[leg + 1], tessellator.settings().milesPerNode);
+            for (size_t i=0; i+1<count; i++) {
+                buffer[written++] = geodesy::pointBetween(waypoints[leg], waypoints[leg + 1], (double)i / (double)(count - 1));
+            }
+        }
+        buffer[written] = waypoints.back();
+    }
+    double scalarTime = scalarTimer.elapsed();
+
+    bench::report("move", moveTime / moves * 1e6, "us");
+    bench::report("move.allocations", (double)moveAllocations, "allocations");
+    bench::report("route.batch", fullTime / redraws * 1e6, "us");
+    bench::report("route.pointBetween", scalarTime / redraws * 1e6, "us");
+    return 0;
+}
@@ -0,0 +1,256 @@
+//
+//  smoother_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 15/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks the Kalman track smoother and measures its throughput.
+//  - A target flies straight, turns at standard rate and climbs, sampled at 1 Hz with 18 m of position
+//    noise and 25 ft of altitude noise. Speed and track errors of the online filters and the batch
+//    smoothers, constant velocity and constant turn, are compared with differencing raw positions.
+//  - The recorded TRAF rows: the largest second-to-second speed change, recorded against smoothed.
+//  - The online update is checked to make no heap allocation.
+//  - Samples per second for online filtering and batch smoothing.
+//
+//   smoother_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/Geodesy.hpp"
+#include "ironman/KalmanFilter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace ironman;
+
+struct Truth {
+    TrackColumns samples;
+    std::vector<double> speed;
+    std::vector<double> track;
+    // Samples inside the turn.
+    std::vector<bool> turning;
+};
+
+// 120 s straight at 300 knots on 045, a 90 degree standard rate turn to the right, 120 s straight;
+// climbing at 1500 ft/min throughout. Noise is added to what is recorded, not to the truth.
+static Truth makeTruth(geodesy::GeoPoint start, double positionNoise, double altitudeNoise, unsigned seed){
+    std::mt19937 random(seed);
+    std::normal_distribution<double> noise(0, 1);
+    Truth truth;
+    geodesy::GeoPoint position = start;
+    double heading = 45;
+    const double speed = 300;
+    for (int64_t time=0; time<=270; time++) {
+        double rate = time >= 120 && time < 150 ? 3.0 : 0.0;
+        double east = positionNoise * noise(random);
+        double north = positionNoise * noise(random);
+        TrackSample sample;
+        sample.timeOfApplicability = 1000 + time;
+        sample.latitude = position.latitude + north / 60.0;
+        sample.longitude = position.longitude + east / (60.0 * std::cos(geodesy::toRadians(position.latitude)));
+        sample.altitude = 8000 + 25.0 * time + altitudeNoise * noise(random);
+        sample.groundSpeed = NAN;
+        sample.trackAngle = NAN;
+        sample.verticalSpeed = NAN;
+        truth.samples.push_back(sample);
+        truth.speed.push_back(speed);
+        truth.track.push_back(heading);
+        truth.turning.push_back(rate != 0);
+
+        // Fly the next second along the arc, in small steps.
+        for (int step=0; step<10; step++) {
+            heading += rate / 20.0;
+            position = geodesy::pointOnRadial(position, heading, speed / 36000.0);
+            heading += rate / 20.0;
+        }
+    }
+    return truth;
+}
+
+static double angleError(double a, double b){
+    double difference = std::fmod(std::fabs(a - b), 360.0);
+    return difference > 180 ? 360 - difference : difference;
+}
+
+struct Errors {
+    double speed = 0;
+    double track = 0;
+    double turnTrack = 0;
+    double climb = 0;
+};
+
+// RMS errors after the first ten seconds, which every estimator needs to settle.
+static Errors errorsOf(const Truth &truth, const std::vector<TrackState> &states){
+    Errors errors;
+    size_t count = 0;
+    size_t turnCount = 0;
+    for (size_t i=10; i<states.size(); i++) {
+        errors.speed += std::pow(states[i].groundSpeed - truth.speed[i], 2);
+        errors.track += std::pow(angleError(states[i].trackAngle, truth.track[i]), 2);
+        errors.climb += std::pow(states[i].verticalSpeed - 1500, 2);
+        count++;
+        if (truth.turning[i]) {
+            errors.turnTrack += std::pow(angleError(states[i].trackAngle, truth.track[i]), 2);
+            turnCount++;
+        }
+    }
+    errors.speed = std::sqrt(errors.speed / count);
+    errors.track = std::sqrt(errors.track / count);
+    errors.climb = std::sqrt(errors.climb / count);
+    errors.turnTrack = std::sqrt(errors.turnTrack / turnCount);
+    return errors;
+}
+
+// Speed and track from each pair of consecutive raw positions.
+static std::vector<TrackState> differenced(const TrackColumns &track){
+    std::vector<TrackState> states(track.size());
+    for (size_t i=1; i<track.size(); i++) {
+        geodesy::GeoPoint from{track.latitude[i - 1], track.longitude[i - 1]};
+        geodesy::GeoPoint to{track.latitude[i], track.longitude[i]};
+        double dt = (double)(track.timeOfApplicability[i] - track.timeOfApplicability[i - 1]);
+        states[i] = TrackState{(double)track.timeOfApplicability[i], to.latitude, to.longitude, track.altitude[i],
+                               geodesy::nauticalMilesBetween(from, to) / dt * 3600.0, geodesy::courseDegrees(from, to),
+                               (track.altitude[i] - track.altitude[i - 1]) / dt * 60.0};
+    }
+    return states;
+}
+
+template <typename Model>
+static std::vector<TrackState> filtered(const TrackColumns &track){
+    TrackSmoother<Model> smoother;
+    std::vector<TrackState> states;
+    for (size_t i=0; i<track.size(); i++) {
+        states.push_back(smoother.update(track[i]));
+    }
+    return states;
+}
+
+template <typename Model>
+static std::vector<TrackState> smoothed(const TrackColumns &track){
+    TrackSmoother<Model> smoother;
+    std::vector<TrackState> states;
+    smoother.smooth(track, states);
+    return states;
+}
+
+static void reportErrors(const char *name, const Errors &errors){
+    char line[64];
+    std::snprintf(line, sizeof(line), "%s.speed", name);
+    bench::report(line, errors.speed, "kt rms");
+    std::snprintf(line, sizeof(line), "%s.track", name);
+    bench::report(line, errors.track, "deg rms");
+    std::snprintf(line, sizeof(line), "%s.trackInTurn", name);
+    bench::report(line, errors.turnTrack, "deg rms");
+    std::snprintf(line, sizeof(line), "%s.verticalSpeed", name);
+    bench::report(line, errors.climb, "ft/min rms");
+}
+
+static double largestSpeedStep(const std::vector<double> &speeds){
+    double largest = 0;
+    for (size_t i=1; i<speeds.size(); i++) {
+        if (std::isfinite(speeds[i]) && std::isfinite(speeds[i - 1])) {
+            largest = std::max(largest, std::fabs(speeds[i] - speeds[i - 1]));
+        }
+    }
+    return largest;
+}
+
+template <typename Model>
+static double onlineRate(const TrackColumns &track, size_t passes, double &checksum){
+    TrackSmoother<Model> smoother;
+    size_t samples = 0;
+    bench::Stopwatch timer;
+    for (size_t pass=0; pass<passes; pass++) {
+        smoother.reset();
+        for (size_t i=0; i<track.size(); i++, samples++) {
+            checksum += smoother.update(track[i]).groundSpeed;
+        }
+    }
+    return samples / timer.elapsed();
+}
+
+template <typename Model>
+static double batchRate(const TrackColumns &track, size_t passes, double &checksum){
+    TrackSmoother<Model> smoother;
+    std::vector<TrackState> states;
+    bench::Stopwatch timer;
+    for (size_t pass=0; pass<passes; pass++) {
+        smoother.smooth(track, states);
+        checksum += states[pass % states.size()].groundSpeed;
+    }
+    return passes * track.size() / timer.elapsed();
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownship;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownship, traffic)) {
+        return 1;
+    }
+    geodesy::GeoPoint start{traffic.latitude[0], traffic.longitude[0]};
+    SmootherSettings settings;
+    Truth truth = makeTruth(start, settings.positionNoise, settings.altitudeNoise, 5);
+
+    Errors raw = errorsOf(truth, differenced(truth.samples));
+    Errors velocityFiltered = errorsOf(truth, filtered<ConstantVelocityModel>(truth.samples));
+    Errors velocitySmoothed = errorsOf(truth, smoothed<ConstantVelocityModel>(truth.samples));
+    Errors turnFiltered = errorsOf(truth, filtered<ConstantTurnModel>(truth.samples));
+    Errors turnSmoothed = errorsOf(truth, smoothed<ConstantTurnModel>(truth.samples));
+    reportErrors("raw", raw);
+    reportErrors("cv.filtered", velocityFiltered);
+    reportErrors("cv.smoothed", velocitySmoothed);
+    reportErrors("ct.filtered", turnFiltered);
+    reportErrors("ct.smoothed", turnSmoothed);
+    if (!(velocityFiltered.speed < raw.speed && turnFiltered.speed < raw.speed && velocitySmoothed.speed < velocityFiltered.speed
+          && turnSmoothed.speed < turnFiltered.speed && velocitySmoothed.climb < raw.climb && turnSmoothed.turnTrack < velocitySmoothed.turnTrack)) {
+        std::fprintf(stderr, "the filters do not improve on raw positions as expected\n");
+        return 1;
+    }
+
+    // The recorded traffic, whose speed column jumps between seconds.
+    std::vector<TrackState> trafficStates = smoothed<ConstantTurnModel>(traffic);
+    std::vector<double> smoothedSpeeds;
+    for (const TrackState &state : trafficStates) {
+        smoothedSpeeds.push_back(state.groundSpeed);
+    }
+    bench::report("traf.largestSpeedStep.recorded", largestSpeedStep(traffic.groundSpeed), "kt");
+    bench::report("traf.largestSpeedStep.smoothed", largestSpeedStep(smoothedSpeeds), "kt");
+
+    // An hour of noisy flying for timing, each flight starting where the last ended, and proof the
+    // online update stays off the heap.
+    TrackColumns hour;
+    geodesy::GeoPoint legStart = start;
+    for (unsigned segment=0; segment<13; segment++) {
+        Truth part = makeTruth(legStart, settings.positionNoise, settings.altitudeNoise, 100 + segment);
+        legStart = geodesy::GeoPoint{part.samples.latitude.back(), part.samples.longitude.back()};
+        for (size_t i=0; i<part.samples.size(); i++) {
+            TrackSample sample = part.samples[i];
+            sample.timeOfApplicability += (int64_t)(segment * part.samples.size());
+            hour.push_back(sample);
+        }
+    }
+    TrackSmoother<ConstantTurnModel> online;
+    TrackSample first = hour[0];
+    online.update(first);
+    size_t allocationsBefore = bench::allocationCount();
+    double checksum = 0;
+    for (size_t i=1; i<hour.size(); i++) {
+        TrackSample sample = hour[i];
+        checksum += online.update(sample).groundSpeed;
+    }
+    bench::report("online.allocations", (double)(bench::allocationCount() - allocationsBefore), "allocations");
+    if (bench::allocationCount() != allocationsBefore) {
+        std::fprintf(stderr, "the online update allocated\n");
+        return 1;
+    }
+
+    bench::report("cv.online", onlineRate<ConstantVelocityModel>(hour, 300, checksum) / 1e6, "M samples/s");
+    bench::report("ct.online", onlineRate<ConstantTurnModel>(hour, 300, checksum) / 1e6, "M samples/s");
+    bench::report("cv.smooth", batchRate<ConstantVelocityModel>(hour, 300, checksum) / 1e6, "M samples/s");
+    bench::report("ct.smooth", batchRate<ConstantTurnModel>(hour, 300, checksum) / 1e6, "M samples/s");
+    std::printf("checksum %.6f\n", checksum);
+    return 0;
+}
@@ -0,0 +1,244 @@
+//
+//  tile_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 24/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks the web mercator and tile address kernels and measures them against the scalar formulas.
+//  - 1M points between the mercator limits: EPSG:3857 coordinates within 1e-6 m of the libm formula
+//    MEMath mercatorTo3857: uses, and back within 1e-12 degrees; the limit itself maps to pi R.
+//  - 200k points over the whole globe, polar caps included, at every level: the tile's bounds hold
+//    the point, its uid decodes to a valid address and encodes back to itself, it is the child of the
+//    point's tile a level up, and its region agrees with METileRegion's 80 degree bounds. Mercator
+//    tiles have the x and y of the slippy map formula METile initWithLevel:X:Y: follows, except for
+//    points within 1e-13 map widths of a tile's edge, which are counted.
+//  - Points per second for mercator coordinates and tile uids, batch against one point at a time.
+//
+//   tile_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/TileProjection.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace ironman;
+using tiles::TileAddress;
+using tiles::TileBounds;
+using tiles::TileRegion;
+
+static double referenceMercatorY(double latitude){
+    return tiles::kMercatorRadius * std::log(std::tan(geodesy::kPi / 4 + geodesy::toRadians(latitude) / 2));
+}
+
+static bool sameAddress(const TileAddress &a, const TileAddress &b){
+    return a.level == b.level && a.x == b.x && a.y == b.y && a.region == b.region && a.polar == b.polar;
+}
+
+static bool checkMercator(){
+    std::mt19937 random(59);
+    std::uniform_real_distribution<double> latitude(-tiles::kMercatorLimit, tiles::kMercatorLimit);
+    std::uniform_real_distribution<double> longitude(-180, 180);
+    const size_t count = 1000000;
+    std::vector<double> latitudes(count), longitudes(count), x(count), y(count), backLatitudes(count), backLongitudes(count);
+    for (size_t i=0; i<count; i++) {
+        latitudes[i] = latitude(random);
+        longitudes[i] = longitude(random);
+    }
+    latitudes[0] = tiles::kMercatorLimit;
+    latitudes[1] = -tiles::kMercatorLimit;
+    tiles::toMercator(latitudes.data(), longitudes.data(), x.data(), y.data(), count);
+    tiles::fromMercator(x.data(), y.data(), backLatitudes.data(), backLongitudes.data(), count);
+
+    double meters = 0, degrees = 0;
+    for (size_t i=0; i<count; i++) {
+        meters = std::max(meters, std::fabs(x[i] - tiles::kMercatorRadius * geodesy::toRadians(longitudes[i])));
+        meters = std::max(meters, std::fabs(y[i] - referenceMercatorY(latitudes[i])));
+        degrees = std::max(degrees, std::fabs(backLatitudes[i] - latitudes[i]));
+        degrees = std::max(degrees, std::fabs(backLongitudes[i] - longitudes[i]));
+    }
+    double edge = std::fabs(y[0] - geodesy::kPi * tiles::kMercatorRadius);
+    bench::report("mercator.error", meters * 1e9, "m x 1e-9");
+    bench::report("mercator.roundtrip", degrees * 1e12, "deg x 1e-12");
+    bench::report("mercator.edge", edge * 1e9, "m x 1e-9");
+    if (meters > 1e-6 || degrees > 1e-12 || edge > 1e-6 || y[1] != -y[0]) {
+        std::fprintf(stderr, "mercator off the reference\n");
+        return false;
+    }
+    return true;
+}
+
+// How far a fraction of the map is from the nearer edge of its tile, in map widths.
+static double edgeDistance(double fraction, double scale){
+    double position = fraction * scale;
+    return std::min(position - std::floor(position), std::ceil(position) - position) / scale;
+}
+
+static bool checkTiles(){
+    std::mt19937 random(61);
+    std::uniform_real_distribution<double> unit(-1, 1);
+    std::uniform_real_distribution<double> longitude(-180, 180);
+    std::uniform_real_distribution<double> cap(tiles::kMercatorLimit, 90);
+    const size_t count = 200000;
+    std::vector<double> latitudes(count), longitudes(count);
+    for (size_t i=0; i<count; i++) {
+        // One in ten in a polar cap, the rest uniform over the sphere.
+        latitudes[i] = i % 10 == 0 ? cap(random) * (unit(random) < 0 ? -1 : 1) : geodesy::toDegrees(std::asin(unit(random)));
+        longitudes[i] = longitude(random);
+    }
+    latitudes[0] = 90;
+    latitudes[1] = -90;
+    latitudes[2] = 0;
+    longitudes[2] = 0;
+
+    std::vector<uint64_t> uids(count), parents(count);
+    size_t edgeCases = 0, polarTiles = 0;
+    double outside = 0;
+    for (int level=0; level<=tiles::kMaxLevel; level++) {
+        double scale = std::ldexp(1.0, level);
+        tiles::tileUids(latitudes.data(), longitudes.data(), level, uids.data(), count);
+        for (size_t i=0; i<count; i++) {
+            TileAddress address = tiles::tileAddress(uids[i]);
+            if (!tiles::isValid(address) || tiles::tileUid(address) != uids[i] || address.level != level) {
+                std::fprintf(stderr, "level %d point %zu has an invalid uid\n", level, i);
+                return false;
+            }
+            if (!sameAddress(address, tiles::tileAt(geodesy::GeoPoint{latitudes[i], longitudes[i]}, level))) {
+                std::fprintf(stderr, "level %d point %zu differs from its scalar tile\n", level, i);
+                return false;
+            }
+            TileBounds bounds = tiles::tileBounds(address);
+            outside = std::max(outside, bounds.minLatitude - latitudes[i]);
+            outside = std::max(outside, latitudes[i] - bounds.maxLatitude);
+            outside = std::max(outside, bounds.minLongitude - longitudes[i]);
+            outside = std::max(outside, longitudes[i] - bounds.maxLongitude);
+
+            bool regionHolds = level == 0 ? address.region == TileRegion::Root
+                               : address.region == TileRegion::North ? bounds.minLatitude >= tiles::kRegionLimit
+                               : address.region == TileRegion::South ? bounds.maxLatitude <= -tiles::kRegionLimit
+                               : bounds.maxLatitude > -tiles::kRegionLimit && bounds.minLatitude < tiles::kRegionLimit;
+            if (!regionHolds || address.polar != (level > 0 && std::fabs(latitudes[i]) > tiles::kMercatorLimit)) {
+                std::fprintf(stderr, "level %d point %zu in the wrong region\n", level, i);
+                return false;
+            }
+            polarTiles += address.polar;
+
+            if (level > 0) {
+                TileAddress parent = tiles::tileAddress(parents[i]);
+                bool nested = parent.level == 0 || (parent.polar == address.polar && parent.x == address.x / 2 && parent.y == address.y / 2);
+                if (!nested) {
+                    std::fprintf(stderr, "level %d point %zu not inside its parent tile\n", level, i);
+                    return false;
+                }
+            }
+
+            // The slippy map formula, away from the poles and off the edges.
+            if (!address.polar && level > 0) {
+                double xFraction = (longitudes[i] + 180.0) / 360.0;
+                double yFraction = (1.0 - referenceMercatorY(latitudes[i]) / (geodesy::kPi * tiles::kMercatorRadius)) / 2;
+                if (edgeDistance(xFraction, scale) < 1e-13 || edgeDistance(yFraction, scale) < 1e-13) {
+                    edgeCases++;
+                }
+                else if (address.x != (int)std::floor(xFraction * scale) || address.y != (int)std::floor(yFraction * scale)) {
+                    std::fprintf(stderr, "level %d point %zu off the slippy map tile\n", level, i);
+                    return false;
+                }
+            }
+        }
+        parents.swap(uids);
+    }
+    bench::report("tiles.checked", (double)count * (tiles::kMaxLevel + 1), "tiles");
+    bench::report("tiles.polar", (double)polarTiles, "tiles");
+    bench::report("tiles.edge", (double)edgeCases, "tiles");
+    bench::report("tiles.outside", outside * 1e12, "deg x 1e-12");
+    if (outside > 1e-11) {
+        std::fprintf(stderr, "points outside their tiles\n");
+        return false;
+    }
+    return true;
+}
+
+// METile initWithLocation:level: then uid, one point at a time.
+static uint64_t scalarUid(double latitude, double longitude, int level){
+    double scale = std::ldexp(1.0, level);
+    double clamped = std::min(std::max(latitude, -tiles::kMercatorLimit), tiles::kMercatorLimit);
+    double yFraction = (1.0 - referenceMercatorY(clamped) / (geodesy::kPi * tiles::kMercatorRadius)) / 2;
+    TileAddress address;
+    address.level = level;
+    address.x = std::min((int)std::floor((longitude + 180.0) / 360.0 * scale), (1 << level) - 1);
+    address.y = std::min((int)std::floor(yFraction * scale), (1 << level) - 1);
+    address.region = TileRegion::Center;
+    address.polar = false;
+    return tiles::tileUid(address);
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownship;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownship, traffic)) {
+        return 1;
+    }
+    if (!checkMercator() || !checkTiles()) {
+        return 1;
+    }
+
+    // A frame's targets around the recorded ownship, at a street map level.
+    const size_t count = 100000;
+    const int level = 14;
+    std::mt19937 random(67);
+    std::uniform_real_distribution<double> offset(-3, 3);
+    std::vector<double> latitudes(count), longitudes(count), x(count), y(count);
+    std::vector<uint64_t> uids(count);
+    for (size_t i=0; i<count; i++) {
+        latitudes[i] = ownship.latitude[0] + offset(random);
+        longitudes[i] = ownship.longitude[0] + offset(random);
+    }
+
+    const int frames = 50;
+    bench::Stopwatch mercatorTimer;
+    for (int frame=0; frame<frames; frame++) {
+        tiles::toMercator(latitudes.data(), longitudes.data(), x.data(), y.data(), count);
+    }
+    double mercatorTime = mercatorTimer.elapsed();
+    bench::Stopwatch scalarMercatorTimer;
+    for (int frame=0; frame<frames; frame++) {
+        for (size_t i=0; i<count; i++) {
+            x[i] = tiles::kMercatorRadius * geodesy::toRadians(longitudes[i]);
+            y[i] = referenceMercatorY(latitudes[i]);
+        }
+    }
+    double scalarMercatorTime = scalarMercatorTimer.elapsed();
+
+    bench::Stopwatch uidTimer;
+    for (int frame=0; frame<frames; frame++) {
+        tiles::tileUids(latitudes.data(), longitudes.data(), level, uids.data(), count);
+    }
+    double uidTime = uidTimer.elapsed();
+    size_t differing = 0;
+    std::vector<uint64_t> scalarUids(count);
+    bench::Stopwatch scalarUidTimer;
+    for (int frame=0; frame<frames; frame++) {
+        for (size_t i=0; i<count; i++) {
+            scalarUids[i] = scalarUid(latitudes[i], longitudes[i], level);
+        }
+    }
+    double scalarUidTime = scalarUidTimer.elapsed();
+    for (size_t i=0; i<count; i++) {
+        TileAddress a = tiles::tileAddress(uids[i]);
+        TileAddress b = tiles::tileAddress(scalarUids[i]);
+        differing += a.x != b.x || a.y != b.y;
+    }
+
+    double points = (double)count * frames;
+    bench::report("ownship.latitude", ownship.latitude[0], "deg");
+    bench::report("mercator.batch", points / mercatorTime * 1e-6, "M points/s");
+    bench::report("mercator.scalar", points / scalarMercatorTime * 1e-6, "M points/s");
+    bench::report("uid.batch", points / uidTime * 1e-6, "M points/s");
+    bench::report("uid.scalar", points / scalarUidTime * 1e-6, "M points/s");
+    bench::report("uid.differing", (double)differing, "points");
+    return 0;
+}
@@ -0,0 +1,216 @@
+//
+//  trail_bench.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 16/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+// Checks the trail simplifier's error bound and measures how far it reduces an hour-long trail.
+//  - A target flies an hour at 4 Hz from the recorded ownship's position: straight legs, turns,
+//    climbs, descents and four laps of a holding pattern, with 5 m of position noise.
+//  - At every level, every sample is within the level's tolerance of where the simplified trail puts
+//    the target at that sample's time, horizontally and in altitude, and no two vertices are further
+//    apart than the maximum gap.
+//  - Vertices kept per level, against a batch top-down split at the same time-synchronized tolerance.
+//  - Samples per second appended, all levels included.
+//
+//   trail_bench [database]
+
+#include "BenchmarkSupport.hpp"
+#include "ironman/Geodesy.hpp"
+#include "ironman/TrailSimplifier.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace ironman;
+
+struct Leg {
+    double seconds;
+    // Degrees per second, clockwise.
+    double turnRate;
+    double knots;
+    double feetPerMinute;
+};
+
+static std::vector<TrailPoint> fly(geodesy::GeoPoint start, double altitude, unsigned seed){
+    static const Leg legs[] = {
+        {600, 0, 300, 0}, {30, 3, 300, 0}, {300, 0, 280, -1500}, {60, -3, 250, 0},
+        // Four laps of a one-minute holding pattern.
+        {60, 0, 200, 0}, {60, 3, 200, 0}, {60, 0, 200, 0}, {60, 3, 200, 0},
+        {60, 0, 200, 0}, {60, 3, 200, 0}, {60, 0, 200, 0}, {60, 3, 200, 0},
+        {60, 0, 200, 0}, {60, 3, 200, 0}, {60, 0, 200, 0}, {60, 3, 200, 0},
+        {60, 0, 200, 0}, {60, 3, 200, 0}, {60, 0, 200, 0}, {60, 3, 200, 0},
+        {400, 0, 250, 2000}, {45, -2, 280, 0}, {900, 0, 320, 0}, {20, 1.5, 320, 0}, {465, 0, 320, -500},
+    };
+    const double rate = 4;
+    std::mt19937 random(seed);
+    std::normal_distribution<double> noise(0, 5.0 / geodesy::kMetersPerNauticalMile);
+    std::vector<TrailPoint> trail;
+    geodesy::GeoPoint position = start;
+    double heading = 90;
+    double time = 0;
+    for (const Leg &leg : legs) {
+        for (int i=0; i<(int)(leg.seconds * rate); i++) {
+            TrailPoint point;
+            point.time = time;
+            point.latitude = position.latitude + noise(random) / 60.0;
+            point.longitude = position.longitude + noise(random) / (60.0 * std::cos(geodesy::toRadians(position.latitude)));
+            point.altitude = altitude;
+            trail.push_back(point);
+
+            heading += leg.turnRate / rate / 2;
+            position = geodesy::pointOnRadial(position, heading, leg.knots / 3600.0 / rate);
+            heading += leg.turnRate / rate / 2;
+            altitude += leg.feetPerMinute / 60.0 / rate;
+            time += 1.0 / rate;
+        }
+    }
+    return trail;
+}
+
+// Where the simplified trail puts the target at a time, interpolating linearly between vertices.
+static TrailPoint positionAt(const std::vector<TrailPoint> &trail, size_t segment, double time){
+    const TrailPoint &from = trail[segment];
+    const TrailPoint &to = trail[segment + 1];
+    double fraction = (time - from.time) / (to.time - from.time);
+    double deltaLongitude = to.longitude - from.longitude;
+    if (deltaLongitude > 180.0) {
+        deltaLongitude -= 360.0;
+    }
+    else if (deltaLongitude < -180.0) {
+        deltaLongitude += 360.0;
+    }
+    return TrailPoint{time, from.latitude + (to.latitude - from.latitude) * fraction, from.longitude + deltaLongitude * fraction,
+                      from.altitude + (to.altitude - from.altitude) * fraction};
+}
+
+// Largest horizontal and vertical time-synchronized error of samples against a simplified trail.
+static void errorsOf(const std::vector<TrailPoint> &samples, const std::vector<TrailPoint> &trail, double &horizontal, double &vertical){
+    horizontal = 0;
+    vertical = 0;
+    size_t segment = 0;
+    for (const TrailPoint &sample : samples) {
+        while (segment + 2 < trail.size() && trail[segment + 1].time <= sample.time) {
+            segment++;
+        }
+        TrailPoint expected = positionAt(trail, segment, sample.time);
+        horizontal = std::max(horizontal, geodesy::nauticalMilesBetween(geodesy::GeoPoint{sample.latitude, sample.longitude},
+                                                                        geodesy::GeoPoint{expected.latitude, expected.longitude}));
+        vertical = std::max(vertical, std::fabs(sample.altitude - expected.altitude));
+    }
+}
+
+static double largestGap(const std::vector<TrailPoint> &trail){
+    double largest = 0;
+    for (size_t i=1; i<trail.size(); i++) {
+        largest = std::max(largest, trail[i].time - trail[i - 1].time);
+    }
+    return largest;
+}
+
+// Batch reference: split each span at the sample furthest from its time-synchronized position until
+// every sample is within tolerance.
+static void splitTopDown(const std::vector<TrailPoint> &samples, size_t first, size_t last, double tolerance,
+                         double altitudeTolerance, std::vector<bool> &kept){
+    if (last <= first + 1) {
+        return;
+    }
+    std::vector<TrailPoint> span{samples[first], samples[last]};
+    size_t worst = first;
+    double worstRatio = 1;
+    for (size_t i=first+1; i<last; i++) {
+        TrailPoint expected = positionAt(span, 0, samples[i].time);
+        double horizontal = geodesy::nauticalMilesBetween(geodesy::GeoPoint{samples[i].latitude, samples[i].longitude},
+                                                          geodesy::GeoPoint{expected.latitude, expected.longitude});
+        double ratio = std::max(horizontal / tolerance, std::fabs(samples[i].altitude - expected.altitude) / altitudeTolerance);
+        if (ratio > worstRatio) {
+            worstRatio = ratio;
+            worst = i;
+        }
+    }
+    if (worst != first) {
+        kept[worst] = true;
+        splitTopDown(samples, first, worst, tolerance, altitudeTolerance, kept);
+        splitTopDown(samples, worst, last, tolerance, altitudeTolerance, kept);
+    }
+}
+
+static size_t topDownCount(const std::vector<TrailPoint> &samples, double tolerance, double altitudeTolerance){
+    std::vector<bool> kept(samples.size(), false);
+    kept.front() = true;
+    kept.back() = true;
+    splitTopDown(samples, 0, samples.size() - 1, tolerance, altitudeTolerance, kept);
+    return (size_t)std::count(kept.begin(), kept.end(), true);
+}
+
+int main(int argc, char **argv){
+    TrackColumns ownship;
+    TrackColumns traffic;
+    if (!bench::loadRecording(bench::databasePath(argc, argv), ownship, traffic)) {
+        return 1;
+    }
+    geodesy::GeoPoint start{ownship.latitude[0], ownship.longitude[0]};
+    std::vector<TrailPoint> samples = fly(start, 9000, 3);
+
+    TrailSimplifier simplifier;
+    for (const TrailPoint &sample : samples) {
+        simplifier.append(sample);
+    }
+    bench::report("samples", (double)simplifier.sampleCount(), "samples");
+
+    std::vector<TrailPoint> trail;
+    for (int level=0; level<simplifier.levelCount(); level+=2) {
+        simplifier.vertices(level, trail);
+        double horizontal;
+        double vertical;
+        errorsOf(samples, trail, horizontal, vertical);
+        double tolerance = simplifier.tolerance(level);
+        double altitudeTolerance = std::ldexp(simplifier.settings().altitudeTolerance, level);
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "level%d.%.3fnm.vertices", level, tolerance);
+        bench::report(name, (double)trail.size(), "vertices");
+        std::snprintf(name, sizeof(name), "level%d.%.3fnm.topDown", level, tolerance);
+        bench::report(name, (double)topDownCount(samples, tolerance, altitudeTolerance), "vertices");
+        std::snprintf(name, sizeof(name), "level%d.%.3fnm.maxError", level, tolerance);
+        bench::report(name, horizontal / tolerance, "of tolerance");
+        if (horizontal > tolerance * (1 + 1e-6) || vertical > altitudeTolerance * (1 + 1e-6)) {
+            std::fprintf(stderr, "level %d: error %.4f nm / %.1f ft exceeds %.4f nm / %.1f ft\n", level, horizontal, vertical,
+                         tolerance, altitudeTolerance);
+            return 1;
+        }
+        if (largestGap(trail) > simplifier.settings().maxVertexGap) {
+            std::fprintf(stderr, "level %d: vertices %.0f s apart\n", level, largestGap(trail));
+            return 1;
+        }
+    }
+
+    // The recorded ownship, at the finest level.
+    TrailSimplifier recorded;
+    for (size_t i=0; i<ownship.size(); i++) {
+        recorded.append(ownship[i]);
+    }
+    recorded.vertices(0, trail);
+    bench::report("own.samples", (double)recorded.sampleCount(), "samples");
+    bench::report("own.vertices", (double)trail.size(), "vertices");
+
+    // Appending, with every level kept.
+    const int trails = 100;
+    bench::Stopwatch timer;
+    size_t vertexTotal = 0;
+    for (int i=0; i<trails; i++) {
+        simplifier.clear();
+        for (const TrailPoint &sample : samples) {
+            simplifier.append(sample);
+        }
+        vertexTotal += simplifier.vertexCount(0);
+    }
+    double elapsed = timer.elapsed();
+    bench::report("append", trails * samples.size() / elapsed / 1e6, "M samples/s");
+    bench::report("append.perSample", elapsed / (trails * samples.size()) * 1e9, "ns");
+    std::printf("checksum %zu\n", vertexTotal);
+    return 0;
+}
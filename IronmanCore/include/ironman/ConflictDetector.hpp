@@ -0,0 +1,106 @@
+//
+//  ConflictDetector.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 13/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_CONFLICT_DETECTOR_HPP
+#define IRONMAN_CONFLICT_DETECTOR_HPP
+
+#include "ironman/TargetTable.hpp"
+#include "ironman/TrackInterpolator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ironman {
+
+enum class AlertLevel : uint8_t {
+    None = 0,
+    TrafficAdvisory = 1,
+    ResolutionAdvisory = 2
+};
+
+// TCAS II (version 7.1) sensitivity level thresholds: tau in seconds, DMOD in nautical miles and
+// ZTHR in feet. Sensitivity level 2 issues no resolution advisories, so its RA thresholds are zero.
+struct AlertThresholds {
+    int sensitivityLevel;
+    double trafficTau;
+    double trafficDmod;
+    double trafficZthr;
+    double resolutionTau;
+    double resolutionDmod;
+    double resolutionZthr;
+};
+
+// Thresholds for the ownship altitude in feet. The recording has no radio altitude, so the
+// low-altitude levels that TCAS selects by height above ground are selected by pressure altitude.
+AlertThresholds alertThresholdsForAltitude(double altitude);
+
+// Closest point of approach of one intruder, one row per TargetTable row.
+struct ConflictColumns {
+    // Seconds from the ownship time; 0 once the intruder is opening.
+    std::vector<double> timeToClosestApproach;
+    // Horizontal miss distance in nautical miles.
+    std::vector<double> closestApproachRange;
+    // Intruder altitude above ownship at closest approach, in feet.
+    std::vector<double> closestApproachAltitude;
+    std::vector<AlertLevel> level;
+
+    size_t size() const { return level.size(); }
+};
+
+struct AlertTransition {
+    int64_t trackId;
+    AlertLevel from;
+    AlertLevel to;
+    // At the time of the transition; NaN when the target left the table.
+    double timeToClosestApproach;
+    double closestApproachRange;
+};
+
+// Closest point of approach and TCAS-style alerting between the ownship and every target in a
+// TargetTable. Targets are dead-reckoned to the ownship time and both aircraft fly straight: the
+// geometry is in a flat east/north frame around the ownship, which is accurate over the few miles
+// that alerting cares about.
+//
+// An intruder is a traffic advisory when it is inside DMOD, or closing with a modified tau below
+// the TA tau, while also inside ZTHR vertically or converging to co-altitude within the same tau.
+// A resolution advisory applies the tighter RA thresholds. The kernel has no branches and runs as
+// one loop over the table that the compiler vectorizes.
+//
+// A target is extrapolated for at most stalenessHorizon seconds, as DeadReckoningPredictor holds it;
+// one whose sample is older than that is reported at its held position but never alerts.
+//
+// update reports only the targets whose alert level changed since the previous update, including
+// targets removed from the table while alerting.
+class ConflictDetector {
+public:
+    explicit ConflictDetector(double stalenessHorizon = 10.0);
+
+    double stalenessHorizon() const { return _stalenessHorizon; }
+    void update(const TrackState &ownship, const TargetTable &targets, ConflictColumns &conflicts,
+                std::vector<AlertTransition> &transitions);
+
+    // Targets currently at TrafficAdvisory or above.
+    size_t alertCount() const { return _alerts.size(); }
+
+private:
+    struct Alert {
+        int64_t trackId;
+        AlertLevel level;
+    };
+
+    double _stalenessHorizon;
+    // Kernel output before it is narrowed to AlertLevel.
+    std::vector<double> _levels;
+    // Sorted by trackId.
+    std::vector<Alert> _alerts;
+    std::vector<Alert> _nextAlerts;
+};
+
+} // namespace ironman
+
+#endif // IRONMAN_CONFLICT_DETECTOR_HPP
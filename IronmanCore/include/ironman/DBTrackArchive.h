@@ -0,0 +1,103 @@
+//
+//  DBTrackArchive.h
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 04/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef DBTrackArchive_h
+#define DBTrackArchive_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Read-only, memory-mapped archive of a finished recording (.trk).
+//
+// Layout, all little-endian and every array 64-byte aligned:
+//   DBTrackArchiveHeader
+//   DBTrackArchiveSection[sectionCount]      one per table, TRAF then OWN
+//   per section: int64 time[rowCount]        sorted ascending, unique
+//                double column[6][rowCount]  in DBTrackArchiveColumn order
+//                int64 index[indexCount]     time of every DBTrackArchiveIndexStride-th row
+//
+// Opening only maps the file and checks the header, so it costs the same for any recording, and the
+// pages are shared with every other process mapping the same archive. Columns are handed out as
+// pointers straight into the mapping.
+
+#define DBTrackArchiveMagic "IMTRK\0\0\0"
+#define DBTrackArchiveVersion 1u
+#define DBTrackArchiveAlignment 64u
+#define DBTrackArchiveIndexStride 256u
+
+// Tables an archive holds.
+typedef enum {
+    DBTrackArchiveTableTraffic,
+    DBTrackArchiveTableOwnship,
+    DBTrackArchiveTableCount
+} DBTrackArchiveTable;
+
+// Value columns, in the same order as DBTrackSample whatever order the source table stores them in.
+// Position 1/2 are latitude/longitude in degrees, velocity 1 is ground speed in knots, velocity 2 is
+// track angle in degrees and vertical speed is in ft/min.
+typedef enum {
+    DBTrackArchiveColumnLatitude,
+    DBTrackArchiveColumnLongitude,
+    DBTrackArchiveColumnAltitude,
+    DBTrackArchiveColumnHorizontalVelocity1,
+    DBTrackArchiveColumnHorizontalVelocity2,
+    DBTrackArchiveColumnVerticalSpeed,
+    DBTrackArchiveColumnCount
+} DBTrackArchiveColumn;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t fileSize;
+} DBTrackArchiveHeader;
+
+// Offsets are from the start of the file.
+typedef struct {
+    uint64_t rowCount;
+    uint64_t timeOffset;
+    uint64_t columnOffsets[DBTrackArchiveColumnCount];
+    uint64_t indexOffset;
+    uint64_t indexCount;
+} DBTrackArchiveSection;
+
+// A run of consecutive rows of one table. Every pointer has count entries.
+typedef struct {
+    const int64_t *timeOfApplicability;
+    const double *columns[DBTrackArchiveColumnCount];
+    size_t count;
+} DBTrackArchiveSpan;
+
+typedef struct DBTrackArchive DBTrackArchive;
+
+// Maps an archive. Returns NULL if the file is missing, truncated or not an archive of this version.
+DBTrackArchive *DBTrackArchiveOpen(const char *archivePath);
+void DBTrackArchiveClose(DBTrackArchive *archive);
+
+// Every row of a table. The span stays valid until the archive is closed.
+DBTrackArchiveSpan DBTrackArchiveGetTable(const DBTrackArchive *archive, DBTrackArchiveTable table);
+
+// The rows of a table with startTime <= time <= endTime, found through the time index.
+DBTrackArchiveSpan DBTrackArchiveGetTimeRange(const DBTrackArchive *archive, DBTrackArchiveTable table, int64_t startTime, int64_t endTime);
+
+// Index of the first row of span with a time >= time, or span.count if there is none.
+size_t DBTrackArchiveSpanLowerBound(DBTrackArchiveSpan span, int64_t time);
+
+// Converts a TRAF/OWN recording into an archive. The archive is written next to archivePath and renamed
+// into place, so readers never see a partial file. Returns 0 on success.
+int DBTrackArchiveWriteFromDatabase(const char *databasePath, const char *archivePath);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DBTrackArchive_h */
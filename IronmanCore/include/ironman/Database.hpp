@@ -0,0 +1,78 @@
+//
+//  Database.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 08/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_DATABASE_HPP
+#define IRONMAN_DATABASE_HPP
+
+#include <sqlite3.h>
+#include <cstdint>
+#include <string>
+
+namespace ironman {
+
+// One SQLite connection. Like DBManager, failures are logged and reported through return values
+// rather than thrown.
+class Database {
+public:
+    Database() = default;
+    ~Database();
+    Database(const Database &) = delete;
+    Database &operator=(const Database &) = delete;
+    Database(Database &&other) noexcept;
+    Database &operator=(Database &&other) noexcept;
+
+    // Accepts a path, or a file: URI when flags include SQLITE_OPEN_URI.
+    bool open(const std::string &path, int flags = SQLITE_OPEN_READONLY);
+    void close();
+    bool isOpen() const { return _database != nullptr; }
+    sqlite3 *handle() const { return _database; }
+
+    // Runs one or more statements that return no rows.
+    bool execute(const char *sql);
+    const char *errorMessage() const;
+
+private:
+    sqlite3 *_database = nullptr;
+};
+
+// A compiled statement. It is reset and reused for every execution, so the SQL is only compiled once.
+class Statement {
+public:
+    Statement() = default;
+    Statement(Database &database, const char *sql);
+    ~Statement();
+    Statement(const Statement &) = delete;
+    Statement &operator=(const Statement &) = delete;
+    Statement(Statement &&other) noexcept;
+    Statement &operator=(Statement &&other) noexcept;
+
+    bool isValid() const { return _statement != nullptr; }
+    sqlite3_stmt *handle() const { return _statement; }
+
+    // Parameters are numbered from 1, as in sqlite3_bind_*.
+    bool bind(int index, int64_t value);
+    bool bind(int index, double value);
+
+    // Returns true while there is a row to read. An error is logged, ends the loop and sets failed().
+    bool step();
+    bool failed() const { return _failed; }
+    void reset();
+
+    int columnCount() const;
+    int64_t int64Column(int column) const;
+    // SQL NULL reads as NAN.
+    double doubleColumn(int column) const;
+
+private:
+    sqlite3_stmt *_statement = nullptr;
+    bool _failed = false;
+};
+
+} // namespace ironman
+
+#endif // IRONMAN_DATABASE_HPP
@@ -0,0 +1,64 @@
+//
+//  DeadReckoning.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 12/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_DEAD_RECKONING_HPP
+#define IRONMAN_DEAD_RECKONING_HPP
+
+#include "ironman/TargetTable.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ironman {
+
+enum class TargetStatus : uint8_t {
+    // The last sample is recent enough to be on time.
+    Current = 0,
+    // Updates were missed; the position is extrapolated from the last sample.
+    Coasting = 1,
+    // Past the staleness horizon; the position is held where the extrapolation stopped.
+    Stale = 2
+};
+
+struct PredictorSettings {
+    // Seconds without an update before a target counts as coasting. TRAF arrives at 1 Hz.
+    double coastAfter = 1.5;
+    // Seconds a target is extrapolated before it is held and reported stale.
+    double stalenessHorizon = 10.0;
+};
+
+// Predicted positions, one row per TargetTable row.
+struct PredictedTargets {
+    std::vector<double> latitude;
+    std::vector<double> longitude;
+    std::vector<double> altitude;
+    std::vector<TargetStatus> status;
+
+    size_t size() const { return latitude.size(); }
+};
+
+// Extrapolates every target from its last sample along its recorded velocity and vertical speed.
+// Each step is a flat-earth rhumb line: over a horizon of seconds its error against the great circle
+// is well below a metre, and it needs no trigonometry, so predict is straight loops over the table
+// that the compiler vectorizes. The output arrays only grow, so a steady frame loop never allocates.
+class DeadReckoningPredictor {
+public:
+    explicit DeadReckoningPredictor(PredictorSettings settings = PredictorSettings()) : _settings(settings) {}
+
+    const PredictorSettings &settings() const { return _settings; }
+    void setSettings(PredictorSettings settings) { _settings = settings; }
+
+    void predict(const TargetTable &targets, double time, PredictedTargets &predicted) const;
+
+private:
+    PredictorSettings _settings;
+};
+
+} // namespace ironman
+
+#endif // IRONMAN_DEAD_RECKONING_HPP
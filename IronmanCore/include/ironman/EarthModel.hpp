@@ -0,0 +1,79 @@
+//
+//  EarthModel.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 22/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_EARTH_MODEL_HPP
+#define IRONMAN_EARTH_MODEL_HPP
+
+#include "ironman/Geodesy.hpp"
+#include "ironman/GeodesyBatch.hpp"
+#include <cstddef>
+
+namespace ironman {
+namespace geodesy {
+
+// Earth models for code templated on one, so the choice is made at compile time and a hot loop calls
+// the model's kernels directly. Both models have the same static API, in the same units as the
+// great circle kernels:
+//   double nauticalMilesBetween(GeoPoint point1, GeoPoint point2);
+//   double courseDegrees(GeoPoint point1, GeoPoint point2);
+//   void inverse(GeoPoint point1, GeoPoint point2, double &distance, double &course);
+//   GeoPoint pointOnRadial(GeoPoint point, double radialDegrees, double distanceNauticalMiles);
+//   void rangesAndCourses(GeoPoint origin, const double *latitudes, const double *longitudes,
+//                         double *ranges, double *courses, size_t count);
+
+// MEMath's sphere, one minute of arc per nautical mile: the great circle kernels. Fast, and right
+// for drawing, but its distances are off the ellipsoid's by up to about 0.5%: long along meridians
+// near the equator and short near the poles.
+struct Spherical {
+    static double nauticalMilesBetween(GeoPoint point1, GeoPoint point2){
+        return geodesy::nauticalMilesBetween(point1, point2);
+    }
+    static double courseDegrees(GeoPoint point1, GeoPoint point2){
+        return geodesy::courseDegrees(point1, point2);
+    }
+    static void inverse(GeoPoint point1, GeoPoint point2, double &distance, double &course){
+        distance = geodesy::nauticalMilesBetween(point1, point2);
+        course = geodesy::courseDegrees(point1, point2);
+    }
+    static GeoPoint pointOnRadial(GeoPoint point, double radialDegrees, double distanceNauticalMiles){
+        return geodesy::pointOnRadial(point, radialDegrees, distanceNauticalMiles);
+    }
+    static void rangesAndCourses(GeoPoint origin, const double *latitudes, const double *longitudes, double *ranges,
+                                 double *courses, size_t count){
+        geodesy::rangesAndCourses(origin, latitudes, longitudes, ranges, courses, count);
+    }
+};
+
+// Geodesics on the WGS84 ellipsoid by Vincenty's formulae, within a millimetre of Karney's exact
+// solution. The inverse iterates to convergence, a handful of iterations at radar ranges; within
+// about a degree of the antipode it may stop at its iteration limit instead, kilometres out. Scalar
+// only, at two to three times the spherical scalar cost and six times its array kernel.
+struct WGS84 {
+    static constexpr double kSemiMajorAxis = 6378137.0;
+    static constexpr double kFlattening = 1 / 298.257223563;
+
+    static double nauticalMilesBetween(GeoPoint point1, GeoPoint point2){
+        double distance, course;
+        inverse(point1, point2, distance, course);
+        return distance;
+    }
+    static double courseDegrees(GeoPoint point1, GeoPoint point2){
+        double distance, course;
+        inverse(point1, point2, distance, course);
+        return course;
+    }
+    static void inverse(GeoPoint point1, GeoPoint point2, double &distance, double &course);
+    static GeoPoint pointOnRadial(GeoPoint point, double radialDegrees, double distanceNauticalMiles);
+    static void rangesAndCourses(GeoPoint origin, const double *latitudes, const double *longitudes, double *ranges,
+                                 double *courses, size_t count);
+};
+
+} // namespace geodesy
+} // namespace ironman
+
+#endif // IRONMAN_EARTH_MODEL_HPP
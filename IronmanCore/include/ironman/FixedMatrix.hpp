@@ -0,0 +1,152 @@
+//
+//  FixedMatrix.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 15/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_FIXED_MATRIX_HPP
+#define IRONMAN_FIXED_MATRIX_HPP
+
+#include <cmath>
+
+namespace ironman {
+
+// A dense matrix whose size is fixed at compile time. It lives wherever it is declared, never on the
+// heap, and every loop has constant bounds the compiler can unroll.
+template <int Rows, int Columns>
+struct Matrix {
+    double m[Rows][Columns];
+
+    double &operator()(int row, int column) { return m[row][column]; }
+    double operator()(int row, int column) const { return m[row][column]; }
+
+    static Matrix zero(){
+        Matrix result;
+        for (int i=0; i<Rows; i++) {
+            for (int j=0; j<Columns; j++) {
+                result.m[i][j] = 0;
+            }
+        }
+        return result;
+    }
+
+    static Matrix identity(){
+        Matrix result = zero();
+        for (int i=0; i<Rows && i<Columns; i++) {
+            result.m[i][i] = 1;
+        }
+        return result;
+    }
+
+    Matrix<Columns, Rows> transpose() const{
+        Matrix<Columns, Rows> result;
+        for (int i=0; i<Rows; i++) {
+            for (int j=0; j<Columns; j++) {
+                result.m[j][i] = m[i][j];
+            }
+        }
+        return result;
+    }
+};
+
+template <int Rows>
+using Vector = Matrix<Rows, 1>;
+
+template <int Rows, int Columns>
+Matrix<Rows, Columns> operator+(const Matrix<Rows, Columns> &a, const Matrix<Rows, Columns> &b){
+    Matrix<Rows, Columns> result;
+    for (int i=0; i<Rows; i++) {
+        for (int j=0; j<Columns; j++) {
+            result.m[i][j] = a.m[i][j] + b.m[i][j];
+        }
+    }
+    return result;
+}
+
+template <int Rows, int Columns>
+Matrix<Rows, Columns> operator-(const Matrix<Rows, Columns> &a, const Matrix<Rows, Columns> &b){
+    Matrix<Rows, Columns> result;
+    for (int i=0; i<Rows; i++) {
+        for (int j=0; j<Columns; j++) {
+            result.m[i][j] = a.m[i][j] - b.m[i][j];
+        }
+    }
+    return result;
+}
+
+template <int Rows, int Inner, int Columns>
+Matrix<Rows, Columns> operator*(const Matrix<Rows, Inner> &a, const Matrix<Inner, Columns> &b){
+    Matrix<Rows, Columns> result;
+    for (int i=0; i<Rows; i++) {
+        for (int j=0; j<Columns; j++) {
+            double sum = 0;
+            for (int k=0; k<Inner; k++) {
+                sum += a.m[i][k] * b.m[k][j];
+            }
+            result.m[i][j] = sum;
+        }
+    }
+    return result;
+}
+
+// Averages a matrix with its transpose, removing the asymmetry rounding leaves in a covariance.
+template <int Size>
+Matrix<Size, Size> symmetrize(const Matrix<Size, Size> &a){
+    Matrix<Size, Size> result;
+    for (int i=0; i<Size; i++) {
+        for (int j=0; j<Size; j++) {
+            result.m[i][j] = 0.5 * (a.m[i][j] + a.m[j][i]);
+        }
+    }
+    return result;
+}
+
+// Solves a * x = b in place of b for a symmetric positive definite a, by Cholesky factorization.
+// Returns false, leaving b unspecified, if a is not positive definite.
+template <int Size, int Columns>
+bool choleskySolve(const Matrix<Size, Size> &a, Matrix<Size, Columns> &b){
+    // a = l * l^T, lower triangle only.
+    Matrix<Size, Size> l;
+    for (int j=0; j<Size; j++) {
+        double diagonal = a.m[j][j];
+        for (int k=0; k<j; k++) {
+            diagonal -= l.m[j][k] * l.m[j][k];
+        }
+        if (!(diagonal > 0)) {
+            return false;
+        }
+        l.m[j][j] = std::sqrt(diagonal);
+        for (int i=j+1; i<Size; i++) {
+            double sum = a.m[i][j];
+            for (int k=0; k<j; k++) {
+                sum -= l.m[i][k] * l.m[j][k];
+            }
+            l.m[i][j] = sum / l.m[j][j];
+        }
+    }
+
+    // Forward substitution through l, then back substitution through l^T.
+    for (int c=0; c<Columns; c++) {
+        for (int i=0; i<Size; i++) {
+            double sum = b.m[i][c];
+            for (int k=0; k<i; k++) {
+                sum -= l.m[i][k] * b.m[k][c];
+            }
+            b.m[i][c] = sum / l.m[i][i];
+        }
+        for (int i=Size-1; i>=0; i--) {
+            double sum = b.m[i][c];
+            for (int k=i+1; k<Size; k++) {
+                sum -= l.m[k][i] * b.m[k][c];
+            }
+            b.m[i][c] = sum / l.m[i][i];
+        }
+    }
+    return true;
+}
+
+} // namespace ironman
+
+#endif // IRONMAN_FIXED_MATRIX_HPP
@@ -0,0 +1,47 @@
+//
+//  Geodesy.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 08/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_GEODESY_HPP
+#define IRONMAN_GEODESY_HPP
+
+namespace ironman {
+
+// Great circle kernels on a spherical earth, the same model and units as MEMath: positions in degrees,
+// courses in degrees true and distances in nautical miles, one minute of arc per nautical mile.
+namespace geodesy {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kNauticalMilesPerRadian = 180.0 * 60.0 / kPi;
+constexpr double kMetersPerNauticalMile = 1852.0;
+constexpr double kFeetPerNauticalMile = kMetersPerNauticalMile / 0.3048;
+
+struct GeoPoint {
+    double latitude;
+    double longitude;
+};
+
+constexpr double toRadians(double degrees){ return degrees * (kPi / 180.0); }
+constexpr double toDegrees(double radians){ return radians * (180.0 / kPi); }
+
+// Central angle between two points (haversine).
+double distanceRadians(GeoPoint point1, GeoPoint point2);
+double nauticalMilesBetween(GeoPoint point1, GeoPoint point2);
+
+// Initial course from point1 to point2, in [0, 360).
+double courseDegrees(GeoPoint point1, GeoPoint point2);
+
+// The point distance nautical miles from point along the great circle leaving on radial.
+GeoPoint pointOnRadial(GeoPoint point, double radialDegrees, double distanceNauticalMiles);
+
+// The point a fraction of the way along the great circle from point1 to point2.
+GeoPoint pointBetween(GeoPoint point1, GeoPoint point2, double fraction);
+
+} // namespace geodesy
+} // namespace ironman
+
+#endif // IRONMAN_GEODESY_HPP
@@ -0,0 +1,174 @@
+//
+//  KalmanFilter.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 15/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_KALMAN_FILTER_HPP
+#define IRONMAN_KALMAN_FILTER_HPP
+
+#include "ironman/FixedMatrix.hpp"
+#include "ironman/Geodesy.hpp"
+#include "ironman/TrackColumns.hpp"
+#include "ironman/TrackInterpolator.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace ironman {
+
+struct SmootherSettings {
+    // One sigma error of a recorded position, nautical miles.
+    double positionNoise = 0.01;
+    // One sigma error of a recorded altitude, feet.
+    double altitudeNoise = 25;
+    // Unmodelled horizontal acceleration, nautical miles/s^2 per root second.
+    double accelerationNoise = 5e-4;
+    // Unmodelled change of turn rate, degrees/s per root second. Constant turn only.
+    double turnRateNoise = 0.2;
+    // Unmodelled vertical acceleration, feet/s^2 per root second.
+    double climbAccelerationNoise = 3;
+};
+
+// Motion models. A model's first kMeasurements states are the ones measured, in the same units; the
+// transition returns the predicted state and writes its Jacobian. Horizontal states are in nautical
+// miles and seconds in the smoother's east/north frame.
+
+// East, north, east velocity, north velocity.
+struct ConstantVelocityModel {
+    static const int kStates = 4;
+    static const int kMeasurements = 2;
+
+    explicit ConstantVelocityModel(const SmootherSettings &settings);
+    Vector<kStates> transition(const Vector<kStates> &state, double dt, Matrix<kStates, kStates> &jacobian) const;
+    Matrix<kStates, kStates> processNoise(double dt) const;
+    // Covariance after the first measurement, which leaves the velocity unknown.
+    Matrix<kStates, kStates> initialCovariance(double measurementVariance) const;
+
+    double accelerationVariance;
+};
+
+// East, north, east velocity, north velocity and turn rate in radians per second, counterclockwise.
+// The velocity rotates at the turn rate, so a standard rate turn is followed without lag.
+struct ConstantTurnModel {
+    static const int kStates = 5;
+    static const int kMeasurements = 2;
+
+    explicit ConstantTurnModel(const SmootherSettings &settings);
+    Vector<kStates> transition(const Vector<kStates> &state, double dt, Matrix<kStates, kStates> &jacobian) const;
+    Matrix<kStates, kStates> processNoise(double dt) const;
+    Matrix<kStates, kStates> initialCovariance(double measurementVariance) const;
+
+    double accelerationVariance;
+    double turnRateVariance;
+};
+
+// Altitude in feet and climb rate in feet per second.
+struct AltitudeModel {
+    static const int kStates = 2;
+    static const int kMeasurements = 1;
+
+    explicit AltitudeModel(const SmootherSettings &settings);
+    Vector<kStates> transition(const Vector<kStates> &state, double dt, Matrix<kStates, kStates> &jacobian) const;
+    Matrix<kStates, kStates> processNoise(double dt) const;
+    Matrix<kStates, kStates> initialCovariance(double measurementVariance) const;
+
+    double accelerationVariance;
+};
+
+// An extended Kalman filter over one model. Every matrix is fixed-size, so neither update nor predict
+// touches the heap.
+template <typename Model>
+class KalmanFilter {
+public:
+    static const int kStates = Model::kStates;
+    static const int kMeasurements = Model::kMeasurements;
+    typedef Vector<kStates> State;
+    typedef Matrix<kStates, kStates> Covariance;
+    typedef Vector<kMeasurements> Measurement;
+
+    // A filtered state, kept by the batch smoother for its backward pass.
+    struct Step {
+        State state;
+        Covariance covariance;
+    };
+
+    KalmanFilter(const Model &model, double measurementNoise);
+
+    bool initialized() const { return _initialized; }
+    void reset() { _initialized = false; }
+
+    // Moves the state to time without a measurement.
+    void predict(double time);
+    // Predicts to time and corrects with the measurement; the first measurement starts the filter.
+    void update(double time, const Measurement &measurement);
+
+    const Model &model() const { return _model; }
+    double time() const { return _time; }
+    const State &state() const { return _state; }
+    const Covariance &covariance() const { return _covariance; }
+    Step step() const { return Step{_state, _covariance}; }
+
+    // Rauch-Tung-Striebel backward pass: replaces the filtered steps at times with smoothed ones,
+    // each conditioned on every measurement.
+    static void smooth(const Model &model, const double *times, Step *steps, size_t count);
+
+private:
+    Model _model;
+    double _measurementVariance;
+    bool _initialized = false;
+    double _time = 0;
+    State _state;
+    Covariance _covariance;
+};
+
+// Filters or smooths one target's samples from their positions and altitudes. Positions are taken into
+// an east/north frame in nautical miles anchored at the first sample (equirectangular, with the east
+// velocity rescaled to the true latitude on the way out); altitude has a filter of its own.
+//
+// The recorded velocity columns are not used: in the bundled TRAF they disagree with the recorded
+// positions by tens of knots from one second to the next. Speed, track and vertical speed are the
+// filter's estimates.
+//
+// HorizontalModel is ConstantVelocityModel or ConstantTurnModel.
+template <typename HorizontalModel>
+class TrackSmoother {
+public:
+    explicit TrackSmoother(const SmootherSettings &settings = SmootherSettings());
+
+    // Online: the filtered state at the sample's time, using it and every sample before it. A sample
+    // with a NULL position or altitude only advances that part of the filter.
+    TrackState update(const TrackSample &sample);
+    void reset();
+
+    // Batch: forward filter and backward smoothing pass over one target's samples in time order.
+    // smoothed gets one state per sample. Scratch space is kept between calls.
+    void smooth(const TrackColumns &track, std::vector<TrackState> &smoothed);
+
+private:
+    void anchor(const TrackSample &sample);
+    void measure(const TrackSample &sample);
+    TrackState stateAt(double time, const typename KalmanFilter<HorizontalModel>::State &horizontal,
+                       const typename KalmanFilter<AltitudeModel>::State &vertical) const;
+
+    KalmanFilter<HorizontalModel> _horizontal;
+    KalmanFilter<AltitudeModel> _vertical;
+    bool _anchored = false;
+    geodesy::GeoPoint _origin;
+    double _milesPerDegreeEast = 60;
+
+    std::vector<double> _times;
+    std::vector<typename KalmanFilter<HorizontalModel>::Step> _horizontalSteps;
+    std::vector<typename KalmanFilter<AltitudeModel>::Step> _verticalSteps;
+};
+
+extern template class KalmanFilter<ConstantVelocityModel>;
+extern template class KalmanFilter<ConstantTurnModel>;
+extern template class KalmanFilter<AltitudeModel>;
+extern template class TrackSmoother<ConstantVelocityModel>;
+extern template class TrackSmoother<ConstantTurnModel>;
+
+} // namespace ironman
+
+#endif // IRONMAN_KALMAN_FILTER_HPP
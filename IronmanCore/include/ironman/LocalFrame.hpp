@@ -0,0 +1,92 @@
+//
+//  LocalFrame.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 21/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_LOCAL_FRAME_HPP
+#define IRONMAN_LOCAL_FRAME_HPP
+
+#include "ironman/Geodesy.hpp"
+#include "ironman/TargetTable.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace ironman {
+
+struct LocalFrameSettings {
+    // Nautical miles the ownship may move from the anchor before update re-anchors the frame on it.
+    double reanchorDistance = 2.0;
+};
+
+// Positions in a LocalFrame, one row per TargetTable row.
+struct LocalPositions {
+    // Nautical miles.
+    std::vector<double> east;
+    std::vector<double> north;
+    // Feet above the anchor's tangent plane.
+    std::vector<double> up;
+
+    size_t size() const { return east.size(); }
+};
+
+// An east/north/up frame on the tangent plane at an anchor near the ownship, so relative geometry
+// (range, closure, CPA, declutter) is flat vector arithmetic instead of spherical trigonometry.
+//
+// East and north are the target's ground position projected onto the plane, on MEMath's sea-level
+// sphere, so they do not depend on altitude; up is the target's height above the plane, and so
+// includes the earth's curvature, about 8800 ft at 100 nm. Altitude separation should come from the
+// altitudes. Against the great circle kernels, for a target d nautical miles from the anchor:
+//  - atan2(east, north) is the initial course from the anchor exactly.
+//  - hypot(east, north) is R sin(d / R) for the earth radius R, short of d by about d^3 / (6 R^2):
+//    0.0002 nm at 25 nm, 0.0018 nm at 50 nm, 0.014 nm at 100 nm, 0.11 nm at 200 nm and 0.22 nm at
+//    250 nm. Between two targets d from the anchor, the plane shortens the radial part of their
+//    separation by the factor cos(d / R), 0.04% at 100 nm and 0.26% at 250 nm.
+//  - Transforming to the frame and back agrees within 1e-11 degrees and 1e-6 ft.
+// The plane only reaches the near hemisphere: toGeodetic is defined for hypot(east, north) below the
+// earth radius, 3438 nm. A point at or beyond it is put on the horizon, 90 degrees from the anchor,
+// with a finite but meaningless altitude.
+// The anchor moves only when the ownship has moved past reanchorDistance from it, so a frame's
+// positions stay valid across frames until update reports that it re-anchored.
+//
+// The array transforms use branch-free trigonometry and vectorize; inputs and outputs are contiguous
+// columns that must not overlap.
+class LocalFrame {
+public:
+    explicit LocalFrame(LocalFrameSettings settings = LocalFrameSettings()) : _settings(settings) {}
+
+    const LocalFrameSettings &settings() const { return _settings; }
+    bool anchored() const { return _anchored; }
+    geodesy::GeoPoint origin() const { return _origin; }
+    double originAltitude() const { return _originAltitude; }
+
+    // Anchors the frame at a position, altitude in feet.
+    void anchor(geodesy::GeoPoint origin, double altitude);
+    // Re-anchors on the ownship if the frame has no anchor or the ownship is past reanchorDistance from
+    // it. Returns true when it did, so positions already in the frame must be transformed again.
+    bool update(geodesy::GeoPoint ownship, double altitude);
+
+    void toLocal(geodesy::GeoPoint position, double altitude, double &east, double &north, double &up) const;
+    void toGeodetic(double east, double north, double up, geodesy::GeoPoint &position, double &altitude) const;
+
+    void toLocal(const double *latitudes, const double *longitudes, const double *altitudes, double *east,
+                 double *north, double *up, size_t count) const;
+    void toGeodetic(const double *east, const double *north, const double *up, double *latitudes,
+                    double *longitudes, double *altitudes, size_t count) const;
+    // Every row of the table at its last sampled position. The columns only grow.
+    void toLocal(const TargetTable &targets, LocalPositions &positions) const;
+
+private:
+    LocalFrameSettings _settings;
+    bool _anchored = false;
+    geodesy::GeoPoint _origin = {0, 0};
+    double _originAltitude = 0;
+    double _sinLatitude = 0;
+    double _cosLatitude = 1;
+};
+
+} // namespace ironman
+
+#endif // IRONMAN_LOCAL_FRAME_HPP
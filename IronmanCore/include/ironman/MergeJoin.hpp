@@ -0,0 +1,75 @@
+//
+//  MergeJoin.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 10/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_MERGE_JOIN_HPP
+#define IRONMAN_MERGE_JOIN_HPP
+
+#include "ironman/TrackColumns.hpp"
+#include "ironman/TrackSource.hpp"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace ironman {
+
+// One target as seen from ownship at a tick.
+struct RelativeGeometry {
+    int64_t trackId;
+    // Time of the target sample that was matched to the tick.
+    int64_t sampleTime;
+    // Nautical miles.
+    double range;
+    // Degrees true from ownship to the target.
+    double bearing;
+    // Feet, target minus ownship.
+    double relativeAltitude;
+    // Knots, positive while the range is shrinking.
+    double closureRate;
+};
+
+// Relates ownship and traffic recorded on different time bases. Every ownship sample is a tick; each
+// target is matched to its sample nearest the tick within tolerance seconds (the earlier one on a
+// tie), moved along its recorded velocity to the tick time, and measured against ownship.
+//
+// Both sources are walked once, in time order. Only the traffic samples within tolerance of the
+// current tick are held, so the join costs O(n + m) time and memory proportional to the number of
+// targets, however long the recording is. Ownship times must not decrease.
+class MergeJoin {
+public:
+    MergeJoin(TrackSource &ownship, TrackSource &traffic, int64_t toleranceSeconds = 1);
+
+    // Advances to the next ownship sample. Returns false once ownship is exhausted.
+    bool next();
+    const TrackSample &ownship() const { return _ownshipSample; }
+    // Targets matched at the current tick, by track id.
+    const std::vector<RelativeGeometry> &targets() const { return _targets; }
+
+private:
+    void readTraffic(int64_t untilTime);
+
+    TrackSource &_ownship;
+    TrackSource &_traffic;
+    int64_t _tolerance;
+    TrackSample _ownshipSample;
+
+    // The next traffic sample, read but beyond the current window.
+    TrackSample _pendingTraffic;
+    bool _hasPendingTraffic = false;
+    bool _trafficExhausted = false;
+
+    // Per target, the samples within tolerance of the current tick in time order.
+    std::map<int64_t, std::vector<TrackSample>> _windows;
+    std::vector<RelativeGeometry> _targets;
+};
+
+// The geometry of target, aligned to time, as seen from ownship.
+RelativeGeometry relativeGeometry(const TrackSample &ownship, const TrackSample &target, int64_t time);
+
+} // namespace ironman
+
+#endif // IRONMAN_MERGE_JOIN_HPP
@@ -0,0 +1,93 @@
+//
+//  ProximityGrid.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 14/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_PROXIMITY_GRID_HPP
+#define IRONMAN_PROXIMITY_GRID_HPP
+
+#include "ironman/Geodesy.hpp"
+#include "ironman/TargetTable.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ironman {
+
+// Two targets within the separation of each other, first < second.
+struct ProximityPair {
+    int64_t first;
+    int64_t second;
+    // Nautical miles.
+    double range;
+};
+
+// Finds targets within a fixed horizontal separation of each other without comparing every pair.
+// Positions are projected into an east/north frame in nautical miles around a fixed origin and hashed
+// into square cells one separation wide, so every neighbour of a target is in its own cell or one of
+// the eight around it. The frame is equirectangular: ranges are exact at the origin's latitude and
+// drift by about 1.5% per degree of latitude away from it at mid latitudes.
+//
+// Targets are updated in place. Moving within a cell only rewrites the position, and moving across
+// one edits the two cells involved. Neighbour queries cost O(k) for k nearby targets. A pair query is
+// O(n + p) for n targets and p pairs, against O(n^2) for comparing all pairs.
+class ProximityGrid {
+public:
+    // separation in nautical miles, at least 0.01.
+    ProximityGrid(geodesy::GeoPoint origin, double separation);
+
+    double separation() const { return _separation; }
+    size_t size() const { return _locations.size(); }
+
+    // Inserts the target or moves it.
+    void update(int64_t trackId, geodesy::GeoPoint position);
+    // Updates every row of the table at its last sampled position.
+    void update(const TargetTable &targets);
+    // Returns false if the target is not in the grid.
+    bool remove(int64_t trackId);
+    void clear();
+
+    // Targets within the separation of the target, other than itself, appended to found.
+    void neighbors(int64_t trackId, std::vector<int64_t> &found) const;
+    // Targets within the separation of a position, appended to found.
+    void neighbors(geodesy::GeoPoint position, std::vector<int64_t> &found) const;
+    // Every pair of targets within the separation, each once, replacing the contents of found.
+    void pairs(std::vector<ProximityPair> &found) const;
+
+private:
+    struct Member {
+        int64_t trackId;
+        double east;
+        double north;
+    };
+    typedef std::vector<Member> Cell;
+
+    // Where a target is stored. Cells are map nodes, so the pointer survives rehashing.
+    struct Location {
+        uint64_t key;
+        Cell *cell;
+        size_t slot;
+    };
+
+    void project(geodesy::GeoPoint position, double &east, double &north) const;
+    uint64_t cellOf(double east, double north) const;
+    void neighbors(double east, double north, int64_t exclude, std::vector<int64_t> &found) const;
+    void detach(const Location &location);
+
+    geodesy::GeoPoint _origin;
+    double _milesPerDegreeEast;
+    double _separation;
+    double _separation2;
+    // Members are stored in their cells so queries read them contiguously. A cell is dropped when its
+    // last target leaves.
+    std::unordered_map<uint64_t, Cell> _cells;
+    std::unordered_map<int64_t, Location> _locations;
+};
+
+} // namespace ironman
+
+#endif // IRONMAN_PROXIMITY_GRID_HPP
@@ -0,0 +1,113 @@
+//
+//  ReplayScheduler.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 19/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_REPLAY_SCHEDULER_HPP
+#define IRONMAN_REPLAY_SCHEDULER_HPP
+
+#include "ironman/TargetTable.hpp"
+#include "ironman/TrackColumns.hpp"
+#include <cstddef>
+
+namespace ironman {
+
+// Maps display timestamps to simulation time. Simulation time runs at rate times the display clock
+// while playing and stands still while paused. It only ever reads the timestamps it is given, never a
+// system clock, so the same timestamps and commands always give the same simulation times.
+class ReplayClock {
+public:
+    explicit ReplayClock(double time = 0) : _anchorTime(time) {}
+
+    // Simulation time at a display timestamp, which must not be earlier than the last command's.
+    double time(double timestamp) const { return _playing ? _anchorTime + (timestamp - _anchorTimestamp) * _rate : _anchorTime; }
+    bool playing() const { return _playing; }
+    double rate() const { return _rate; }
+
+    void play(double timestamp);
+    void pause(double timestamp);
+    // Any non-negative multiple of real time; 0 holds the clock without pausing it.
+    void setRate(double rate, double timestamp);
+    void seek(double time, double timestamp);
+
+private:
+    // Simulation time at the last command and the display timestamp it was given at.
+    double _anchorTime;
+    double _anchorTimestamp = 0;
+    double _rate = 1;
+    bool _playing = false;
+};
+
+struct ReplaySettings {
+    // Most samples one frame applies. Beyond it, the frame applies only the latest ones, so the work per
+    // frame stays bounded however fast the replay runs.
+    size_t maxSamplesPerFrame = 20000;
+    // After a seek, samples this many seconds before the new time are replayed to rebuild the targets;
+    // anything older would be stale. PredictorSettings::stalenessHorizon.
+    double rebuildWindow = 10;
+};
+
+// The samples one frame brings in, indices into the recording.
+struct ReplayFrame {
+    // Simulation time of the frame.
+    double time;
+    size_t begin;
+    size_t end;
+    // The replay jumped: clear the targets before applying the samples.
+    bool rebuild;
+    // Samples passed over to stay within maxSamplesPerFrame. Targets they would have moved keep their
+    // older samples until their next one.
+    size_t skipped;
+};
+
+// Replays a recording into the display loop. Each frame is the span of samples between the previous
+// frame's simulation time and this one's, so a frame's updates are applied in one pass over contiguous
+// rows whatever the rate. Seeking is two binary searches over the time column, O(log n), with at most
+// the rebuild window replayed after it.
+class ReplayScheduler {
+public:
+    // recording is in time order, targets interleaved, and must outlive the scheduler.
+    explicit ReplayScheduler(const TrackColumns &recording, const ReplaySettings &settings = ReplaySettings());
+
+    const ReplaySettings &settings() const { return _settings; }
+    const ReplayClock &clock() const { return _clock; }
+    double startTime() const { return _startTime; }
+    double endTime() const { return _endTime; }
+    // The last frame's simulation time.
+    double time() const { return _time; }
+    // Whether the replay has reached the end of the recording, which pauses it.
+    bool finished() const { return _cursor == _recording.size() && !_clock.playing(); }
+
+    void play(double timestamp) { _clock.play(timestamp); }
+    void pause(double timestamp) { _clock.pause(timestamp); }
+    void setRate(double rate, double timestamp) { _clock.setRate(rate, timestamp); }
+    // Moves to a simulation time, clamped to the recording; the next frame rebuilds the targets.
+    void seek(double time, double timestamp);
+
+    // The frame for a display timestamp, normally a CADisplayLink's. A timestamp earlier than the last
+    // command's holds the replay at the last frame's time rather than rewinding it.
+    ReplayFrame advance(double timestamp);
+
+private:
+    size_t firstAfter(double time, size_t from) const;
+
+    const TrackColumns &_recording;
+    ReplaySettings _settings;
+    ReplayClock _clock;
+    double _startTime;
+    double _endTime;
+    double _time;
+    // Samples before the cursor have been applied.
+    size_t _cursor = 0;
+    bool _seeked = true;
+};
+
+// Applies a frame's samples to a table of targets, clearing it first if the frame rebuilds.
+void applyFrame(const TrackColumns &recording, const ReplayFrame &frame, TargetTable &targets);
+
+} // namespace ironman
+
+#endif // IRONMAN_REPLAY_SCHEDULER_HPP
@@ -0,0 +1,94 @@
+//
+//  RouteTessellator.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 23/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_ROUTE_TESSELLATOR_HPP
+#define IRONMAN_ROUTE_TESSELLATOR_HPP
+
+#include "ironman/Geodesy.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace ironman {
+
+// Great circle tessellation into caller buffers, in place of MEMath's tesselateRoute: calls that box
+// every point into an NSArray. Points are evenly spaced along each great circle, the same points as
+// MEMath pointBetween:, computed with branch-free trigonometry so the loop vectorizes. A leg between
+// antipodal points has no single great circle and is not supported.
+namespace geodesy {
+
+// Nodes a leg needs so no two are more than milesPerNode apart, both ends included, at least 2 and at
+// most INT_MAX, the most tessellateLeg takes. A non-positive or NaN spacing gives 2.
+size_t legNodeCount(GeoPoint from, GeoPoint to, double milesPerNode);
+// nodeCount points from from to to inclusive, at least 2 (MEMath tesselateRoute:point2:nodeCount:).
+void tessellateLeg(GeoPoint from, GeoPoint to, size_t nodeCount, GeoPoint *points);
+// pointCount points evenly spaced along a whole route of waypointCount waypoints, the first and last
+// waypoints included (MEMath tesselateRoute:pointCount:).
+void tessellateRoute(const GeoPoint *waypoints, size_t waypointCount, size_t pointCount, GeoPoint *points);
+
+} // namespace geodesy
+
+struct TessellationSettings {
+    // Longest gap between neighbouring points, nautical miles, at least 0.01.
+    double milesPerNode = 2.0;
+    // Points per leg at most, whatever its length, at least 2.
+    size_t maxNodesPerLeg = 2000;
+};
+
+// A route kept tessellated for drawing every frame: a planned route, or a predicted path. The points
+// are one contiguous polyline, each leg in order with the waypoints between legs once, and each leg's
+// points are kept until one of its ends changes. Moving a waypoint retessellates only the two legs
+// either side of it; if their point counts are unchanged, the points after them stay where they are.
+//
+// changedBegin and changedEnd bound the points rewritten since the last clearChanges, so a renderer
+// holding a copy of the polyline updates only that range.
+class RouteTessellator {
+public:
+    explicit RouteTessellator(TessellationSettings settings = TessellationSettings());
+
+    const TessellationSettings &settings() const { return _settings; }
+
+    void setWaypoints(const geodesy::GeoPoint *waypoints, size_t count);
+    // Ignored for an index past the last waypoint.
+    void moveWaypoint(size_t index, geodesy::GeoPoint position);
+    void clear();
+
+    size_t waypointCount() const { return _waypoints.size(); }
+    const geodesy::GeoPoint *waypoints() const { return _waypoints.data(); }
+
+    size_t size() const { return _points.size(); }
+    const geodesy::GeoPoint *points() const { return _points.data(); }
+    // The first point of a leg; leg waypointCount() - 1 is the last point.
+    size_t legStart(size_t leg) const { return _legStarts[leg]; }
+    // Copies up to capacity points to a caller buffer and returns how many it copied.
+    size_t copyPoints(geodesy::GeoPoint *points, size_t capacity) const;
+
+    // Empty when changedBegin() == changedEnd().
+    size_t changedBegin() const { return _changedBegin; }
+    size_t changedEnd() const { return _changedEnd; }
+    void clearChanges();
+
+    // Legs tessellated since construction, for measuring.
+    size_t legsTessellated() const { return _legsTessellated; }
+
+private:
+    size_t nodeCount(size_t leg) const;
+    void markChanged(size_t begin, size_t end);
+
+    TessellationSettings _settings;
+    std::vector<geodesy::GeoPoint> _waypoints;
+    std::vector<geodesy::GeoPoint> _points;
+    // One per waypoint: each leg's first point, and the last point for the last waypoint.
+    std::vector<size_t> _legStarts;
+    size_t _changedBegin = 0;
+    size_t _changedEnd = 0;
+    size_t _legsTessellated = 0;
+};
+
+} // namespace ironman
+
+#endif // IRONMAN_ROUTE_TESSELLATOR_HPP
@@ -0,0 +1,66 @@
+//
+//  TargetTable.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 12/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_TARGET_TABLE_HPP
+#define IRONMAN_TARGET_TABLE_HPP
+
+#include "ironman/TrackColumns.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ironman {
+
+// The latest sample of every live target, one contiguous array per field so per-frame kernels run as
+// straight loops over all targets. Velocities are also kept as east/north components in knots,
+// together with 1/cos(latitude), so kernels can step positions without any trigonometry.
+// Rows are dense: removing a target moves the last row into its place.
+class TargetTable {
+public:
+    size_t size() const { return _trackId.size(); }
+    bool empty() const { return _trackId.empty(); }
+
+    // Inserts the target or replaces its previous sample. Returns its row.
+    size_t update(const TrackSample &sample);
+    // Returns false if the target is not in the table.
+    bool remove(int64_t trackId);
+    void clear();
+    // Row of the target, or size() if it is not in the table.
+    size_t rowOf(int64_t trackId) const;
+
+    const int64_t *trackId() const { return _trackId.data(); }
+    const double *sampleTime() const { return _sampleTime.data(); }
+    const double *latitude() const { return _latitude.data(); }
+    const double *longitude() const { return _longitude.data(); }
+    const double *altitude() const { return _altitude.data(); }
+    const double *groundSpeed() const { return _groundSpeed.data(); }
+    const double *trackAngle() const { return _trackAngle.data(); }
+    const double *verticalSpeed() const { return _verticalSpeed.data(); }
+    const double *eastVelocity() const { return _eastVelocity.data(); }
+    const double *northVelocity() const { return _northVelocity.data(); }
+    const double *inverseCosLatitude() const { return _inverseCosLatitude.data(); }
+
+private:
+    std::vector<int64_t> _trackId;
+    std::vector<double> _sampleTime;
+    std::vector<double> _latitude;
+    std::vector<double> _longitude;
+    std::vector<double> _altitude;
+    std::vector<double> _groundSpeed;
+    std::vector<double> _trackAngle;
+    std::vector<double> _verticalSpeed;
+    std::vector<double> _eastVelocity;
+    std::vector<double> _northVelocity;
+    std::vector<double> _inverseCosLatitude;
+    std::unordered_map<int64_t, size_t> _rows;
+};
+
+} // namespace ironman
+
+#endif // IRONMAN_TARGET_TABLE_HPP
@@ -0,0 +1,92 @@
+//
+//  TileProjection.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 24/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_TILE_PROJECTION_HPP
+#define IRONMAN_TILE_PROJECTION_HPP
+
+#include "ironman/Geodesy.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace ironman {
+
+// Web mercator and the mapping engine's tile addresses for arrays of points, in place of MEMath
+// mercatorTo3857: and METile initWithLocation:level:, which take one point and one object at a time.
+// The kernels use the branch-free vectormath helpers so a frame's worth of points vectorizes.
+namespace tiles {
+
+// EPSG:3857's sphere, WGS84's semi-major axis.
+constexpr double kMercatorRadius = 6378137.0;
+// Where mercator is a square: y = x = pi * kMercatorRadius. METile's Level, X and Y are not relevant
+// beyond it.
+constexpr double kMercatorLimit = 85.051128779806604;
+// METileRegion's boundary between the center and the polar regions.
+constexpr double kRegionLimit = 80.0;
+// Levels the uid has room for.
+constexpr int kMaxLevel = 28;
+
+// METileRegion's values.
+enum class TileRegion : uint8_t {
+    Root = 0,
+    Center = 1,
+    North = 2,
+    South = 3,
+};
+
+// METile's level, x and y, with y counted down from the north as in METile initWithLevel:X:Y:.
+// Between the mercator limits the tile is the mercator tile; polar tiles are the polar caps' own
+// tiles, flagged by polar.
+struct TileAddress {
+    int level;
+    int x;
+    int y;
+    TileRegion region;
+    bool polar;
+};
+
+// METile's minX, minY, maxX and maxY as longitude and latitude degrees.
+struct TileBounds {
+    double minLongitude;
+    double minLatitude;
+    double maxLongitude;
+    double maxLatitude;
+};
+
+// Latitude and longitude degrees to and from EPSG:3857 meters (MEMath mercatorTo3857:). Latitudes
+// are clamped to the mercator limit.
+void toMercator(const double *latitudes, const double *longitudes, double *x, double *y, size_t count);
+void fromMercator(const double *x, const double *y, double *latitudes, double *longitudes, size_t count);
+
+// The uid of the tile at level holding each point (METile initWithLocation:level: then uid).
+//
+// The engine does not publish its uid layout, so these uids are this library's own and are not
+// interchangeable with METile uid. Bit 63 down:
+//   2 bits  region, as METileRegion
+//   1 bit   polar cap tile
+//   5 bits  level, 0 to kMaxLevel
+//   28 bits x
+//   28 bits y
+// Level 0 is the root tile, whatever the point. Below it, between the mercator limits, x and y are
+// the mercator tile's; the region is North for a tile wholly north of 80 degrees, South for one
+// wholly south of -80, and Center otherwise, straddling tiles included. Beyond the mercator limits
+// the tile is in a polar cap, each cap cut into 2^level columns of longitude and 2^level rows of
+// latitude between the limit and the pole, y counted southward as in mercator, region North or South.
+void tileUids(const double *latitudes, const double *longitudes, int level, uint64_t *uids, size_t count);
+
+uint64_t tileUid(const TileAddress &address);
+TileAddress tileAddress(uint64_t uid);
+TileAddress tileAt(geodesy::GeoPoint point, int level);
+// The root tile is the whole globe, pole to pole.
+TileBounds tileBounds(const TileAddress &address);
+// Whether an address, a decoded uid say, is a tile of the layout above.
+bool isValid(const TileAddress &address);
+
+} // namespace tiles
+} // namespace ironman
+
+#endif // IRONMAN_TILE_PROJECTION_HPP
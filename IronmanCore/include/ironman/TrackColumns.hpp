@@ -0,0 +1,96 @@
+//
+//  TrackColumns.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 08/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_TRACK_COLUMNS_HPP
+#define IRONMAN_TRACK_COLUMNS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ironman {
+
+// One TRAF, OWN or TRACK sample in canonical units, whatever order the table stores its columns in.
+// groundSpeed is m_horizontalVelocity1 in knots, trackAngle is m_horizontalVelocity2 in degrees true,
+// altitude is in feet and verticalSpeed in feet per minute. trackId is 0 for TRAF and OWN.
+struct TrackSample {
+    int64_t trackId = 0;
+    int64_t timeOfApplicability = 0;
+    double latitude = 0;
+    double longitude = 0;
+    double altitude = 0;
+    double groundSpeed = 0;
+    double trackAngle = 0;
+    double verticalSpeed = 0;
+};
+
+// Samples stored one array per field, so kernels stream over only the fields they use.
+struct TrackColumns {
+    std::vector<int64_t> trackId;
+    std::vector<int64_t> timeOfApplicability;
+    std::vector<double> latitude;
+    std::vector<double> longitude;
+    std::vector<double> altitude;
+    std::vector<double> groundSpeed;
+    std::vector<double> trackAngle;
+    std::vector<double> verticalSpeed;
+
+    size_t size() const { return timeOfApplicability.size(); }
+    bool empty() const { return timeOfApplicability.empty(); }
+
+    void reserve(size_t capacity){
+        trackId.reserve(capacity);
+        timeOfApplicability.reserve(capacity);
+        latitude.reserve(capacity);
+        longitude.reserve(capacity);
+        altitude.reserve(capacity);
+        groundSpeed.reserve(capacity);
+        trackAngle.reserve(capacity);
+        verticalSpeed.reserve(capacity);
+    }
+
+    // Keeps the capacity, so refilling the same columns does not allocate.
+    void clear(){
+        trackId.clear();
+        timeOfApplicability.clear();
+        latitude.clear();
+        longitude.clear();
+        altitude.clear();
+        groundSpeed.clear();
+        trackAngle.clear();
+        verticalSpeed.clear();
+    }
+
+    void push_back(const TrackSample &sample){
+        trackId.push_back(sample.trackId);
+        timeOfApplicability.push_back(sample.timeOfApplicability);
+        latitude.push_back(sample.latitude);
+        longitude.push_back(sample.longitude);
+        altitude.push_back(sample.altitude);
+        groundSpeed.push_back(sample.groundSpeed);
+        trackAngle.push_back(sample.trackAngle);
+        verticalSpeed.push_back(sample.verticalSpeed);
+    }
+
+    TrackSample operator[](size_t index) const{
+        TrackSample sample;
+        sample.trackId = trackId[index];
+        sample.timeOfApplicability = timeOfApplicability[index];
+        sample.latitude = latitude[index];
+        sample.longitude = longitude[index];
+        sample.altitude = altitude[index];
+        sample.groundSpeed = groundSpeed[index];
+        sample.trackAngle = trackAngle[index];
+        sample.verticalSpeed = verticalSpeed[index];
+        return sample;
+    }
+};
+
+} // namespace ironman
+
+#endif // IRONMAN_TRACK_COLUMNS_HPP
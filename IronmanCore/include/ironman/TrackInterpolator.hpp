@@ -0,0 +1,55 @@
+//
+//  TrackInterpolator.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 11/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_TRACK_INTERPOLATOR_HPP
+#define IRONMAN_TRACK_INTERPOLATOR_HPP
+
+#include "ironman/TrackColumns.hpp"
+#include <cstddef>
+
+namespace ironman {
+
+// A target's state at an arbitrary time, in TrackSample units.
+struct TrackState {
+    double time;
+    double latitude;
+    double longitude;
+    double altitude;
+    double groundSpeed;
+    double trackAngle;
+    double verticalSpeed;
+};
+
+// Evaluates one target's recorded track at any time between its samples. Each segment is a cubic
+// Hermite curve through the two samples with the recorded ground speed, track angle and vertical speed
+// as its end tangents, so the path turns and climbs the way the target did instead of cutting
+// straight between 1 Hz samples. A sample with a NULL velocity falls back to the chord.
+//
+// The segment found by the last call is cached: playback moving forward finds the next segment in
+// O(1) amortized, and any other jump is an O(log n) binary search. Before the first sample and after
+// the last one the end sample is held.
+class TrackInterpolator {
+public:
+    // track must hold one target's samples in increasing time order and outlive the interpolator.
+    explicit TrackInterpolator(const TrackColumns &track) : _track(track) {}
+
+    TrackState evaluate(double time);
+
+    // The segment starting at the sample of this index was used by the last evaluate.
+    size_t segment() const { return _segment; }
+
+private:
+    size_t locate(double time);
+
+    const TrackColumns &_track;
+    size_t _segment = 0;
+};
+
+} // namespace ironman
+
+#endif // IRONMAN_TRACK_INTERPOLATOR_HPP
@@ -0,0 +1,62 @@
+//
+//  TrackReader.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 08/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_TRACK_READER_HPP
+#define IRONMAN_TRACK_READER_HPP
+
+#include "ironman/DBTrackArchive.h"
+#include "ironman/Database.hpp"
+#include "ironman/TrackColumns.hpp"
+#include "ironman/TrackSchema.hpp"
+#include <cstdint>
+#include <limits>
+
+namespace ironman {
+
+enum class TrackTable {
+    Traffic,
+    Ownship,
+    Track,
+};
+
+// Decodes recorded samples into TrackColumns. The select for each table is compiled on first use and
+// reused for every later load, and each row is decoded by the table's schema with its column indices
+// fixed at compile time.
+class TrackReader {
+public:
+    explicit TrackReader(Database &database) : _database(database) {}
+
+    // Appends the rows with startTime <= time <= endTime in time order, TRACK's tracks interleaved.
+    // Returns false if the query failed; rows decoded before the failure are kept.
+    bool load(TrackTable table, TrackColumns &columns,
+              int64_t startTime = std::numeric_limits<int64_t>::min(),
+              int64_t endTime = std::numeric_limits<int64_t>::max());
+
+private:
+    template <typename Schema>
+    bool load(Statement &statement, TrackColumns &columns, int64_t startTime, int64_t endTime);
+
+    Database &_database;
+    Statement _statements[3];
+};
+
+// The select TrackReader runs for a table, selectQuery<Schema>() of the table's schema. It takes the
+// start and end of the time window as parameters 1 and 2.
+const char *trackSelectQuery(TrackTable table);
+
+typedef TrackSample (*TrackRowDecoder)(const Statement &statement);
+
+// The decoder for rows of a statement running trackSelectQuery(table).
+TrackRowDecoder trackRowDecoder(TrackTable table);
+
+// Appends an archive span, which is already in canonical column order.
+void appendArchiveSpan(const DBTrackArchiveSpan &span, TrackColumns &columns);
+
+} // namespace ironman
+
+#endif // IRONMAN_TRACK_READER_HPP
@@ -0,0 +1,197 @@
+//
+//  TrackSchema.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 18/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_TRACK_SCHEMA_HPP
+#define IRONMAN_TRACK_SCHEMA_HPP
+
+#include "ironman/Database.hpp"
+#include "ironman/TrackColumns.hpp"
+#include <string>
+#include <utility>
+
+namespace ironman {
+
+// The canonical quantity a stored column holds, one per TrackSample field.
+enum class TrackField {
+    TrackId,
+    TimeOfApplicability,
+    Latitude,
+    Longitude,
+    Altitude,
+    GroundSpeed,
+    TrackAngle,
+    VerticalSpeed,
+};
+
+struct SchemaColumn {
+    const char *name;
+    TrackField field;
+};
+
+// Schema descriptors. Each lists a table's columns in the order the table stores them, ending with a
+// null name, and says which TrackSample field each one carries. The select and the row decoder are
+// generated from the descriptor at compile time, so a new source schema needs nothing but one of these.
+// A field the table lacks keeps TrackSample's default; the time and position are required.
+
+struct TrafficSchema {
+    static constexpr const char *table(){ return "TRAF"; }
+    static constexpr SchemaColumn column(int index){
+        const SchemaColumn columns[] = {
+            {"m_timeOfApplicability", TrackField::TimeOfApplicability},
+            {"m_horizontalPosition1", TrackField::Latitude},
+            {"m_horizontalPosition2", TrackField::Longitude},
+            {"m_Altitude", TrackField::Altitude},
+            {"m_horizontalVelocity1", TrackField::GroundSpeed},
+            {"m_horizontalVelocity2", TrackField::TrackAngle},
+            {"m_verticalSpeed", TrackField::VerticalSpeed},
+            {nullptr, TrackField::TrackId},
+        };
+        return columns[index];
+    }
+};
+
+// OWN names its position and altitude differently and stores the two velocities swapped.
+struct OwnshipSchema {
+    static constexpr const char *table(){ return "OWN"; }
+    static constexpr SchemaColumn column(int index){
+        const SchemaColumn columns[] = {
+            {"m_timeOfApplicability", TrackField::TimeOfApplicability},
+            {"m_Latitude", TrackField::Latitude},
+            {"m_Longitude", TrackField::Longitude},
+            {"m_pressureAltitude", TrackField::Altitude},
+            {"m_horizontalVelocity2", TrackField::TrackAngle},
+            {"m_horizontalVelocity1", TrackField::GroundSpeed},
+            {"m_verticalVelocity", TrackField::VerticalSpeed},
+            {nullptr, TrackField::TrackId},
+        };
+        return columns[index];
+    }
+};
+
+// The track store written by DBTrackWriter. Rows are read through its covering time index.
+struct TrackStoreSchema {
+    static constexpr const char *table(){ return "TRACK"; }
+    static constexpr SchemaColumn column(int index){
+        const SchemaColumn columns[] = {
+            {"m_trackId", TrackField::TrackId},
+            {"m_timeOfApplicability", TrackField::TimeOfApplicability},
+            {"m_horizontalPosition1", TrackField::Latitude},
+            {"m_horizontalPosition2", TrackField::Longitude},
+            {"m_Altitude", TrackField::Altitude},
+            {"m_horizontalVelocity1", TrackField::GroundSpeed},
+            {"m_horizontalVelocity2", TrackField::TrackAngle},
+            {"m_verticalSpeed", TrackField::VerticalSpeed},
+            {nullptr, TrackField::TrackId},
+        };
+        return columns[index];
+    }
+};
+
+namespace schema {
+
+template <typename Schema>
+constexpr int columnCount(){
+    int count = 0;
+    while (Schema::column(count).name != nullptr) {
+        count++;
+    }
+    return count;
+}
+
+// The select position of the column holding field, or -1 if the table has none.
+template <typename Schema>
+constexpr int columnOf(TrackField field){
+    for (int i=0; i<columnCount<Schema>(); i++) {
+        if (Schema::column(i).field == field) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+template <typename Schema>
+constexpr bool isValid(){
+    for (int i=0; i<columnCount<Schema>(); i++) {
+        for (int j=i+1; j<columnCount<Schema>(); j++) {
+            if (Schema::column(i).field == Schema::column(j).field) {
+                return false;
+            }
+        }
+    }
+    return columnOf<Schema>(TrackField::TimeOfApplicability) >= 0 && columnOf<Schema>(TrackField::Latitude) >= 0
+        && columnOf<Schema>(TrackField::Longitude) >= 0;
+}
+
+template <TrackField Field>
+using FieldTag = std::integral_constant<TrackField, Field>;
+
+// One overload per field, chosen at compile time; each is a single column read.
+inline void readField(FieldTag<TrackField::TrackId>, const Statement &statement, int column, TrackSample &sample){
+    sample.trackId = statement.int64Column(column);
+}
+inline void readField(FieldTag<TrackField::TimeOfApplicability>, const Statement &statement, int column, TrackSample &sample){
+    sample.timeOfApplicability = statement.int64Column(column);
+}
+inline void readField(FieldTag<TrackField::Latitude>, const Statement &statement, int column, TrackSample &sample){
+    sample.latitude = statement.doubleColumn(column);
+}
+inline void readField(FieldTag<TrackField::Longitude>, const Statement &statement, int column, TrackSample &sample){
+    sample.longitude = statement.doubleColumn(column);
+}
+inline void readField(FieldTag<TrackField::Altitude>, const Statement &statement, int column, TrackSample &sample){
+    sample.altitude = statement.doubleColumn(column);
+}
+inline void readField(FieldTag<TrackField::GroundSpeed>, const Statement &statement, int column, TrackSample &sample){
+    sample.groundSpeed = statement.doubleColumn(column);
+}
+inline void readField(FieldTag<TrackField::TrackAngle>, const Statement &statement, int column, TrackSample &sample){
+    sample.trackAngle = statement.doubleColumn(column);
+}
+inline void readField(FieldTag<TrackField::VerticalSpeed>, const Statement &statement, int column, TrackSample &sample){
+    sample.verticalSpeed = statement.doubleColumn(column);
+}
+
+// Expands to one read per column with its index fixed, in stored order, with no lookup or switch.
+template <typename Schema, int... Index>
+inline void readColumns(const Statement &statement, TrackSample &sample, std::integer_sequence<int, Index...>){
+    using expand = int[];
+    (void)expand{0, (readField(FieldTag<Schema::column(Index).field>(), statement, Index, sample), 0)...};
+}
+
+// "select <columns in stored order> from <table> where <time> between ? and ? order by <time>[, <trackId>]".
+std::string selectQuery(const char *table, const SchemaColumn *columns, int count);
+
+template <typename Schema, int... Index>
+inline std::string selectQuery(std::integer_sequence<int, Index...>){
+    const SchemaColumn columns[] = {Schema::column(Index)...};
+    return selectQuery(Schema::table(), columns, sizeof...(Index));
+}
+
+} // namespace schema
+
+// The select for a schema, built on first use. It takes the start and end of the time window as
+// parameters 1 and 2.
+template <typename Schema>
+const char *selectQuery(){
+    static_assert(schema::isValid<Schema>(), "a schema needs time and position columns, each field at most once");
+    static const std::string query = schema::selectQuery<Schema>(std::make_integer_sequence<int, schema::columnCount<Schema>()>());
+    return query.c_str();
+}
+
+// Decodes the current row of a statement running selectQuery<Schema>().
+template <typename Schema>
+TrackSample decodeRow(const Statement &statement){
+    static_assert(schema::isValid<Schema>(), "a schema needs time and position columns, each field at most once");
+    TrackSample sample;
+    schema::readColumns<Schema>(statement, sample, std::make_integer_sequence<int, schema::columnCount<Schema>()>());
+    return sample;
+}
+
+} // namespace ironman
+
+#endif // IRONMAN_TRACK_SCHEMA_HPP
@@ -0,0 +1,68 @@
+//
+//  TrackSource.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 10/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_TRACK_SOURCE_HPP
+#define IRONMAN_TRACK_SOURCE_HPP
+
+#include "ironman/DBTrackArchive.h"
+#include "ironman/Database.hpp"
+#include "ironman/TrackColumns.hpp"
+#include "ironman/TrackReader.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace ironman {
+
+// A time-ordered stream of samples, read one at a time so nothing has to be loaded up front.
+class TrackSource {
+public:
+    virtual ~TrackSource() = default;
+
+    // Fills sample with the next one and returns true, or returns false at the end of the stream.
+    virtual bool next(TrackSample &sample) = 0;
+};
+
+// Steps a live query. TRACK rows come in time order, tracks interleaved.
+class StatementTrackSource : public TrackSource {
+public:
+    StatementTrackSource(Database &database, TrackTable table,
+                         int64_t startTime = std::numeric_limits<int64_t>::min(),
+                         int64_t endTime = std::numeric_limits<int64_t>::max());
+    bool next(TrackSample &sample) override;
+    bool failed() const { return _statement.failed() || !_statement.isValid(); }
+
+private:
+    Statement _statement;
+    TrackRowDecoder _decode;
+};
+
+class ColumnsTrackSource : public TrackSource {
+public:
+    explicit ColumnsTrackSource(const TrackColumns &columns) : _columns(columns) {}
+    bool next(TrackSample &sample) override;
+
+private:
+    const TrackColumns &_columns;
+    size_t _index = 0;
+};
+
+// Reads straight out of a mapped archive; trackId is always 0.
+class ArchiveTrackSource : public TrackSource {
+public:
+    explicit ArchiveTrackSource(const DBTrackArchiveSpan &span) : _span(span) {}
+    bool next(TrackSample &sample) override;
+
+private:
+    DBTrackArchiveSpan _span;
+    size_t _index = 0;
+};
+
+} // namespace ironman
+
+#endif // IRONMAN_TRACK_SOURCE_HPP
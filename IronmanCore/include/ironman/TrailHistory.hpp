@@ -0,0 +1,113 @@
+//
+//  TrailHistory.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 17/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_TRAIL_HISTORY_HPP
+#define IRONMAN_TRAIL_HISTORY_HPP
+
+#include "ironman/TrailSimplifier.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ironman {
+
+struct TrailHistorySettings {
+    // Points kept per target; the oldest is evicted to make room.
+    size_t capacity = 600;
+    // Points older than this many seconds before a target's latest are evicted.
+    double maxAge = 600;
+};
+
+// Points of one trail that are contiguous in the arena. A ring that wraps is two spans.
+struct TrailSpan {
+    const TrailPoint *points;
+    size_t count;
+};
+
+// What happened to one trail since the last frame. A renderer holding each trail's points drops
+// evicted from the front of its copy, then adds appended[0] and appended[1] at the back.
+struct TrailChange {
+    int64_t trackId;
+    size_t evicted;
+    TrailSpan appended[2];
+    // The trail is new this frame: the renderer has nothing to evict from.
+    bool created;
+};
+
+// Every target's recent history in one ring buffer per target, all carved out of one contiguous arena
+// of fixed-capacity slots, so appending never allocates once the arena has grown to the number of
+// targets and a removed target's slot is reused.
+//
+// Rather than a whole trail per update, changes() reports only what was appended and evicted since
+// the previous frame, so a renderer can push deltas to the engine whatever the trail length. Points
+// appended and evicted within the same frame are never reported.
+class TrailHistory {
+public:
+    explicit TrailHistory(const TrailHistorySettings &settings = TrailHistorySettings());
+
+    const TrailHistorySettings &settings() const { return _settings; }
+    size_t size() const { return _slots.size(); }
+
+    // Appends to the target's trail, creating it if needed. Returns false, ignoring the point, unless
+    // it is later than the trail's last.
+    bool append(int64_t trackId, const TrailPoint &point);
+    bool append(const TrackSample &sample);
+    // Evicts points older than maxAge before time from every trail, including targets that have
+    // stopped reporting. A trail left empty stays until removed.
+    void expire(double time);
+    // Returns false if the target has no trail.
+    bool remove(int64_t trackId);
+    void clear();
+
+    // Points in the target's trail, oldest first; zero if it has none.
+    size_t count(int64_t trackId) const;
+    // The trail as up to two spans, oldest first; returns the number of spans.
+    int points(int64_t trackId, TrailSpan spans[2]) const;
+
+    // Trails changed since the last call, replacing the contents of changed, and targets removed,
+    // replacing the contents of removed. Spans point into the arena and are valid until the next
+    // append, remove or clear. A renderer applies removals first: a target removed and appended to in
+    // the same frame is reported as removed and then created.
+    void changes(std::vector<TrailChange> &changed, std::vector<int64_t> &removed);
+
+private:
+    // One target's ring. Positions are sequence numbers counted from the trail's creation; a point's
+    // place in the ring is its sequence modulo the capacity.
+    struct Trail {
+        int64_t trackId;
+        uint64_t first;
+        uint64_t end;
+        // The range the renderer was last told about.
+        uint64_t reportedFirst;
+        uint64_t reportedEnd;
+        bool created;
+        bool dirty;
+        // False once removed, until the slot is reused.
+        bool live;
+    };
+
+    TrailPoint *ring(uint32_t slot) { return _arena.data() + slot * _settings.capacity; }
+    const TrailPoint *ring(uint32_t slot) const { return _arena.data() + slot * _settings.capacity; }
+    uint32_t slotOf(int64_t trackId);
+    void evictBefore(uint32_t slot, double time);
+    void markDirty(uint32_t slot);
+    int spansOf(uint32_t slot, uint64_t from, uint64_t to, TrailSpan spans[2]) const;
+
+    TrailHistorySettings _settings;
+    std::vector<TrailPoint> _arena;
+    std::vector<Trail> _trails;
+    std::vector<uint32_t> _freeSlots;
+    std::unordered_map<int64_t, uint32_t> _slots;
+    std::vector<uint32_t> _dirty;
+    std::vector<int64_t> _removed;
+};
+
+} // namespace ironman
+
+#endif // IRONMAN_TRAIL_HISTORY_HPP
@@ -0,0 +1,116 @@
+//
+//  TrailSimplifier.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 16/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_TRAIL_SIMPLIFIER_HPP
+#define IRONMAN_TRAIL_SIMPLIFIER_HPP
+
+#include "ironman/TrackColumns.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace ironman {
+
+// One vertex of a drawn trail: seconds, degrees and feet, ready to become an MELocation3D.
+struct TrailPoint {
+    double time;
+    double latitude;
+    double longitude;
+    double altitude;
+};
+
+struct TrailSettings {
+    // Horizontal tolerance of the finest level, nautical miles. 0.005 nm is about 9 m.
+    double tolerance = 0.005;
+    // Altitude tolerance of the finest level, feet.
+    double altitudeTolerance = 25;
+    // Each level doubles both tolerances of the one below it.
+    int levelCount = 12;
+    // No two kept vertices are further apart in time than this, seconds, at any level.
+    double maxVertexGap = 300;
+};
+
+// Reduces one target's trail, as samples append, to the vertices needed at each zoom.
+//
+// The error of a simplified trail is time-synchronized: a dropped sample is compared with where the
+// trail puts the target at that sample's time, interpolating linearly in time along the kept segment,
+// not with the nearest point of the segment. So a kept trail is within tolerance of the target both
+// in space and in when it was there, and a holding pattern or a stop is not folded onto a straight
+// line.
+//
+// Every level runs an opening window from its last kept vertex. Each sample in the window limits the
+// segment's velocity to a disk, east/north in nautical miles per second, and its climb rate to an
+// interval; a new sample extends the segment if its velocity from the anchor lies in every disk,
+// otherwise the previous sample is kept and becomes the anchor. The disks are intersected as an
+// octagon inscribed in each, which keeps the bound strict at up to 8% below the tolerance and makes
+// each append O(levelCount) with no window stored.
+//
+// Kept vertices only ever append, so a caller redrawing a line can tell from vertexCount(level)
+// whether anything but the last point moved.
+class TrailSimplifier {
+public:
+    explicit TrailSimplifier(const TrailSettings &settings = TrailSettings());
+
+    const TrailSettings &settings() const { return _settings; }
+    int levelCount() const { return static_cast<int>(_levels.size()); }
+    // Horizontal tolerance of a level, nautical miles.
+    double tolerance(int level) const;
+    // The coarsest level whose tolerance is within tolerance, or 0. For a map, pass the size of about
+    // half a pixel in nautical miles at the current zoom.
+    int levelFor(double tolerance) const;
+
+    // Returns false, ignoring the sample, unless it is later than the last one appended and has a
+    // position. A NULL altitude repeats the last altitude.
+    bool append(const TrailPoint &point);
+    bool append(const TrackSample &sample);
+    void clear();
+
+    // Samples appended since the last clear.
+    size_t sampleCount() const { return _sampleCount; }
+    // Vertices kept at level, not counting the latest sample that ends every trail.
+    size_t vertexCount(int level) const { return _levels[level].vertices.size(); }
+    const TrailPoint *latest() const { return _sampleCount > 0 ? &_latest : nullptr; }
+
+    // The trail at level: its kept vertices followed by the latest sample, replacing the contents of
+    // trail.
+    void vertices(int level, std::vector<TrailPoint> &trail) const;
+
+private:
+    // The intersection of every constraint in one level's window.
+    struct Window {
+        // Lower and upper bounds of the segment velocity projected on the octagon's four normals.
+        double lower[4];
+        double upper[4];
+        // Bounds of the climb rate, feet per second.
+        double climbLower;
+        double climbUpper;
+    };
+
+    struct Level {
+        double tolerance;
+        double altitudeTolerance;
+        std::vector<TrailPoint> vertices;
+        Window window;
+        // Whether the window holds any sample besides the anchor.
+        bool open;
+    };
+
+    static void resetWindow(Window &window);
+    // Velocity of point relative to anchor, nautical miles per second east and north, and climb rate.
+    static void velocityOf(const TrailPoint &anchor, const TrailPoint &point, double &east, double &north, double &climb);
+    static bool admits(const Window &window, double east, double north, double climb);
+    static void constrain(Window &window, const Level &level, double dt, double east, double north, double climb);
+
+    TrailSettings _settings;
+    std::vector<Level> _levels;
+    size_t _sampleCount = 0;
+    TrailPoint _latest;
+};
+
+} // namespace ironman
+
+#endif // IRONMAN_TRAIL_SIMPLIFIER_HPP
@@ -0,0 +1,167 @@
+//
+//  VectorMath.hpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 21/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#ifndef IRONMAN_VECTOR_MATH_HPP
+#define IRONMAN_VECTOR_MATH_HPP
+
+#include "ironman/Geodesy.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace ironman {
+
+// Branch-free stand-ins for libm's trigonometry, log and exp, for per-target kernels. Every helper is
+// inline, straight-line arithmetic and selects, so a loop calling them if-converts and vectorizes
+// where a libm call would keep it scalar.
+namespace vectormath {
+
+constexpr double kPi = geodesy::kPi;
+constexpr double kHalfPi = kPi / 2;
+constexpr double kTwoPi = kPi * 2;
+// Adding and subtracting 1.5 * 2^52 rounds a double to the nearest integer without a libm call.
+constexpr double kRoundingBias = 6755399441055744.0;
+
+inline double roundToInteger(double x){
+    return (x + kRoundingBias) - kRoundingBias;
+}
+
+// Into [-pi, pi].
+inline double wrapRadians(double x){
+    return x - roundToInteger(x * (1.0 / kTwoPi)) * kTwoPi;
+}
+
+// Into [-180, 180].
+inline double wrapDegrees(double x){
+    return x - roundToInteger(x * (1.0 / 360.0)) * 360.0;
+}
+
+// sin on [-pi, pi]: folded into [-pi/2, pi/2] through sin(x) = sin(+-pi - x), then Taylor to x^23,
+// within 1e-20 there.
+inline double sinReduced(double x){
+    double y = x > kHalfPi ? kPi - x : x;
+    y = x < -kHalfPi ? -kPi - x : y;
+    double z = y * y;
+    double p = -3.868170170630684e-23;
+    p = p * z + 1.9572941063391263e-20;
+    p = p * z - 8.22063524662433e-18;
+    p = p * z + 2.8114572543455206e-15;
+    p = p * z - 7.647163731819816e-13;
+    p = p * z + 1.6059043836821613e-10;
+    p = p * z - 2.505210838544172e-08;
+    p = p * z + 2.7557319223985893e-06;
+    p = p * z - 0.0001984126984126984;
+    p = p * z + 0.008333333333333333;
+    p = p * z - 0.16666666666666666;
+    return y + y * z * p;
+}
+
+// cos on [-pi, pi].
+inline double cosReduced(double x){
+    return sinReduced(kHalfPi - std::fabs(x));
+}
+
+// atan2 in (-pi, pi], with atan2(0, 0) = 0 as in libm. The ratio of the smaller to the larger magnitude
+// is in [0, 1]; above 0.66 it is reduced through atan(t) = pi/4 + atan((t - 1) / (t + 1)), and the
+// rest is Cephes' rational approximation, within 2e-16.
+inline double atan2Reduced(double y, double x){
+    double ax = std::fabs(x);
+    double ay = std::fabs(y);
+    double larger = std::max(ax, ay);
+    double smaller = std::min(ax, ay);
+    double t = smaller / (larger > 0 ? larger : 1.0);
+
+    bool reduce = t > 0.66;
+    double u = reduce ? (t - 1.0) / (t + 1.0) : t;
+    double z = u * u;
+    double numerator = -8.750608600031904122785e-1;
+    numerator = numerator * z - 1.615753718733365076637e1;
+    numerator = numerator * z - 7.500855792314704667340e1;
+    numerator = numerator * z - 1.228866684490136173410e2;
+    numerator = numerator * z - 6.485021904942025371773e1;
+    double denominator = z + 2.485846490142306297962e1;
+    denominator = denominator * z + 1.650270098316988542046e2;
+    denominator = denominator * z + 4.328810604912902668951e2;
+    denominator = denominator * z + 4.853903996359136964868e2;
+    denominator = denominator * z + 1.945506571482613964425e2;
+    double angle = (reduce ? kPi / 4 : 0.0) + u + u * z * numerator / denominator;
+
+    // Back out to the full circle: swap when |y| > |x|, reflect for x < 0 and y < 0.
+    angle = ay > ax ? kHalfPi - angle : angle;
+    angle = x < 0 ? kPi - angle : angle;
+    return y < 0 ? -angle : angle;
+}
+
+constexpr double kLn2Hi = 6.93147180369123816490e-01;
+constexpr double kLn2Lo = 1.90821492927058770002e-10;
+
+// log for positive normal x. The exponent is read out of the bits and converted through the 2^52
+// bias rather than an int64 conversion, which SSE2 lacks; the mantissa is folded into
+// [sqrt(1/2), sqrt(2)) and expanded as 2 atanh(f), f = (m - 1) / (m + 1), to f^21, within 1e-17.
+inline double logPositive(double x){
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    uint64_t exponentBits = (bits >> 52) | 0x4330000000000000ULL;
+    double exponent;
+    std::memcpy(&exponent, &exponentBits, sizeof(exponent));
+    exponent -= 4503599627370496.0 + 1023.0;
+    uint64_t mantissaBits = (bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+    double m;
+    std::memcpy(&m, &mantissaBits, sizeof(m));
+
+    bool fold = m > 1.4142135623730951;
+    m = fold ? m * 0.5 : m;
+    exponent += fold ? 1.0 : 0.0;
+    double f = (m - 1.0) / (m + 1.0);
+    double z = f * f;
+    double p = 1.0 / 21;
+    p = p * z + 1.0 / 19;
+    p = p * z + 1.0 / 17;
+    p = p * z + 1.0 / 15;
+    p = p * z + 1.0 / 13;
+    p = p * z + 1.0 / 11;
+    p = p * z + 1.0 / 9;
+    p = p * z + 1.0 / 7;
+    p = p * z + 1.0 / 5;
+    p = p * z + 1.0 / 3;
+    return exponent * kLn2Hi + (2 * f + (2 * f * z * p + exponent * kLn2Lo));
+}
+
+// exp for |x| < 708. Reduced to e^r * 2^k with |r| <= ln(2) / 2 and Taylor to r^13, within 1e-17;
+// 2^k is built by shifting k + 1023, read out of the rounding bias's low bits, into the exponent.
+inline double expReduced(double x){
+    double k = roundToInteger(x * 1.4426950408889634);
+    double r = (x - k * kLn2Hi) - k * kLn2Lo;
+    double p = 1.0 / 6227020800;
+    p = p * r + 1.0 / 479001600;
+    p = p * r + 1.0 / 39916800;
+    p = p * r + 1.0 / 3628800;
+    p = p * r + 1.0 / 362880;
+    p = p * r + 1.0 / 40320;
+    p = p * r + 1.0 / 5040;
+    p = p * r + 1.0 / 720;
+    p = p * r + 1.0 / 120;
+    p = p * r + 1.0 / 24;
+    p = p * r + 1.0 / 6;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+    double biased = k + (kRoundingBias + 1023.0);
+    uint64_t bits;
+    std::memcpy(&bits, &biased, sizeof(bits));
+    bits <<= 52;
+    double scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+} // namespace vectormath
+} // namespace ironman
+
+#endif // IRONMAN_VECTOR_MATH_HPP
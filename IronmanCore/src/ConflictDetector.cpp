@@ -0,0 +1,213 @@
+//
+//  ConflictDetector.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 13/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/ConflictDetector.hpp"
+#include "ironman/Geodesy.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ironman {
+
+// Upper altitude bound of each sensitivity level, then its TA tau/DMOD/ZTHR and RA tau/DMOD/ZTHR.
+static const struct {
+    double ceiling;
+    AlertThresholds thresholds;
+} kSensitivityLevels[] = {
+    {1000,     {2, 20, 0.30, 850, 0, 0, 0}},
+    {2350,     {3, 25, 0.33, 850, 15, 0.20, 600}},
+    {5000,     {4, 30, 0.48, 850, 20, 0.35, 600}},
+    {10000,    {5, 40, 0.75, 850, 25, 0.55, 600}},
+    {20000,    {6, 45, 1.00, 850, 30, 0.80, 600}},
+    {42000,    {7, 48, 1.30, 850, 35, 1.10, 700}},
+    {INFINITY, {7, 48, 1.30, 1200, 35, 1.10, 800}},
+};
+
+AlertThresholds alertThresholdsForAltitude(double altitude){
+    for (const auto &level : kSensitivityLevels) {
+        if (altitude < level.ceiling) {
+            return level.thresholds;
+        }
+    }
+    return kSensitivityLevels[0].thresholds;
+}
+
+// The ownship and the thresholds for one update, with velocities in nautical miles and feet per second.
+struct OwnshipFrame {
+    double time;
+    double stalenessHorizon;
+    double latitude;
+    double longitude;
+    double altitude;
+    double eastRate;
+    double northRate;
+    double climbRate;
+    double milesPerDegreeEast;
+    double trafficTau;
+    double trafficDmod2;
+    double trafficZthr;
+    double resolutionTau;
+    double resolutionDmod2;
+    double resolutionZthr;
+    double resolutionEnabled;
+};
+
+// Positions in nautical miles and feet, velocities in nautical miles and feet per second, all relative
+// to the ownship. The loop has no branches so the compiler vectorizes it; levels come out as doubles
+// because narrowing to bytes inside the loop would stop that.
+static void closestApproaches(size_t count, const OwnshipFrame own,
+                              const double *__restrict sampleTime, const double *__restrict latitude,
+                              const double *__restrict longitude, const double *__restrict altitude,
+                              const double *__restrict eastVelocity, const double *__restrict northVelocity,
+                              const double *__restrict verticalSpeed, double *__restrict outTime,
+                              double *__restrict outRange, double *__restrict outAltitude, double *__restrict outLevel){
+    for (size_t i=0; i<count; i++) {
+        // The age is clamped to [0, horizon] like DeadReckoningPredictor's, and a target beyond it is
+        // held there and kept out of the alerts.
+        double age = own.time - sampleTime[i];
+        double step = age < 0 ? 0.0 : age;
+        step = step > own.stalenessHorizon ? own.stalenessHorizon : step;
+        double fresh = age <= own.stalenessHorizon ? 1.0 : 0.0;
+        double eastRate = eastVelocity[i] * (1.0 / 3600.0);
+        double northRate = northVelocity[i] * (1.0 / 3600.0);
+        double climbRate = verticalSpeed[i] * (1.0 / 60.0);
+
+        // Selects only pick between constants: arithmetic inside one arm could trap, which stops the
+        // compiler from if-converting it.
+        double deltaLongitude = longitude[i] - own.longitude;
+        double wrap = deltaLongitude > 180.0 ? -360.0 : 0.0;
+        wrap = deltaLongitude < -180.0 ? 360.0 : wrap;
+        deltaLongitude += wrap;
+        double east = deltaLongitude * own.milesPerDegreeEast + eastRate * step;
+        double north = (latitude[i] - own.latitude) * 60.0 + northRate * step;
+        double above = altitude[i] + climbRate * step - own.altitude;
+
+        double relativeEast = eastRate - own.eastRate;
+        double relativeNorth = northRate - own.northRate;
+        double relativeClimb = climbRate - own.climbRate;
+
+        double range2 = east * east + north * north;
+        double closing = east * relativeEast + north * relativeNorth;
+        double speed2 = relativeEast * relativeEast + relativeNorth * relativeNorth;
+        // An opening intruder is at its closest now; the tiny bias keeps 0 / 0 out of the division.
+        double approach = closing < 0 ? -closing : 0.0;
+        double time = approach / (speed2 + 1e-300);
+        double missEast = east + relativeEast * time;
+        double missNorth = north + relativeNorth * time;
+        outTime[i] = time;
+        outRange[i] = std::sqrt(missEast * missEast + missNorth * missNorth);
+        outAltitude[i] = above + relativeClimb * time;
+
+        // Conditions are 1.0 or 0.0. The modified tau (DMOD^2 - r^2) / (r * rdot) <= tau is multiplied
+        // through by the negative r * rdot; the vertical tau is |a| / |adot| <= tau while converging.
+        double separation = std::fabs(above);
+        double climbMagnitude = std::fabs(relativeClimb);
+        double approaching = closing < 0 ? 1.0 : 0.0;
+        double converging = above * relativeClimb < 0 ? 1.0 : 0.0;
+        double trafficInside = range2 <= own.trafficDmod2 ? 1.0 : 0.0;
+        double trafficClosing = own.trafficDmod2 - range2 >= own.trafficTau * closing ? approaching : 0.0;
+        double trafficLevel = separation <= own.trafficZthr ? 1.0 : 0.0;
+        double trafficClimbing = separation <= own.trafficTau * climbMagnitude ? converging : 0.0;
+        double resolutionInside = range2 <= own.resolutionDmod2 ? 1.0 : 0.0;
+        double resolutionClosing = own.resolutionDmod2 - range2 >= own.resolutionTau * closing ? approaching : 0.0;
+        double resolutionLevel = separation <= own.resolutionZthr ? 1.0 : 0.0;
+        double resolutionClimbing = separation <= own.resolutionTau * climbMagnitude ? converging : 0.0;
+        double traffic = (trafficInside > trafficClosing ? trafficInside : trafficClosing)
+                       * (trafficLevel > trafficClimbing ? trafficLevel : trafficClimbing);
+        double resolution = own.resolutionEnabled
+                          * (resolutionInside > resolutionClosing ? resolutionInside : resolutionClosing)
+                          * (resolutionLevel > resolutionClimbing ? resolutionLevel : resolutionClimbing);
+        outLevel[i] = fresh * ((traffic > resolution ? traffic : resolution) + resolution);
+    }
+}
+
+ConflictDetector::ConflictDetector(double stalenessHorizon) : _stalenessHorizon(stalenessHorizon) {
+    // Written so NaN fails the comparison and takes the minimum too.
+    _stalenessHorizon = _stalenessHorizon >= 0 ? _stalenessHorizon : 0;
+}
+
+void ConflictDetector::update(const TrackState &ownship, const TargetTable &targets, ConflictColumns &conflicts,
+                              std::vector<AlertTransition> &transitions){
+    size_t count = targets.size();
+    conflicts.timeToClosestApproach.resize(count);
+    conflicts.closestApproachRange.resize(count);
+    conflicts.closestApproachAltitude.resize(count);
+    conflicts.level.resize(count);
+    transitions.clear();
+
+    // A missing ownship velocity counts as standing still, as it does for targets.
+    double ownTrack = geodesy::toRadians(ownship.trackAngle);
+    bool ownHasVelocity = std::isfinite(ownTrack) && std::isfinite(ownship.groundSpeed);
+    AlertThresholds thresholds = alertThresholdsForAltitude(ownship.altitude);
+    OwnshipFrame own;
+    own.time = ownship.time;
+    own.stalenessHorizon = _stalenessHorizon;
+    own.latitude = ownship.latitude;
+    own.longitude = ownship.longitude;
+    own.altitude = ownship.altitude;
+    own.eastRate = ownHasVelocity ? ownship.groundSpeed * std::sin(ownTrack) / 3600.0 : 0;
+    own.northRate = ownHasVelocity ? ownship.groundSpeed * std::cos(ownTrack) / 3600.0 : 0;
+    own.climbRate = std::isfinite(ownship.verticalSpeed) ? ownship.verticalSpeed / 60.0 : 0;
+    own.milesPerDegreeEast = 60.0 * std::cos(geodesy::toRadians(ownship.latitude));
+    own.trafficTau = thresholds.trafficTau;
+    own.trafficDmod2 = thresholds.trafficDmod * thresholds.trafficDmod;
+    own.trafficZthr = thresholds.trafficZthr;
+    own.resolutionTau = thresholds.resolutionTau;
+    own.resolutionDmod2 = thresholds.resolutionDmod * thresholds.resolutionDmod;
+    own.resolutionZthr = thresholds.resolutionZthr;
+    own.resolutionEnabled = thresholds.sensitivityLevel >= 3 ? 1.0 : 0.0;
+
+    double *outTime = conflicts.timeToClosestApproach.data();
+    double *outRange = conflicts.closestApproachRange.data();
+    _levels.resize(count);
+    closestApproaches(count, own, targets.sampleTime(), targets.latitude(), targets.longitude(), targets.altitude(),
+                      targets.eastVelocity(), targets.northVelocity(), targets.verticalSpeed(), outTime, outRange,
+                      conflicts.closestApproachAltitude.data(), _levels.data());
+
+    // Levels as bytes, and the alerting targets sorted like the previous ones so the two merge in one pass.
+    const int64_t *trackId = targets.trackId();
+    _nextAlerts.clear();
+    for (size_t i=0; i<count; i++) {
+        AlertLevel level = static_cast<AlertLevel>(static_cast<int>(_levels[i]));
+        conflicts.level[i] = level;
+        if (level != AlertLevel::None) {
+            _nextAlerts.push_back(Alert{trackId[i], level});
+        }
+    }
+    std::sort(_nextAlerts.begin(), _nextAlerts.end(), [](const Alert &a, const Alert &b){
+        return a.trackId < b.trackId;
+    });
+
+    auto previous = _alerts.begin();
+    auto next = _nextAlerts.begin();
+    while (previous != _alerts.end() || next != _nextAlerts.end()) {
+        if (next == _nextAlerts.end() || (previous != _alerts.end() && previous->trackId < next->trackId)) {
+            // Cleared, or gone from the table.
+            size_t row = targets.rowOf(previous->trackId);
+            bool present = row < count;
+            transitions.push_back(AlertTransition{previous->trackId, previous->level, AlertLevel::None,
+                                                  present ? outTime[row] : NAN, present ? outRange[row] : NAN});
+            ++previous;
+        }
+        else if (previous == _alerts.end() || next->trackId < previous->trackId) {
+            size_t row = targets.rowOf(next->trackId);
+            transitions.push_back(AlertTransition{next->trackId, AlertLevel::None, next->level, outTime[row], outRange[row]});
+            ++next;
+        }
+        else {
+            if (previous->level != next->level) {
+                size_t row = targets.rowOf(next->trackId);
+                transitions.push_back(AlertTransition{next->trackId, previous->level, next->level, outTime[row], outRange[row]});
+            }
+            ++previous;
+            ++next;
+        }
+    }
+    _alerts.swap(_nextAlerts);
+}
+
+} // namespace ironman
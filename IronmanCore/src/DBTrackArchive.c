@@ -0,0 +1,328 @@
+//
+//  DBTrackArchive.c
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 04/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/DBTrackArchive.h"
+#include <fcntl.h>
+#include <math.h>
+#include <sqlite3.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct DBTrackArchive {
+    const uint8_t *base;
+    size_t length;
+    const DBTrackArchiveSection *sections;
+};
+
+// Source columns of each table, in DBTrackArchiveColumn order. OWN stores the velocities swapped, so
+// they are selected by name.
+static const char *kSelectQueries[DBTrackArchiveTableCount] = {
+    "select m_timeOfApplicability, m_horizontalPosition1, m_horizontalPosition2, m_Altitude, m_horizontalVelocity1, m_horizontalVelocity2, m_verticalSpeed from TRAF where m_timeOfApplicability is not null order by m_timeOfApplicability",
+    "select m_timeOfApplicability, m_Latitude, m_Longitude, m_pressureAltitude, m_horizontalVelocity1, m_horizontalVelocity2, m_verticalVelocity from OWN where m_timeOfApplicability is not null order by m_timeOfApplicability",
+};
+
+static uint64_t alignedOffset(uint64_t offset){
+    return (offset + DBTrackArchiveAlignment - 1) & ~(uint64_t)(DBTrackArchiveAlignment - 1);
+}
+
+#pragma mark - Reading
+
+static int arrayIsInBounds(uint64_t offset, uint64_t count, size_t length){
+    return offset % DBTrackArchiveAlignment == 0 && offset <= length && count <= (length - offset) / 8;
+}
+
+DBTrackArchive *DBTrackArchiveOpen(const char *archivePath){
+    int fileDescriptor = open(archivePath, O_RDONLY);
+    if (fileDescriptor < 0) {
+        return NULL;
+    }
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0 || (size_t)fileStatus.st_size < sizeof(DBTrackArchiveHeader)) {
+        close(fileDescriptor);
+        return NULL;
+    }
+
+    // The mapping keeps the file alive, so the descriptor can go straight away.
+    size_t length = (size_t)fileStatus.st_size;
+    void *base = mmap(NULL, length, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    close(fileDescriptor);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    // Only the header and the section table are checked, so opening does not touch the data pages.
+    const DBTrackArchiveHeader *header = base;
+    const DBTrackArchiveSection *sections = (const DBTrackArchiveSection *)(header + 1);
+    int isValid = memcmp(header->magic, DBTrackArchiveMagic, sizeof(header->magic)) == 0
+        && header->version == DBTrackArchiveVersion
+        && header->sectionCount == DBTrackArchiveTableCount
+        && header->fileSize == length
+        && sizeof(DBTrackArchiveHeader) + DBTrackArchiveTableCount * sizeof(DBTrackArchiveSection) <= length;
+    for (int table=0; isValid && table<DBTrackArchiveTableCount; table++) {
+        const DBTrackArchiveSection *section = &sections[table];
+        isValid = arrayIsInBounds(section->timeOffset, section->rowCount, length)
+            && arrayIsInBounds(section->indexOffset, section->indexCount, length)
+            && section->indexCount == (section->rowCount + DBTrackArchiveIndexStride - 1) / DBTrackArchiveIndexStride;
+        for (int column=0; isValid && column<DBTrackArchiveColumnCount; column++) {
+            isValid = arrayIsInBounds(section->columnOffsets[column], section->rowCount, length);
+        }
+    }
+    if (!isValid) {
+        munmap(base, length);
+        return NULL;
+    }
+
+    DBTrackArchive *archive = malloc(sizeof(DBTrackArchive));
+    if (archive == NULL) {
+        munmap(base, length);
+        return NULL;
+    }
+    archive->base = base;
+    archive->length = length;
+    archive->sections = sections;
+    return archive;
+}
+
+void DBTrackArchiveClose(DBTrackArchive *archive){
+    if (archive == NULL) {
+        return;
+    }
+    munmap((void *)archive->base, archive->length);
+    free(archive);
+}
+
+DBTrackArchiveSpan DBTrackArchiveGetTable(const DBTrackArchive *archive, DBTrackArchiveTable table){
+    DBTrackArchiveSpan span;
+    const DBTrackArchiveSection *section = &archive->sections[table];
+    span.timeOfApplicability = (const int64_t *)(archive->base + section->timeOffset);
+    for (int column=0; column<DBTrackArchiveColumnCount; column++) {
+        span.columns[column] = (const double *)(archive->base + section->columnOffsets[column]);
+    }
+    span.count = (size_t)section->rowCount;
+    return span;
+}
+
+static size_t lowerBound(const int64_t *values, size_t count, int64_t value){
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (values[middle] < value) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+size_t DBTrackArchiveSpanLowerBound(DBTrackArchiveSpan span, int64_t time){
+    return lowerBound(span.timeOfApplicability, span.count, time);
+}
+
+static size_t sectionLowerBound(const DBTrackArchive *archive, const DBTrackArchiveSection *section, int64_t time){
+    // The index narrows the search to one stride of the time column, so a seek touches at most one or
+    // two pages of it however long the recording is.
+    const int64_t *index = (const int64_t *)(archive->base + section->indexOffset);
+    size_t block = lowerBound(index, (size_t)section->indexCount, time);
+    if (block == 0) {
+        return 0;
+    }
+    size_t start = (block - 1) * DBTrackArchiveIndexStride;
+    size_t end = block * DBTrackArchiveIndexStride;
+    if (end > section->rowCount) {
+        end = (size_t)section->rowCount;
+    }
+    const int64_t *times = (const int64_t *)(archive->base + section->timeOffset);
+    return start + lowerBound(times + start, end - start, time);
+}
+
+DBTrackArchiveSpan DBTrackArchiveGetTimeRange(const DBTrackArchive *archive, DBTrackArchiveTable table, int64_t startTime, int64_t endTime){
+    DBTrackArchiveSpan span = DBTrackArchiveGetTable(archive, table);
+    const DBTrackArchiveSection *section = &archive->sections[table];
+    size_t first = sectionLowerBound(archive, section, startTime);
+    size_t last = endTime == INT64_MAX ? span.count : sectionLowerBound(archive, section, endTime + 1);
+    if (last < first) {
+        last = first;
+    }
+
+    span.timeOfApplicability += first;
+    for (int column=0; column<DBTrackArchiveColumnCount; column++) {
+        span.columns[column] += first;
+    }
+    span.count = last - first;
+    return span;
+}
+
+#pragma mark - Converting
+
+typedef struct {
+    int64_t *times;
+    double *columns[DBTrackArchiveColumnCount];
+    size_t count;
+} DBTrackArchiveTableData;
+
+static void freeTableData(DBTrackArchiveTableData *data){
+    free(data->times);
+    for (int column=0; column<DBTrackArchiveColumnCount; column++) {
+        free(data->columns[column]);
+    }
+    memset(data, 0, sizeof(*data));
+}
+
+static int appendRow(DBTrackArchiveTableData *data, size_t *capacity, sqlite3_stmt *statement){
+    // Grow every column together by doubling.
+    if (data->count == *capacity) {
+        size_t newCapacity = *capacity == 0 ? 1024 : *capacity * 2;
+        int64_t *times = realloc(data->times, newCapacity * sizeof(int64_t));
+        if (times == NULL) {
+            return 0;
+        }
+        data->times = times;
+        for (int column=0; column<DBTrackArchiveColumnCount; column++) {
+            double *values = realloc(data->columns[column], newCapacity * sizeof(double));
+            if (values == NULL) {
+                return 0;
+            }
+            data->columns[column] = values;
+        }
+        *capacity = newCapacity;
+    }
+
+    data->times[data->count] = sqlite3_column_int64(statement, 0);
+    for (int column=0; column<DBTrackArchiveColumnCount; column++) {
+        int sourceColumn = column + 1;
+        data->columns[column][data->count] = sqlite3_column_type(statement, sourceColumn) == SQLITE_NULL ? NAN : sqlite3_column_double(statement, sourceColumn);
+    }
+    data->count++;
+    return 1;
+}
+
+static int loadTable(sqlite3 *database, DBTrackArchiveTable table, DBTrackArchiveTableData *data){
+    // A recording without the table gets an empty section.
+    sqlite3_stmt *statement;
+    if (sqlite3_prepare_v2(database, kSelectQueries[table], -1, &statement, NULL) != SQLITE_OK) {
+        sqlite3_finalize(statement);
+        return 1;
+    }
+
+    size_t capacity = 0;
+    int stepResult;
+    int succeeded = 1;
+    while (succeeded && (stepResult = sqlite3_step(statement)) == SQLITE_ROW) {
+        succeeded = appendRow(data, &capacity, statement);
+    }
+    if (succeeded && stepResult != SQLITE_DONE) {
+        fprintf(stderr, "DB Error: %s\n", sqlite3_errmsg(database));
+        succeeded = 0;
+    }
+    sqlite3_finalize(statement);
+    return succeeded;
+}
+
+static int writeArray(FILE *file, uint64_t *position, uint64_t offset, const void *values, size_t length){
+    // Pad up to the array's aligned offset, then write it.
+    static const uint8_t padding[DBTrackArchiveAlignment];
+    if (offset < *position || fwrite(padding, 1, (size_t)(offset - *position), file) != offset - *position) {
+        return 0;
+    }
+    if (length > 0 && fwrite(values, 1, length, file) != length) {
+        return 0;
+    }
+    *position = offset + length;
+    return 1;
+}
+
+static int writeArchive(FILE *file, DBTrackArchiveTableData *tables){
+    // Lay out every section's arrays after the section table.
+    DBTrackArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DBTrackArchiveMagic, sizeof(header.magic));
+    header.version = DBTrackArchiveVersion;
+    header.sectionCount = DBTrackArchiveTableCount;
+
+    DBTrackArchiveSection sections[DBTrackArchiveTableCount];
+    memset(sections, 0, sizeof(sections));
+    uint64_t offset = sizeof(header) + sizeof(sections);
+    for (int table=0; table<DBTrackArchiveTableCount; table++) {
+        DBTrackArchiveSection *section = &sections[table];
+        section->rowCount = tables[table].count;
+        section->indexCount = (section->rowCount + DBTrackArchiveIndexStride - 1) / DBTrackArchiveIndexStride;
+        section->timeOffset = alignedOffset(offset);
+        offset = section->timeOffset + section->rowCount * sizeof(int64_t);
+        for (int column=0; column<DBTrackArchiveColumnCount; column++) {
+            section->columnOffsets[column] = alignedOffset(offset);
+            offset = section->columnOffsets[column] + section->rowCount * sizeof(double);
+        }
+        section->indexOffset = alignedOffset(offset);
+        offset = section->indexOffset + section->indexCount * sizeof(int64_t);
+    }
+    header.fileSize = offset;
+
+    uint64_t position = 0;
+    int succeeded = writeArray(file, &position, 0, &header, sizeof(header))
+        && writeArray(file, &position, sizeof(header), sections, sizeof(sections));
+    for (int table=0; succeeded && table<DBTrackArchiveTableCount; table++) {
+        const DBTrackArchiveSection *section = &sections[table];
+        const DBTrackArchiveTableData *data = &tables[table];
+        succeeded = writeArray(file, &position, section->timeOffset, data->times, data->count * sizeof(int64_t));
+        for (int column=0; succeeded && column<DBTrackArchiveColumnCount; column++) {
+            succeeded = writeArray(file, &position, section->columnOffsets[column], data->columns[column], data->count * sizeof(double));
+        }
+        for (uint64_t block=0; succeeded && block<section->indexCount; block++) {
+            uint64_t entryOffset = section->indexOffset + block * sizeof(int64_t);
+            succeeded = writeArray(file, &position, entryOffset, &data->times[block * DBTrackArchiveIndexStride], sizeof(int64_t));
+        }
+    }
+    return succeeded && position == header.fileSize;
+}
+
+int DBTrackArchiveWriteFromDatabase(const char *databasePath, const char *archivePath){
+    sqlite3 *database;
+    if (sqlite3_open_v2(databasePath, &database, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
+        fprintf(stderr, "%s\n", sqlite3_errmsg(database));
+        sqlite3_close(database);
+        return -1;
+    }
+
+    DBTrackArchiveTableData tables[DBTrackArchiveTableCount];
+    memset(tables, 0, sizeof(tables));
+    int succeeded = 1;
+    for (int table=0; succeeded && table<DBTrackArchiveTableCount; table++) {
+        succeeded = loadTable(database, table, &tables[table]);
+    }
+    sqlite3_close(database);
+
+    // Write to a temporary file and rename it over the archive once it is complete.
+    size_t temporaryPathLength = strlen(archivePath) + 32;
+    char *temporaryPath = malloc(temporaryPathLength);
+    FILE *file = NULL;
+    if (succeeded && temporaryPath != NULL) {
+        snprintf(temporaryPath, temporaryPathLength, "%s.%ld.tmp", archivePath, (long)getpid());
+        file = fopen(temporaryPath, "wb");
+    }
+    succeeded = succeeded && file != NULL && writeArchive(file, tables);
+    if (file != NULL) {
+        succeeded = fclose(file) == 0 && succeeded;
+        succeeded = succeeded && rename(temporaryPath, archivePath) == 0;
+        if (!succeeded) {
+            unlink(temporaryPath);
+        }
+    }
+
+    free(temporaryPath);
+    for (int table=0; table<DBTrackArchiveTableCount; table++) {
+        freeTableData(&tables[table]);
+    }
+    return succeeded ? 0 : -1;
+}
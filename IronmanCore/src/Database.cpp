@@ -0,0 +1,131 @@
+//
+//  Database.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 08/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/Database.hpp"
+#include <cmath>
+#include <cstdio>
+#include <utility>
+
+namespace ironman {
+
+Database::~Database(){
+    close();
+}
+
+Database::Database(Database &&other) noexcept : _database(other._database){
+    other._database = nullptr;
+}
+
+Database &Database::operator=(Database &&other) noexcept{
+    if (this != &other) {
+        close();
+        _database = other._database;
+        other._database = nullptr;
+    }
+    return *this;
+}
+
+bool Database::open(const std::string &path, int flags){
+    close();
+    if (sqlite3_open_v2(path.c_str(), &_database, flags, nullptr) != SQLITE_OK) {
+        std::fprintf(stderr, "DB Error: %s\n", sqlite3_errmsg(_database));
+        close();
+        return false;
+    }
+    return true;
+}
+
+void Database::close(){
+    // close_v2 defers the close until any statement still alive is finalized.
+    if (_database != nullptr) {
+        sqlite3_close_v2(_database);
+        _database = nullptr;
+    }
+}
+
+bool Database::execute(const char *sql){
+    char *errorMessage = nullptr;
+    if (sqlite3_exec(_database, sql, nullptr, nullptr, &errorMessage) != SQLITE_OK) {
+        std::fprintf(stderr, "DB Error: %s\n", errorMessage != nullptr ? errorMessage : sqlite3_errmsg(_database));
+        sqlite3_free(errorMessage);
+        return false;
+    }
+    return true;
+}
+
+const char *Database::errorMessage() const{
+    return sqlite3_errmsg(_database);
+}
+
+Statement::Statement(Database &database, const char *sql){
+    if (sqlite3_prepare_v3(database.handle(), sql, -1, SQLITE_PREPARE_PERSISTENT, &_statement, nullptr) != SQLITE_OK) {
+        std::fprintf(stderr, "DB Error: %s\n", database.errorMessage());
+        sqlite3_finalize(_statement);
+        _statement = nullptr;
+    }
+}
+
+Statement::~Statement(){
+    sqlite3_finalize(_statement);
+}
+
+Statement::Statement(Statement &&other) noexcept : _statement(other._statement), _failed(other._failed){
+    other._statement = nullptr;
+}
+
+Statement &Statement::operator=(Statement &&other) noexcept{
+    if (this != &other) {
+        sqlite3_finalize(_statement);
+        _statement = other._statement;
+        _failed = other._failed;
+        other._statement = nullptr;
+    }
+    return *this;
+}
+
+bool Statement::bind(int index, int64_t value){
+    return sqlite3_bind_int64(_statement, index, value) == SQLITE_OK;
+}
+
+bool Statement::bind(int index, double value){
+    return sqlite3_bind_double(_statement, index, value) == SQLITE_OK;
+}
+
+bool Statement::step(){
+    int stepResult = sqlite3_step(_statement);
+    if (stepResult == SQLITE_ROW) {
+        return true;
+    }
+    if (stepResult != SQLITE_DONE) {
+        std::fprintf(stderr, "DB Error: %s\n", sqlite3_errmsg(sqlite3_db_handle(_statement)));
+        _failed = true;
+    }
+    return false;
+}
+
+void Statement::reset(){
+    sqlite3_reset(_statement);
+    _failed = false;
+}
+
+int Statement::columnCount() const{
+    return sqlite3_column_count(_statement);
+}
+
+int64_t Statement::int64Column(int column) const{
+    return sqlite3_column_int64(_statement, column);
+}
+
+double Statement::doubleColumn(int column) const{
+    if (sqlite3_column_type(_statement, column) == SQLITE_NULL) {
+        return NAN;
+    }
+    return sqlite3_column_double(_statement, column);
+}
+
+} // namespace ironman
@@ -0,0 +1,57 @@
+//
+//  DeadReckoning.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 12/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/DeadReckoning.hpp"
+#include "ironman/VectorMath.hpp"
+
+namespace ironman {
+
+// Degrees of latitude per knot-second: one nautical mile is one minute of arc.
+static const double kDegreesPerKnotSecond = 1.0 / (3600.0 * 60.0);
+
+// Restrict-qualified parameters, not locals, are what lets the compiler drop its aliasing checks.
+static void stepPositions(size_t count, double time, double horizon,
+                          const double *__restrict sampleTime, const double *__restrict latitude,
+                          const double *__restrict longitude, const double *__restrict altitude,
+                          const double *__restrict eastVelocity, const double *__restrict northVelocity,
+                          const double *__restrict verticalSpeed, const double *__restrict inverseCosLatitude,
+                          double *__restrict outLatitude, double *__restrict outLongitude, double *__restrict outAltitude){
+    // The age is clamped to [0, horizon] with selects, not branches, so the loop vectorizes; wrapDegrees
+    // keeps a target crossing the antimeridian within [-180, 180] without one either.
+    for (size_t i=0; i<count; i++) {
+        double age = time - sampleTime[i];
+        double step = age < 0 ? 0 : age;
+        step = step > horizon ? horizon : step;
+        double degrees = step * kDegreesPerKnotSecond;
+        outLatitude[i] = latitude[i] + northVelocity[i] * degrees;
+        outLongitude[i] = vectormath::wrapDegrees(longitude[i] + eastVelocity[i] * degrees * inverseCosLatitude[i]);
+        outAltitude[i] = altitude[i] + verticalSpeed[i] * (step / 60.0);
+    }
+}
+
+void DeadReckoningPredictor::predict(const TargetTable &targets, double time, PredictedTargets &predicted) const{
+    size_t count = targets.size();
+    predicted.latitude.resize(count);
+    predicted.longitude.resize(count);
+    predicted.altitude.resize(count);
+    predicted.status.resize(count);
+
+    stepPositions(count, time, _settings.stalenessHorizon, targets.sampleTime(), targets.latitude(), targets.longitude(),
+                  targets.altitude(), targets.eastVelocity(), targets.northVelocity(), targets.verticalSpeed(),
+                  targets.inverseCosLatitude(), predicted.latitude.data(), predicted.longitude.data(), predicted.altitude.data());
+
+    // Status in its own pass so the byte-wide stores do not hold back the double-wide loop above.
+    const double *sampleTime = targets.sampleTime();
+    for (size_t i=0; i<count; i++) {
+        double age = time - sampleTime[i];
+        int status = (age > _settings.coastAfter) + (age > _settings.stalenessHorizon);
+        predicted.status[i] = static_cast<TargetStatus>(status);
+    }
+}
+
+} // namespace ironman
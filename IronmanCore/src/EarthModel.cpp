@@ -0,0 +1,144 @@
+//
+//  EarthModel.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 22/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/EarthModel.hpp"
+#include <cmath>
+
+namespace ironman {
+namespace geodesy {
+
+constexpr double WGS84::kSemiMajorAxis;
+constexpr double WGS84::kFlattening;
+
+static const double kSemiMinorAxis = WGS84::kSemiMajorAxis * (1 - WGS84::kFlattening);
+// Second eccentricity squared, (a^2 - b^2) / b^2.
+static const double kEccentricity2 = (WGS84::kSemiMajorAxis * WGS84::kSemiMajorAxis - kSemiMinorAxis * kSemiMinorAxis)
+                                     / (kSemiMinorAxis * kSemiMinorAxis);
+static const int kMaxIterations = 100;
+
+// A latitude on the auxiliary sphere, kept as its sine and cosine.
+struct ReducedLatitude {
+    double sin;
+    double cos;
+};
+
+static ReducedLatitude reducedLatitude(double latitudeDegrees){
+    double tanReduced = (1 - WGS84::kFlattening) * std::tan(toRadians(latitudeDegrees));
+    double cosReduced = 1 / std::sqrt(1 + tanReduced * tanReduced);
+    return ReducedLatitude{tanReduced * cosReduced, cosReduced};
+}
+
+static double normalizedLongitude(double longitude){
+    // Wrap into [-180, 180).
+    return std::fmod(std::fmod(longitude + 180.0, 360.0) + 360.0, 360.0) - 180.0;
+}
+
+// Vincenty's series in u^2 for the geodesic's length on the ellipsoid against the auxiliary sphere.
+static void seriesCoefficients(double cos2Azimuth, double &a, double &b){
+    double u2 = cos2Azimuth * kEccentricity2;
+    a = 1 + u2 / 16384 * (4096 + u2 * (-768 + u2 * (320 - 175 * u2)));
+    b = u2 / 1024 * (256 + u2 * (-128 + u2 * (74 - 47 * u2)));
+}
+
+static double sigmaCorrection(double b, double sinSigma, double cosSigma, double cos2SigmaM){
+    double cos2SigmaM2 = cos2SigmaM * cos2SigmaM;
+    return b * sinSigma * (cos2SigmaM + b / 4 * (cosSigma * (-1 + 2 * cos2SigmaM2)
+                           - b / 6 * cos2SigmaM * (-3 + 4 * sinSigma * sinSigma) * (-3 + 4 * cos2SigmaM2)));
+}
+
+static void vincentyInverse(ReducedLatitude u1, double longitude1, GeoPoint point2, double &distance, double &course){
+    ReducedLatitude u2 = reducedLatitude(point2.latitude);
+    double l = toRadians(normalizedLongitude(point2.longitude - longitude1));
+    double lambda = l;
+    double sinLambda = 0, cosLambda = 1, sinSigma = 0, cosSigma = 1, sigma = 0, cos2Azimuth = 1, cos2SigmaM = 0;
+    for (int i=0; i<kMaxIterations; i++) {
+        sinLambda = std::sin(lambda);
+        cosLambda = std::cos(lambda);
+        double east = u2.cos * sinLambda;
+        double north = u1.cos * u2.sin - u1.sin * u2.cos * cosLambda;
+        sinSigma = std::sqrt(east * east + north * north);
+        if (sinSigma == 0) {
+            // Coincident points.
+            distance = 0;
+            course = 0;
+            return;
+        }
+        cosSigma = u1.sin * u2.sin + u1.cos * u2.cos * cosLambda;
+        sigma = std::atan2(sinSigma, cosSigma);
+        double sinAzimuth = u1.cos * u2.cos * sinLambda / sinSigma;
+        cos2Azimuth = 1 - sinAzimuth * sinAzimuth;
+        // Zero on an equatorial line.
+        cos2SigmaM = cos2Azimuth != 0 ? cosSigma - 2 * u1.sin * u2.sin / cos2Azimuth : 0;
+        double c = WGS84::kFlattening / 16 * cos2Azimuth * (4 + WGS84::kFlattening * (4 - 3 * cos2Azimuth));
+        double previous = lambda;
+        lambda = l + (1 - c) * WGS84::kFlattening * sinAzimuth
+                 * (sigma + c * sinSigma * (cos2SigmaM + c * cosSigma * (-1 + 2 * cos2SigmaM * cos2SigmaM)));
+        if (std::fabs(lambda - previous) < 1e-12) {
+            break;
+        }
+    }
+    double a, b;
+    seriesCoefficients(cos2Azimuth, a, b);
+    double meters = kSemiMinorAxis * a * (sigma - sigmaCorrection(b, sinSigma, cosSigma, cos2SigmaM));
+    distance = meters / kMetersPerNauticalMile;
+    course = toDegrees(std::atan2(u2.cos * sinLambda, u1.cos * u2.sin - u1.sin * u2.cos * cosLambda));
+    course = course < 0 ? course + 360.0 : course;
+}
+
+void WGS84::inverse(GeoPoint point1, GeoPoint point2, double &distance, double &course){
+    vincentyInverse(reducedLatitude(point1.latitude), point1.longitude, point2, distance, course);
+}
+
+GeoPoint WGS84::pointOnRadial(GeoPoint point, double radialDegrees, double distanceNauticalMiles){
+    ReducedLatitude u1 = reducedLatitude(point.latitude);
+    double radial = toRadians(radialDegrees);
+    double sinRadial = std::sin(radial);
+    double cosRadial = std::cos(radial);
+    double sigma1 = std::atan2(u1.sin / u1.cos, cosRadial);
+    double sinAzimuth = u1.cos * sinRadial;
+    double cos2Azimuth = 1 - sinAzimuth * sinAzimuth;
+    double a, b;
+    seriesCoefficients(cos2Azimuth, a, b);
+
+    double first = distanceNauticalMiles * kMetersPerNauticalMile / (kSemiMinorAxis * a);
+    double sigma = first;
+    double sinSigma = 0, cosSigma = 1, cos2SigmaM = 0;
+    for (int i=0; i<kMaxIterations; i++) {
+        cos2SigmaM = std::cos(2 * sigma1 + sigma);
+        sinSigma = std::sin(sigma);
+        cosSigma = std::cos(sigma);
+        double previous = sigma;
+        sigma = first + sigmaCorrection(b, sinSigma, cosSigma, cos2SigmaM);
+        if (std::fabs(sigma - previous) < 1e-12) {
+            break;
+        }
+    }
+    sinSigma = std::sin(sigma);
+    cosSigma = std::cos(sigma);
+    cos2SigmaM = std::cos(2 * sigma1 + sigma);
+
+    double across = u1.sin * sinSigma - u1.cos * cosSigma * cosRadial;
+    double latitude = std::atan2(u1.sin * cosSigma + u1.cos * sinSigma * cosRadial,
+                                 (1 - kFlattening) * std::sqrt(sinAzimuth * sinAzimuth + across * across));
+    double lambda = std::atan2(sinSigma * sinRadial, u1.cos * cosSigma - u1.sin * sinSigma * cosRadial);
+    double c = kFlattening / 16 * cos2Azimuth * (4 + kFlattening * (4 - 3 * cos2Azimuth));
+    double l = lambda - (1 - c) * kFlattening * sinAzimuth
+               * (sigma + c * sinSigma * (cos2SigmaM + c * cosSigma * (-1 + 2 * cos2SigmaM * cos2SigmaM)));
+    return GeoPoint{toDegrees(latitude), normalizedLongitude(point.longitude + toDegrees(l))};
+}
+
+void WGS84::rangesAndCourses(GeoPoint origin, const double *latitudes, const double *longitudes, double *ranges,
+                             double *courses, size_t count){
+    ReducedLatitude u1 = reducedLatitude(origin.latitude);
+    for (size_t i=0; i<count; i++) {
+        vincentyInverse(u1, origin.longitude, GeoPoint{latitudes[i], longitudes[i]}, ranges[i], courses[i]);
+    }
+}
+
+} // namespace geodesy
+} // namespace ironman
@@ -0,0 +1,75 @@
+//
+//  Geodesy.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 08/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/Geodesy.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ironman {
+namespace geodesy {
+
+static double normalizedLongitude(double longitude){
+    // Wrap into [-180, 180).
+    return std::fmod(std::fmod(longitude + 180.0, 360.0) + 360.0, 360.0) - 180.0;
+}
+
+double distanceRadians(GeoPoint point1, GeoPoint point2){
+    double latitude1 = toRadians(point1.latitude);
+    double latitude2 = toRadians(point2.latitude);
+    double sinHalfLatitude = std::sin((latitude2 - latitude1) / 2);
+    double sinHalfLongitude = std::sin(toRadians(point2.longitude - point1.longitude) / 2);
+    double haversine = sinHalfLatitude * sinHalfLatitude + std::cos(latitude1) * std::cos(latitude2) * sinHalfLongitude * sinHalfLongitude;
+    return 2 * std::asin(std::sqrt(std::min(haversine, 1.0)));
+}
+
+double nauticalMilesBetween(GeoPoint point1, GeoPoint point2){
+    return distanceRadians(point1, point2) * kNauticalMilesPerRadian;
+}
+
+double courseDegrees(GeoPoint point1, GeoPoint point2){
+    double latitude1 = toRadians(point1.latitude);
+    double latitude2 = toRadians(point2.latitude);
+    double deltaLongitude = toRadians(point2.longitude - point1.longitude);
+    double y = std::sin(deltaLongitude) * std::cos(latitude2);
+    double x = std::cos(latitude1) * std::sin(latitude2) - std::sin(latitude1) * std::cos(latitude2) * std::cos(deltaLongitude);
+    double course = toDegrees(std::atan2(y, x));
+    return course < 0 ? course + 360.0 : course;
+}
+
+GeoPoint pointOnRadial(GeoPoint point, double radialDegrees, double distanceNauticalMiles){
+    double latitude = toRadians(point.latitude);
+    double radial = toRadians(radialDegrees);
+    double distance = distanceNauticalMiles / kNauticalMilesPerRadian;
+    double sinLatitude2 = std::sin(latitude) * std::cos(distance) + std::cos(latitude) * std::sin(distance) * std::cos(radial);
+    double latitude2 = std::asin(std::max(-1.0, std::min(1.0, sinLatitude2)));
+    double deltaLongitude = std::atan2(std::sin(radial) * std::sin(distance) * std::cos(latitude),
+                                       std::cos(distance) - std::sin(latitude) * sinLatitude2);
+    return GeoPoint{toDegrees(latitude2), normalizedLongitude(point.longitude + toDegrees(deltaLongitude))};
+}
+
+GeoPoint pointBetween(GeoPoint point1, GeoPoint point2, double fraction){
+    double distance = distanceRadians(point1, point2);
+    if (distance == 0) {
+        return point1;
+    }
+
+    // Interpolate the two unit vectors along the great circle and convert back.
+    double latitude1 = toRadians(point1.latitude);
+    double longitude1 = toRadians(point1.longitude);
+    double latitude2 = toRadians(point2.latitude);
+    double longitude2 = toRadians(point2.longitude);
+    double a = std::sin((1 - fraction) * distance) / std::sin(distance);
+    double b = std::sin(fraction * distance) / std::sin(distance);
+    double x = a * std::cos(latitude1) * std::cos(longitude1) + b * std::cos(latitude2) * std::cos(longitude2);
+    double y = a * std::cos(latitude1) * std::sin(longitude1) + b * std::cos(latitude2) * std::sin(longitude2);
+    double z = a * std::sin(latitude1) + b * std::sin(latitude2);
+    return GeoPoint{toDegrees(std::atan2(z, std::sqrt(x * x + y * y))), toDegrees(std::atan2(y, x))};
+}
+
+} // namespace geodesy
+} // namespace ironman
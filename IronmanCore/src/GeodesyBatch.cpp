@@ -0,0 +1,122 @@
+//
+//  GeodesyBatch.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 20/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/GeodesyBatch.hpp"
+#include "ironman/VectorMath.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ironman {
+namespace geodesy {
+
+using namespace vectormath;
+
+#pragma mark - Kernels
+
+static void distanceKernel(const double *__restrict latitudes1, const double *__restrict longitudes1,
+                           const double *__restrict latitudes2, const double *__restrict longitudes2,
+                           double *__restrict distances, double scale, size_t count){
+    for (size_t i=0; i<count; i++) {
+        double latitude1 = latitudes1[i] * (kPi / 180.0);
+        double latitude2 = latitudes2[i] * (kPi / 180.0);
+        double deltaLongitude = wrapRadians((longitudes2[i] - longitudes1[i]) * (kPi / 180.0));
+        double sinHalfLatitude = sinReduced((latitude2 - latitude1) * 0.5);
+        double sinHalfLongitude = sinReduced(deltaLongitude * 0.5);
+        double haversine = sinHalfLatitude * sinHalfLatitude + cosReduced(latitude1) * cosReduced(latitude2) * sinHalfLongitude * sinHalfLongitude;
+        haversine = std::min(haversine, 1.0);
+        distances[i] = 2.0 * atan2Reduced(std::sqrt(haversine), std::sqrt(1.0 - haversine)) * scale;
+    }
+}
+
+void distancesRadians(const double *latitudes1, const double *longitudes1, const double *latitudes2,
+                      const double *longitudes2, double *distances, size_t count){
+    distanceKernel(latitudes1, longitudes1, latitudes2, longitudes2, distances, 1.0, count);
+}
+
+void nauticalMilesBetween(const double *latitudes1, const double *longitudes1, const double *latitudes2,
+                          const double *longitudes2, double *distances, size_t count){
+    distanceKernel(latitudes1, longitudes1, latitudes2, longitudes2, distances, kNauticalMilesPerRadian, count);
+}
+
+static void courseKernel(const double *__restrict latitudes1, const double *__restrict longitudes1,
+                         const double *__restrict latitudes2, const double *__restrict longitudes2,
+                         double *__restrict courses, size_t count){
+    for (size_t i=0; i<count; i++) {
+        double latitude1 = latitudes1[i] * (kPi / 180.0);
+        double latitude2 = latitudes2[i] * (kPi / 180.0);
+        double deltaLongitude = wrapRadians((longitudes2[i] - longitudes1[i]) * (kPi / 180.0));
+        double cosLatitude2 = cosReduced(latitude2);
+        double y = sinReduced(deltaLongitude) * cosLatitude2;
+        double x = cosReduced(latitude1) * sinReduced(latitude2) - sinReduced(latitude1) * cosLatitude2 * cosReduced(deltaLongitude);
+        double course = atan2Reduced(y, x) * (180.0 / kPi);
+        courses[i] = course < 0 ? course + 360.0 : course;
+    }
+}
+
+void coursesDegrees(const double *latitudes1, const double *longitudes1, const double *latitudes2,
+                    const double *longitudes2, double *courses, size_t count){
+    courseKernel(latitudes1, longitudes1, latitudes2, longitudes2, courses, count);
+}
+
+static void radialKernel(const double *__restrict latitudes, const double *__restrict longitudes,
+                         const double *__restrict radials, const double *__restrict distances,
+                         double *__restrict latitudesOut, double *__restrict longitudesOut, size_t count){
+    for (size_t i=0; i<count; i++) {
+        double latitude = latitudes[i] * (kPi / 180.0);
+        double radial = wrapRadians(radials[i] * (kPi / 180.0));
+        double distance = wrapRadians(distances[i] / kNauticalMilesPerRadian);
+        double sinLatitude = sinReduced(latitude);
+        double cosLatitude = cosReduced(latitude);
+        double sinDistance = sinReduced(distance);
+        double cosDistance = cosReduced(distance);
+        double sinLatitude2 = sinLatitude * cosDistance + cosLatitude * sinDistance * cosReduced(radial);
+        sinLatitude2 = std::max(std::min(sinLatitude2, 1.0), -1.0);
+        double latitude2 = atan2Reduced(sinLatitude2, std::sqrt(1.0 - sinLatitude2 * sinLatitude2));
+        double deltaLongitude = atan2Reduced(sinReduced(radial) * sinDistance * cosLatitude, cosDistance - sinLatitude * sinLatitude2);
+        latitudesOut[i] = latitude2 * (180.0 / kPi);
+        longitudesOut[i] = wrapDegrees(longitudes[i] + deltaLongitude * (180.0 / kPi));
+    }
+}
+
+void pointsOnRadial(const double *latitudes, const double *longitudes, const double *radials, const double *distances,
+                    double *latitudesOut, double *longitudesOut, size_t count){
+    radialKernel(latitudes, longitudes, radials, distances, latitudesOut, longitudesOut, count);
+}
+
+static void rangeCourseKernel(double latitude1, double sinLatitude1, double cosLatitude1, double longitude1,
+                              const double *__restrict latitudes, const double *__restrict longitudes,
+                              double *__restrict ranges, double *__restrict courses, size_t count){
+    for (size_t i=0; i<count; i++) {
+        double latitude2 = latitudes[i] * (kPi / 180.0);
+        double deltaLongitude = wrapRadians((longitudes[i] - longitude1) * (kPi / 180.0));
+        double sinLatitude2 = sinReduced(latitude2);
+        double cosLatitude2 = cosReduced(latitude2);
+        double sinDeltaLongitude = sinReduced(deltaLongitude);
+        double cosDeltaLongitude = cosReduced(deltaLongitude);
+
+        double sinHalfLatitude = sinReduced((latitude2 - latitude1) * 0.5);
+        double sinHalfLongitude = sinReduced(deltaLongitude * 0.5);
+        double haversine = sinHalfLatitude * sinHalfLatitude + cosLatitude1 * cosLatitude2 * sinHalfLongitude * sinHalfLongitude;
+        haversine = std::min(haversine, 1.0);
+        ranges[i] = 2.0 * atan2Reduced(std::sqrt(haversine), std::sqrt(1.0 - haversine)) * kNauticalMilesPerRadian;
+
+        double y = sinDeltaLongitude * cosLatitude2;
+        double x = cosLatitude1 * sinLatitude2 - sinLatitude1 * cosLatitude2 * cosDeltaLongitude;
+        double course = atan2Reduced(y, x) * (180.0 / kPi);
+        courses[i] = course < 0 ? course + 360.0 : course;
+    }
+}
+
+void rangesAndCourses(GeoPoint origin, const double *latitudes, const double *longitudes, double *ranges,
+                      double *courses, size_t count){
+    double latitude = toRadians(origin.latitude);
+    rangeCourseKernel(latitude, std::sin(latitude), std::cos(latitude), origin.longitude, latitudes, longitudes, ranges, courses, count);
+}
+
+} // namespace geodesy
+} // namespace ironman
@@ -0,0 +1,384 @@
+//
+//  KalmanFilter.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 15/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/KalmanFilter.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ironman {
+
+// Spread of what a single position leaves unknown: 600 knots, 6 degrees/s of turn, 6000 feet/min.
+static const double kInitialSpeedSigma = 600.0 / 3600.0;
+static const double kInitialTurnRateSigma = geodesy::toRadians(6.0);
+static const double kInitialClimbSigma = 100.0;
+
+// Below this turn rate, in radians per second, the constant turn uses its straight-line limit.
+static const double kStraightTurnRate = 1e-9;
+
+// White-noise acceleration on one axis, position at index p and velocity at index v.
+template <int Size>
+static void addAccelerationNoise(Matrix<Size, Size> &noise, int p, int v, double variance, double dt){
+    double dt2 = dt * dt;
+    noise(p, p) += variance * dt2 * dt / 3.0;
+    noise(p, v) += variance * dt2 / 2.0;
+    noise(v, p) += variance * dt2 / 2.0;
+    noise(v, v) += variance * dt;
+}
+
+#pragma mark - Constant velocity
+
+ConstantVelocityModel::ConstantVelocityModel(const SmootherSettings &settings)
+    : accelerationVariance(settings.accelerationNoise * settings.accelerationNoise) {
+}
+
+Vector<4> ConstantVelocityModel::transition(const Vector<4> &state, double dt, Matrix<4, 4> &jacobian) const{
+    jacobian = Matrix<4, 4>::identity();
+    jacobian(0, 2) = dt;
+    jacobian(1, 3) = dt;
+    Vector<4> next = state;
+    next(0, 0) += state(2, 0) * dt;
+    next(1, 0) += state(3, 0) * dt;
+    return next;
+}
+
+Matrix<4, 4> ConstantVelocityModel::processNoise(double dt) const{
+    Matrix<4, 4> noise = Matrix<4, 4>::zero();
+    addAccelerationNoise(noise, 0, 2, accelerationVariance, dt);
+    addAccelerationNoise(noise, 1, 3, accelerationVariance, dt);
+    return noise;
+}
+
+Matrix<4, 4> ConstantVelocityModel::initialCovariance(double measurementVariance) const{
+    Matrix<4, 4> covariance = Matrix<4, 4>::zero();
+    covariance(0, 0) = measurementVariance;
+    covariance(1, 1) = measurementVariance;
+    covariance(2, 2) = kInitialSpeedSigma * kInitialSpeedSigma;
+    covariance(3, 3) = kInitialSpeedSigma * kInitialSpeedSigma;
+    return covariance;
+}
+
+#pragma mark - Constant turn
+
+ConstantTurnModel::ConstantTurnModel(const SmootherSettings &settings)
+    : accelerationVariance(settings.accelerationNoise * settings.accelerationNoise),
+      turnRateVariance(geodesy::toRadians(settings.turnRateNoise) * geodesy::toRadians(settings.turnRateNoise)) {
+}
+
+Vector<5> ConstantTurnModel::transition(const Vector<5> &state, double dt, Matrix<5, 5> &jacobian) const{
+    double east = state(2, 0);
+    double north = state(3, 0);
+    double rate = state(4, 0);
+    double angle = rate * dt;
+    double s = std::sin(angle);
+    double c = std::cos(angle);
+
+    // Position advance as a function of the velocity, a = sin(wt)/w and b = (1 - cos(wt))/w, with the
+    // derivatives of both by w. Near zero they take their limits, t and w t^2 / 2.
+    double a;
+    double b;
+    double da;
+    double db;
+    if (std::fabs(rate) > kStraightTurnRate) {
+        a = s / rate;
+        b = (1.0 - c) / rate;
+        da = (dt * c - a) / rate;
+        db = (dt * s - b) / rate;
+    }
+    else {
+        a = dt;
+        b = rate * dt * dt / 2.0;
+        da = -rate * dt * dt * dt / 3.0;
+        db = dt * dt / 2.0;
+    }
+
+    Vector<5> next;
+    next(0, 0) = state(0, 0) + east * a - north * b;
+    next(1, 0) = state(1, 0) + east * b + north * a;
+    next(2, 0) = east * c - north * s;
+    next(3, 0) = east * s + north * c;
+    next(4, 0) = rate;
+
+    jacobian = Matrix<5, 5>::identity();
+    jacobian(0, 2) = a;
+    jacobian(0, 3) = -b;
+    jacobian(0, 4) = east * da - north * db;
+    jacobian(1, 2) = b;
+    jacobian(1, 3) = a;
+    jacobian(1, 4) = east * db + north * da;
+    jacobian(2, 2) = c;
+    jacobian(2, 3) = -s;
+    jacobian(2, 4) = -dt * (east * s + north * c);
+    jacobian(3, 2) = s;
+    jacobian(3, 3) = c;
+    jacobian(3, 4) = dt * (east * c - north * s);
+    return next;
+}
+
+Matrix<5, 5> ConstantTurnModel::processNoise(double dt) const{
+    Matrix<5, 5> noise = Matrix<5, 5>::zero();
+    addAccelerationNoise(noise, 0, 2, accelerationVariance, dt);
+    addAccelerationNoise(noise, 1, 3, accelerationVariance, dt);
+    noise(4, 4) = turnRateVariance * dt;
+    return noise;
+}
+
+Matrix<5, 5> ConstantTurnModel::initialCovariance(double measurementVariance) const{
+    Matrix<5, 5> covariance = Matrix<5, 5>::zero();
+    covariance(0, 0) = measurementVariance;
+    covariance(1, 1) = measurementVariance;
+    covariance(2, 2) = kInitialSpeedSigma * kInitialSpeedSigma;
+    covariance(3, 3) = kInitialSpeedSigma * kInitialSpeedSigma;
+    covariance(4, 4) = kInitialTurnRateSigma * kInitialTurnRateSigma;
+    return covariance;
+}
+
+#pragma mark - Altitude
+
+AltitudeModel::AltitudeModel(const SmootherSettings &settings)
+    : accelerationVariance(settings.climbAccelerationNoise * settings.climbAccelerationNoise) {
+}
+
+Vector<2> AltitudeModel::transition(const Vector<2> &state, double dt, Matrix<2, 2> &jacobian) const{
+    jacobian = Matrix<2, 2>::identity();
+    jacobian(0, 1) = dt;
+    Vector<2> next = state;
+    next(0, 0) += state(1, 0) * dt;
+    return next;
+}
+
+Matrix<2, 2> AltitudeModel::processNoise(double dt) const{
+    Matrix<2, 2> noise = Matrix<2, 2>::zero();
+    addAccelerationNoise(noise, 0, 1, accelerationVariance, dt);
+    return noise;
+}
+
+Matrix<2, 2> AltitudeModel::initialCovariance(double measurementVariance) const{
+    Matrix<2, 2> covariance = Matrix<2, 2>::zero();
+    covariance(0, 0) = measurementVariance;
+    covariance(1, 1) = kInitialClimbSigma * kInitialClimbSigma;
+    return covariance;
+}
+
+#pragma mark - Filter
+
+template <typename Model>
+KalmanFilter<Model>::KalmanFilter(const Model &model, double measurementNoise)
+    : _model(model), _measurementVariance(measurementNoise * measurementNoise) {
+}
+
+template <typename Model>
+void KalmanFilter<Model>::predict(double time){
+    double dt = time - _time;
+    if (!_initialized || !(dt > 0)) {
+        return;
+    }
+    Covariance jacobian;
+    _state = _model.transition(_state, dt, jacobian);
+    _covariance = symmetrize(jacobian * _covariance * jacobian.transpose() + _model.processNoise(dt));
+    _time = time;
+}
+
+template <typename Model>
+void KalmanFilter<Model>::update(double time, const Measurement &measurement){
+    if (!_initialized) {
+        _state = State::zero();
+        for (int i=0; i<kMeasurements; i++) {
+            _state(i, 0) = measurement(i, 0);
+        }
+        _covariance = _model.initialCovariance(_measurementVariance);
+        _time = time;
+        _initialized = true;
+        return;
+    }
+    predict(time);
+
+    // The measured states are the first kMeasurements, so H P is the top rows of P and P H^T its left
+    // columns. Solving S K^T = H P gives the gain without inverting S.
+    Matrix<kMeasurements, kMeasurements> innovationCovariance;
+    Matrix<kMeasurements, kStates> gainTranspose;
+    Measurement innovation;
+    for (int i=0; i<kMeasurements; i++) {
+        innovation(i, 0) = measurement(i, 0) - _state(i, 0);
+        for (int j=0; j<kMeasurements; j++) {
+            innovationCovariance(i, j) = _covariance(i, j) + (i == j ? _measurementVariance : 0);
+        }
+        for (int j=0; j<kStates; j++) {
+            gainTranspose(i, j) = _covariance(i, j);
+        }
+    }
+    Matrix<kMeasurements, kStates> measuredRows = gainTranspose;
+    if (!choleskySolve(innovationCovariance, gainTranspose)) {
+        return;
+    }
+    Matrix<kStates, kMeasurements> gain = gainTranspose.transpose();
+    _state = _state + gain * innovation;
+    _covariance = symmetrize(_covariance - gain * measuredRows);
+}
+
+template <typename Model>
+void KalmanFilter<Model>::smooth(const Model &model, const double *times, Step *steps, size_t count){
+    if (count < 2) {
+        return;
+    }
+    for (size_t k=count-1; k-- > 0;) {
+        // Prediction from step k to k + 1, as the forward pass made it.
+        double dt = times[k + 1] - times[k];
+        Covariance jacobian = Covariance::identity();
+        State predicted = steps[k].state;
+        Covariance predictedCovariance = steps[k].covariance;
+        if (dt > 0) {
+            predicted = model.transition(steps[k].state, dt, jacobian);
+            predictedCovariance = symmetrize(jacobian * steps[k].covariance * jacobian.transpose() + model.processNoise(dt));
+        }
+
+        // Gain G = P_k F^T P_pred^-1, from P_pred G^T = F P_k; P_k is symmetric.
+        Covariance gainTranspose = jacobian * steps[k].covariance;
+        if (!choleskySolve(predictedCovariance, gainTranspose)) {
+            continue;
+        }
+        Covariance gain = gainTranspose.transpose();
+        steps[k].state = steps[k].state + gain * (steps[k + 1].state - predicted);
+        steps[k].covariance = symmetrize(steps[k].covariance + gain * (steps[k + 1].covariance - predictedCovariance) * gainTranspose);
+    }
+}
+
+#pragma mark - Track smoother
+
+template <typename HorizontalModel>
+TrackSmoother<HorizontalModel>::TrackSmoother(const SmootherSettings &settings)
+    : _horizontal(HorizontalModel(settings), settings.positionNoise),
+      _vertical(AltitudeModel(settings), settings.altitudeNoise) {
+}
+
+template <typename HorizontalModel>
+void TrackSmoother<HorizontalModel>::reset(){
+    _horizontal.reset();
+    _vertical.reset();
+    _anchored = false;
+}
+
+template <typename HorizontalModel>
+void TrackSmoother<HorizontalModel>::anchor(const TrackSample &sample){
+    _origin = geodesy::GeoPoint{sample.latitude, sample.longitude};
+    _milesPerDegreeEast = 60.0 * std::cos(geodesy::toRadians(sample.latitude));
+    _anchored = true;
+}
+
+template <typename HorizontalModel>
+void TrackSmoother<HorizontalModel>::measure(const TrackSample &sample){
+    double time = static_cast<double>(sample.timeOfApplicability);
+    if (std::isfinite(sample.latitude) && std::isfinite(sample.longitude)) {
+        if (!_anchored) {
+            anchor(sample);
+        }
+        double deltaLongitude = sample.longitude - _origin.longitude;
+        deltaLongitude -= 360.0 * std::round(deltaLongitude / 360.0);
+        Vector<2> position;
+        position(0, 0) = deltaLongitude * _milesPerDegreeEast;
+        position(1, 0) = (sample.latitude - _origin.latitude) * 60.0;
+        _horizontal.update(time, position);
+    }
+    else {
+        _horizontal.predict(time);
+    }
+
+    if (std::isfinite(sample.altitude)) {
+        Vector<1> altitude;
+        altitude(0, 0) = sample.altitude;
+        _vertical.update(time, altitude);
+    }
+    else {
+        _vertical.predict(time);
+    }
+}
+
+template <typename HorizontalModel>
+TrackState TrackSmoother<HorizontalModel>::stateAt(double time, const typename KalmanFilter<HorizontalModel>::State &horizontal,
+                                                   const typename KalmanFilter<AltitudeModel>::State &vertical) const{
+    double latitude = _origin.latitude + horizontal(1, 0) / 60.0;
+    double longitude = _origin.longitude + horizontal(0, 0) / _milesPerDegreeEast;
+    longitude -= 360.0 * std::round(longitude / 360.0);
+
+    // Frame east is scaled for the origin's latitude; true east velocity is for the target's.
+    double east = horizontal(2, 0) * std::cos(geodesy::toRadians(latitude)) * 60.0 / _milesPerDegreeEast;
+    double north = horizontal(3, 0);
+    double track = geodesy::toDegrees(std::atan2(east, north));
+    return TrackState{time, latitude, longitude, vertical(0, 0), std::hypot(east, north) * 3600.0,
+                      track < 0 ? track + 360.0 : track, vertical(1, 0) * 60.0};
+}
+
+template <typename HorizontalModel>
+TrackState TrackSmoother<HorizontalModel>::update(const TrackSample &sample){
+    measure(sample);
+    double time = static_cast<double>(sample.timeOfApplicability);
+    TrackState state = stateAt(time, _horizontal.state(), _vertical.state());
+    if (!_horizontal.initialized()) {
+        state.latitude = state.longitude = state.groundSpeed = state.trackAngle = NAN;
+    }
+    if (!_vertical.initialized()) {
+        state.altitude = state.verticalSpeed = NAN;
+    }
+    return state;
+}
+
+template <typename HorizontalModel>
+void TrackSmoother<HorizontalModel>::smooth(const TrackColumns &track, std::vector<TrackState> &smoothed){
+    size_t count = track.size();
+    reset();
+    _times.resize(count);
+    _horizontalSteps.resize(count);
+    _verticalSteps.resize(count);
+    smoothed.resize(count);
+
+    // Forward, keeping every filtered step from the one that starts each filter.
+    size_t horizontalStart = count;
+    size_t verticalStart = count;
+    for (size_t i=0; i<count; i++) {
+        measure(track[i]);
+        _times[i] = static_cast<double>(track.timeOfApplicability[i]);
+        if (_horizontal.initialized()) {
+            horizontalStart = std::min(horizontalStart, i);
+            _horizontalSteps[i] = _horizontal.step();
+        }
+        if (_vertical.initialized()) {
+            verticalStart = std::min(verticalStart, i);
+            _verticalSteps[i] = _vertical.step();
+        }
+    }
+
+    // Backward.
+    if (horizontalStart < count) {
+        KalmanFilter<HorizontalModel>::smooth(_horizontal.model(), _times.data() + horizontalStart,
+                                              _horizontalSteps.data() + horizontalStart, count - horizontalStart);
+    }
+    if (verticalStart < count) {
+        KalmanFilter<AltitudeModel>::smooth(_vertical.model(), _times.data() + verticalStart,
+                                            _verticalSteps.data() + verticalStart, count - verticalStart);
+    }
+
+    for (size_t i=0; i<count; i++) {
+        typename KalmanFilter<HorizontalModel>::State horizontal = i >= horizontalStart ? _horizontalSteps[i].state
+                                                                                         : KalmanFilter<HorizontalModel>::State::zero();
+        KalmanFilter<AltitudeModel>::State vertical = i >= verticalStart ? _verticalSteps[i].state : KalmanFilter<AltitudeModel>::State::zero();
+        smoothed[i] = stateAt(_times[i], horizontal, vertical);
+        if (i < horizontalStart) {
+            smoothed[i].latitude = smoothed[i].longitude = smoothed[i].groundSpeed = smoothed[i].trackAngle = NAN;
+        }
+        if (i < verticalStart) {
+            smoothed[i].altitude = smoothed[i].verticalSpeed = NAN;
+        }
+    }
+}
+
+template class KalmanFilter<ConstantVelocityModel>;
+template class KalmanFilter<ConstantTurnModel>;
+template class KalmanFilter<AltitudeModel>;
+template class TrackSmoother<ConstantVelocityModel>;
+template class TrackSmoother<ConstantTurnModel>;
+
+} // namespace ironman
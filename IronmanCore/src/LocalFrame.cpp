@@ -0,0 +1,112 @@
+//
+//  LocalFrame.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 21/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/LocalFrame.hpp"
+#include "ironman/VectorMath.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ironman {
+
+using namespace vectormath;
+
+// The earth radius in nautical miles and in feet.
+static const double kRadius = geodesy::kNauticalMilesPerRadian;
+static const double kRadiusFeet = geodesy::kNauticalMilesPerRadian * geodesy::kFeetPerNauticalMile;
+
+#pragma mark - Kernels
+
+// Positions are unit vectors in the earth frame turned so the anchor is at longitude 0: x towards
+// the anchor's meridian, y east and z north. The tangent plane's north is then
+// cos(anchor) z - sin(anchor) x, and cos(anchor) x + sin(anchor) z is the cosine of the distance.
+static void toLocalKernel(double sinOrigin, double cosOrigin, double originLongitude, double originRadius,
+                          const double *__restrict latitudes, const double *__restrict longitudes,
+                          const double *__restrict altitudes, double *__restrict east,
+                          double *__restrict north, double *__restrict up, size_t count){
+    for (size_t i=0; i<count; i++) {
+        double latitude = latitudes[i] * (kPi / 180.0);
+        double deltaLongitude = wrapRadians((longitudes[i] - originLongitude) * (kPi / 180.0));
+        double cosLatitude = cosReduced(latitude);
+        double x = cosLatitude * cosReduced(deltaLongitude);
+        double y = cosLatitude * sinReduced(deltaLongitude);
+        double z = sinReduced(latitude);
+        east[i] = y * kRadius;
+        north[i] = (cosOrigin * z - sinOrigin * x) * kRadius;
+        up[i] = (kRadiusFeet + altitudes[i]) * (cosOrigin * x + sinOrigin * z) - originRadius;
+    }
+}
+
+static void toGeodeticKernel(double sinOrigin, double cosOrigin, double originLongitude, double originRadius,
+                             const double *__restrict east, const double *__restrict north,
+                             const double *__restrict up, double *__restrict latitudes,
+                             double *__restrict longitudes, double *__restrict altitudes, size_t count){
+    for (size_t i=0; i<count; i++) {
+        double y = east[i] * (1.0 / kRadius);
+        double planeNorth = north[i] * (1.0 / kRadius);
+        // The ground position is on the near side of the sphere. A point at or past the horizon, one
+        // earth radius out on the plane, is held just inside it so the altitude stays finite.
+        double cosDistance = std::sqrt(std::max(1.0 - y * y - planeNorth * planeNorth, 1e-24));
+        double x = cosOrigin * cosDistance - sinOrigin * planeNorth;
+        double z = sinOrigin * cosDistance + cosOrigin * planeNorth;
+        latitudes[i] = atan2Reduced(z, std::sqrt(x * x + y * y)) * (180.0 / kPi);
+        longitudes[i] = wrapDegrees(originLongitude + atan2Reduced(y, x) * (180.0 / kPi));
+        altitudes[i] = (up[i] + originRadius) / cosDistance - kRadiusFeet;
+    }
+}
+
+#pragma mark - Frame
+
+void LocalFrame::anchor(geodesy::GeoPoint origin, double altitude){
+    double latitude = geodesy::toRadians(origin.latitude);
+    _origin = origin;
+    _originAltitude = altitude;
+    _sinLatitude = std::sin(latitude);
+    _cosLatitude = std::cos(latitude);
+    _anchored = true;
+}
+
+bool LocalFrame::update(geodesy::GeoPoint ownship, double altitude){
+    // Great circle distance rather than the distance on the plane, which is R sin(d / R) and comes back
+    // to 0 towards the antipode, as after a seek or a switch of recording.
+    if (_anchored && geodesy::nauticalMilesBetween(_origin, ownship) <= _settings.reanchorDistance) {
+        return false;
+    }
+    anchor(ownship, altitude);
+    return true;
+}
+
+void LocalFrame::toLocal(geodesy::GeoPoint position, double altitude, double &east, double &north, double &up) const{
+    toLocal(&position.latitude, &position.longitude, &altitude, &east, &north, &up, 1);
+}
+
+void LocalFrame::toGeodetic(double east, double north, double up, geodesy::GeoPoint &position, double &altitude) const{
+    toGeodetic(&east, &north, &up, &position.latitude, &position.longitude, &altitude, 1);
+}
+
+void LocalFrame::toLocal(const double *latitudes, const double *longitudes, const double *altitudes, double *east,
+                         double *north, double *up, size_t count) const{
+    toLocalKernel(_sinLatitude, _cosLatitude, _origin.longitude, kRadiusFeet + _originAltitude, latitudes, longitudes,
+                  altitudes, east, north, up, count);
+}
+
+void LocalFrame::toGeodetic(const double *east, const double *north, const double *up, double *latitudes,
+                            double *longitudes, double *altitudes, size_t count) const{
+    toGeodeticKernel(_sinLatitude, _cosLatitude, _origin.longitude, kRadiusFeet + _originAltitude, east, north, up,
+                     latitudes, longitudes, altitudes, count);
+}
+
+void LocalFrame::toLocal(const TargetTable &targets, LocalPositions &positions) const{
+    size_t count = targets.size();
+    positions.east.resize(count);
+    positions.north.resize(count);
+    positions.up.resize(count);
+    toLocal(targets.latitude(), targets.longitude(), targets.altitude(), positions.east.data(), positions.north.data(),
+            positions.up.data(), count);
+}
+
+} // namespace ironman
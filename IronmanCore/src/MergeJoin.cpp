@@ -0,0 +1,98 @@
+//
+//  MergeJoin.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 10/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/MergeJoin.hpp"
+#include "ironman/Geodesy.hpp"
+#include <cmath>
+#include <cstdlib>
+
+namespace ironman {
+
+MergeJoin::MergeJoin(TrackSource &ownship, TrackSource &traffic, int64_t toleranceSeconds)
+    : _ownship(ownship), _traffic(traffic), _tolerance(toleranceSeconds < 0 ? 0 : toleranceSeconds) {}
+
+void MergeJoin::readTraffic(int64_t untilTime){
+    // Keep one sample of lookahead so the stream is never read past the window.
+    while (!_trafficExhausted) {
+        if (!_hasPendingTraffic) {
+            _hasPendingTraffic = _traffic.next(_pendingTraffic);
+            if (!_hasPendingTraffic) {
+                _trafficExhausted = true;
+                return;
+            }
+        }
+        if (_pendingTraffic.timeOfApplicability > untilTime) {
+            return;
+        }
+        _windows[_pendingTraffic.trackId].push_back(_pendingTraffic);
+        _hasPendingTraffic = false;
+    }
+}
+
+bool MergeJoin::next(){
+    if (!_ownship.next(_ownshipSample)) {
+        return false;
+    }
+    int64_t time = _ownshipSample.timeOfApplicability;
+    readTraffic(time + _tolerance);
+
+    _targets.clear();
+    for (auto window = _windows.begin(); window != _windows.end();) {
+        // Samples older than the window can never match this or a later tick.
+        std::vector<TrackSample> &samples = window->second;
+        size_t firstKept = 0;
+        while (firstKept < samples.size() && samples[firstKept].timeOfApplicability < time - _tolerance) {
+            firstKept++;
+        }
+        samples.erase(samples.begin(), samples.begin() + firstKept);
+        if (samples.empty()) {
+            window = _windows.erase(window);
+            continue;
+        }
+
+        // The window holds a handful of samples at most, so a scan finds the nearest.
+        const TrackSample *nearest = &samples[0];
+        for (const TrackSample &sample : samples) {
+            if (std::llabs(sample.timeOfApplicability - time) < std::llabs(nearest->timeOfApplicability - time)) {
+                nearest = &sample;
+            }
+        }
+        _targets.push_back(relativeGeometry(_ownshipSample, *nearest, time));
+        ++window;
+    }
+    return true;
+}
+
+RelativeGeometry relativeGeometry(const TrackSample &ownship, const TrackSample &target, int64_t time){
+    // Move the target along its recorded velocity from its sample time to the tick.
+    double deltaTime = static_cast<double>(time - target.timeOfApplicability);
+    geodesy::GeoPoint targetPosition{target.latitude, target.longitude};
+    if (deltaTime != 0) {
+        targetPosition = geodesy::pointOnRadial(targetPosition, target.trackAngle, target.groundSpeed * deltaTime / 3600.0);
+    }
+    double targetAltitude = target.altitude + target.verticalSpeed * deltaTime / 60.0;
+
+    geodesy::GeoPoint ownshipPosition{ownship.latitude, ownship.longitude};
+    RelativeGeometry geometry;
+    geometry.trackId = target.trackId;
+    geometry.sampleTime = target.timeOfApplicability;
+    geometry.range = geodesy::nauticalMilesBetween(ownshipPosition, targetPosition);
+    geometry.bearing = geodesy::courseDegrees(ownshipPosition, targetPosition);
+    geometry.relativeAltitude = targetAltitude - ownship.altitude;
+
+    // Closure is the relative velocity projected onto the line of sight, negated.
+    double bearing = geodesy::toRadians(geometry.bearing);
+    double ownshipTrack = geodesy::toRadians(ownship.trackAngle);
+    double targetTrack = geodesy::toRadians(target.trackAngle);
+    double relativeEast = target.groundSpeed * std::sin(targetTrack) - ownship.groundSpeed * std::sin(ownshipTrack);
+    double relativeNorth = target.groundSpeed * std::cos(targetTrack) - ownship.groundSpeed * std::cos(ownshipTrack);
+    geometry.closureRate = -(relativeEast * std::sin(bearing) + relativeNorth * std::cos(bearing));
+    return geometry;
+}
+
+} // namespace ironman
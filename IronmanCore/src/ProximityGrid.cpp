@@ -0,0 +1,207 @@
+//
+//  ProximityGrid.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 14/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/ProximityGrid.hpp"
+#include <cmath>
+#include <cstdint>
+
+namespace ironman {
+
+// A cell is its signed column and row packed into one key.
+static uint64_t cellKey(int32_t column, int32_t row){
+    return (static_cast<uint64_t>(static_cast<uint32_t>(column)) << 32) | static_cast<uint32_t>(row);
+}
+
+static int32_t cellColumn(uint64_t key){
+    return static_cast<int32_t>(static_cast<uint32_t>(key >> 32));
+}
+
+static int32_t cellRow(uint64_t key){
+    return static_cast<int32_t>(static_cast<uint32_t>(key));
+}
+
+// A column or row index, kept one inside the int32 range so its neighbours are too. NaN fails both
+// comparisons and lands on the lowest index rather than reaching the conversion.
+static int32_t cellIndex(double position, double separation){
+    double index = std::floor(position / separation);
+    const double lowest = static_cast<double>(INT32_MIN) + 1;
+    const double highest = static_cast<double>(INT32_MAX) - 1;
+    index = index >= lowest ? index : lowest;
+    index = index <= highest ? index : highest;
+    return static_cast<int32_t>(index);
+}
+
+ProximityGrid::ProximityGrid(geodesy::GeoPoint origin, double separation)
+    : _origin(origin), _milesPerDegreeEast(60.0 * std::cos(geodesy::toRadians(origin.latitude))),
+      _separation(separation), _separation2(separation * separation) {
+    // Written so NaN fails the comparison and takes the minimum too.
+    _separation = _separation >= 0.01 ? _separation : 0.01;
+    _separation2 = _separation * _separation;
+}
+
+void ProximityGrid::project(geodesy::GeoPoint position, double &east, double &north) const{
+    double deltaLongitude = position.longitude - _origin.longitude;
+    if (deltaLongitude > 180.0) {
+        deltaLongitude -= 360.0;
+    }
+    else if (deltaLongitude < -180.0) {
+        deltaLongitude += 360.0;
+    }
+    east = deltaLongitude * _milesPerDegreeEast;
+    north = (position.latitude - _origin.latitude) * 60.0;
+}
+
+uint64_t ProximityGrid::cellOf(double east, double north) const{
+    return cellKey(cellIndex(east, _separation), cellIndex(north, _separation));
+}
+
+void ProximityGrid::update(int64_t trackId, geodesy::GeoPoint position){
+    double east;
+    double north;
+    project(position, east, north);
+    uint64_t key = cellOf(east, north);
+
+    auto existing = _locations.find(trackId);
+    if (existing == _locations.end()) {
+        Cell &cell = _cells[key];
+        _locations.emplace(trackId, Location{key, &cell, cell.size()});
+        cell.push_back(Member{trackId, east, north});
+        return;
+    }
+
+    // Most updates stay in the same cell and only move the position.
+    Location &location = existing->second;
+    if (location.key == key) {
+        Member &member = (*location.cell)[location.slot];
+        member.east = east;
+        member.north = north;
+        return;
+    }
+    detach(location);
+    Cell &cell = _cells[key];
+    location = Location{key, &cell, cell.size()};
+    cell.push_back(Member{trackId, east, north});
+}
+
+void ProximityGrid::update(const TargetTable &targets){
+    const int64_t *trackId = targets.trackId();
+    const double *latitude = targets.latitude();
+    const double *longitude = targets.longitude();
+    for (size_t i=0; i<targets.size(); i++) {
+        update(trackId[i], geodesy::GeoPoint{latitude[i], longitude[i]});
+    }
+}
+
+void ProximityGrid::detach(const Location &location){
+    // Move the cell's last member into the hole, and drop the cell once it is empty.
+    Cell &cell = *location.cell;
+    if (location.slot + 1 != cell.size()) {
+        cell[location.slot] = cell.back();
+        _locations[cell[location.slot].trackId].slot = location.slot;
+    }
+    cell.pop_back();
+    if (cell.empty()) {
+        _cells.erase(location.key);
+    }
+}
+
+bool ProximityGrid::remove(int64_t trackId){
+    auto existing = _locations.find(trackId);
+    if (existing == _locations.end()) {
+        return false;
+    }
+    detach(existing->second);
+    _locations.erase(existing);
+    return true;
+}
+
+void ProximityGrid::clear(){
+    _cells.clear();
+    _locations.clear();
+}
+
+void ProximityGrid::neighbors(double east, double north, int64_t exclude, std::vector<int64_t> &found) const{
+    uint64_t center = cellOf(east, north);
+    int32_t column = cellColumn(center);
+    int32_t row = cellRow(center);
+    for (int32_t dx=-1; dx<=1; dx++) {
+        for (int32_t dy=-1; dy<=1; dy++) {
+            auto cell = _cells.find(cellKey(column + dx, row + dy));
+            if (cell == _cells.end()) {
+                continue;
+            }
+            for (const Member &member : cell->second) {
+                double deltaEast = member.east - east;
+                double deltaNorth = member.north - north;
+                if (member.trackId != exclude && deltaEast * deltaEast + deltaNorth * deltaNorth <= _separation2) {
+                    found.push_back(member.trackId);
+                }
+            }
+        }
+    }
+}
+
+void ProximityGrid::neighbors(int64_t trackId, std::vector<int64_t> &found) const{
+    auto existing = _locations.find(trackId);
+    if (existing == _locations.end()) {
+        return;
+    }
+    const Location &location = existing->second;
+    const Member &member = (*location.cell)[location.slot];
+    neighbors(member.east, member.north, trackId, found);
+}
+
+void ProximityGrid::neighbors(geodesy::GeoPoint position, std::vector<int64_t> &found) const{
+    double east;
+    double north;
+    project(position, east, north);
+    // No track id is excluded: INT64_MIN is never a real track.
+    neighbors(east, north, INT64_MIN, found);
+}
+
+void ProximityGrid::pairs(std::vector<ProximityPair> &found) const{
+    found.clear();
+
+    // Each cell is paired with itself and the four neighbours ahead of it, so every pair of adjacent
+    // cells is visited exactly once.
+    static const int32_t kForward[4][2] = {{1, -1}, {1, 0}, {1, 1}, {0, 1}};
+    auto test = [&](const Member &a, const Member &b){
+        double deltaEast = a.east - b.east;
+        double deltaNorth = a.north - b.north;
+        double range2 = deltaEast * deltaEast + deltaNorth * deltaNorth;
+        if (range2 <= _separation2) {
+            bool ordered = a.trackId < b.trackId;
+            found.push_back(ProximityPair{ordered ? a.trackId : b.trackId, ordered ? b.trackId : a.trackId, std::sqrt(range2)});
+        }
+    };
+
+    for (const auto &cell : _cells) {
+        const Cell &members = cell.second;
+        for (size_t i=0; i<members.size(); i++) {
+            for (size_t j=i+1; j<members.size(); j++) {
+                test(members[i], members[j]);
+            }
+        }
+
+        int32_t column = cellColumn(cell.first);
+        int32_t row = cellRow(cell.first);
+        for (const auto &offset : kForward) {
+            auto other = _cells.find(cellKey(column + offset[0], row + offset[1]));
+            if (other == _cells.end()) {
+                continue;
+            }
+            for (const Member &member : members) {
+                for (const Member &otherMember : other->second) {
+                    test(member, otherMember);
+                }
+            }
+        }
+    }
+}
+
+} // namespace ironman
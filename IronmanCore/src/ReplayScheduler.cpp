@@ -0,0 +1,115 @@
+//
+//  ReplayScheduler.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 19/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/ReplayScheduler.hpp"
+#include <algorithm>
+
+namespace ironman {
+
+#pragma mark - Clock
+
+void ReplayClock::play(double timestamp){
+    if (!_playing) {
+        _anchorTimestamp = timestamp;
+        _playing = true;
+    }
+}
+
+void ReplayClock::pause(double timestamp){
+    if (_playing) {
+        _anchorTime = time(timestamp);
+        _playing = false;
+    }
+}
+
+void ReplayClock::setRate(double rate, double timestamp){
+    _anchorTime = time(timestamp);
+    _anchorTimestamp = timestamp;
+    _rate = std::max(rate, 0.0);
+}
+
+void ReplayClock::seek(double time, double timestamp){
+    _anchorTime = time;
+    _anchorTimestamp = timestamp;
+}
+
+#pragma mark - Scheduler
+
+ReplayScheduler::ReplayScheduler(const TrackColumns &recording, const ReplaySettings &settings)
+    : _recording(recording), _settings(settings),
+      _startTime(recording.empty() ? 0.0 : static_cast<double>(recording.timeOfApplicability.front())),
+      _endTime(recording.empty() ? 0.0 : static_cast<double>(recording.timeOfApplicability.back())),
+      _time(_startTime) {
+    _settings.maxSamplesPerFrame = std::max<size_t>(_settings.maxSamplesPerFrame, 1);
+    _clock.seek(_startTime, 0);
+}
+
+// The first sample after time, searching from from on.
+size_t ReplayScheduler::firstAfter(double time, size_t from) const{
+    const std::vector<int64_t> &times = _recording.timeOfApplicability;
+    return static_cast<size_t>(std::upper_bound(times.begin() + from, times.end(), time, [](double value, int64_t sampleTime){
+        return value < static_cast<double>(sampleTime);
+    }) - times.begin());
+}
+
+void ReplayScheduler::seek(double time, double timestamp){
+    _clock.seek(std::min(std::max(time, _startTime), _endTime), timestamp);
+    _seeked = true;
+}
+
+ReplayFrame ReplayScheduler::advance(double timestamp){
+    double time = std::max(_clock.time(timestamp), _startTime);
+    // Only a seek goes backwards. A timestamp earlier than the last command's would otherwise read as a
+    // rewind and rebuild every target.
+    if (!_seeked) {
+        time = std::max(time, _time);
+    }
+    if (time >= _endTime) {
+        time = _endTime;
+        _clock.pause(timestamp);
+        _clock.seek(_endTime, timestamp);
+    }
+
+    ReplayFrame frame;
+    frame.time = time;
+    frame.rebuild = _seeked;
+    frame.skipped = 0;
+    if (frame.rebuild) {
+        // Every sample at or after the start of the window; the ones at its very start count.
+        const std::vector<int64_t> &times = _recording.timeOfApplicability;
+        double windowStart = time - _settings.rebuildWindow;
+        frame.begin = static_cast<size_t>(std::lower_bound(times.begin(), times.end(), windowStart, [](int64_t sampleTime, double value){
+            return static_cast<double>(sampleTime) < value;
+        }) - times.begin());
+        frame.end = firstAfter(time, frame.begin);
+    }
+    else {
+        frame.begin = _cursor;
+        frame.end = firstAfter(time, _cursor);
+    }
+    if (frame.end - frame.begin > _settings.maxSamplesPerFrame) {
+        frame.skipped = frame.end - frame.begin - _settings.maxSamplesPerFrame;
+        frame.begin += frame.skipped;
+    }
+
+    _cursor = frame.end;
+    _time = time;
+    _seeked = false;
+    return frame;
+}
+
+void applyFrame(const TrackColumns &recording, const ReplayFrame &frame, TargetTable &targets){
+    if (frame.rebuild) {
+        targets.clear();
+    }
+    for (size_t i=frame.begin; i<frame.end; i++) {
+        targets.update(recording[i]);
+    }
+}
+
+} // namespace ironman
@@ -0,0 +1,216 @@
+//
+//  RouteTessellator.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 23/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/RouteTessellator.hpp"
+#include "ironman/VectorMath.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace ironman {
+namespace geodesy {
+
+struct UnitVector {
+    double x;
+    double y;
+    double z;
+};
+
+static UnitVector unitVector(GeoPoint point){
+    double latitude = toRadians(point.latitude);
+    double longitude = toRadians(point.longitude);
+    return UnitVector{std::cos(latitude) * std::cos(longitude), std::cos(latitude) * std::sin(longitude), std::sin(latitude)};
+}
+
+static double angleBetween(UnitVector a, UnitVector b){
+    double x = a.y * b.z - a.z * b.y;
+    double y = a.z * b.x - a.x * b.z;
+    double z = a.x * b.y - a.y * b.x;
+    return std::atan2(std::sqrt(x * x + y * y + z * z), a.x * b.x + a.y * b.y + a.z * b.z);
+}
+
+// Points a fraction step apart along the great circle of angle between the two unit vectors, by
+// spherical interpolation.
+// The index is an int because SSE2 converts 32-bit integers to doubles a vector at a time but not
+// 64-bit ones.
+static void interpolateKernel(UnitVector from, UnitVector to, double angle, double step, int count,
+                              GeoPoint *__restrict points){
+    double inverseSin = 1.0 / std::sin(angle);
+    for (int i=0; i<count; i++) {
+        double fraction = i * step;
+        double a = vectormath::sinReduced((1.0 - fraction) * angle) * inverseSin;
+        double b = vectormath::sinReduced(fraction * angle) * inverseSin;
+        double x = a * from.x + b * to.x;
+        double y = a * from.y + b * to.y;
+        double z = a * from.z + b * to.z;
+        points[i].latitude = vectormath::atan2Reduced(z, std::sqrt(x * x + y * y)) * (180.0 / kPi);
+        points[i].longitude = vectormath::atan2Reduced(y, x) * (180.0 / kPi);
+    }
+}
+
+size_t legNodeCount(GeoPoint from, GeoPoint to, double milesPerNode){
+    double nodes = std::ceil(nauticalMilesBetween(from, to) / milesPerNode);
+    // Bounded before the conversion: a zero spacing makes it infinite, and NaN fails the test.
+    if (!(nodes >= 1) || !(milesPerNode > 0)) {
+        return 2;
+    }
+    return static_cast<size_t>(std::min(nodes, static_cast<double>(INT_MAX - 1))) + 1;
+}
+
+void tessellateLeg(GeoPoint from, GeoPoint to, size_t nodeCount, GeoPoint *points){
+    UnitVector start = unitVector(from);
+    UnitVector end = unitVector(to);
+    double angle = angleBetween(start, end);
+    if (angle > 1e-12) {
+        interpolateKernel(start, end, angle, 1.0 / static_cast<double>(nodeCount - 1), static_cast<int>(nodeCount), points);
+    }
+    else {
+        std::fill(points, points + nodeCount, from);
+    }
+    // The ends are the waypoints themselves, not their round trip through unit vectors.
+    points[0] = from;
+    points[nodeCount - 1] = to;
+}
+
+void tessellateRoute(const GeoPoint *waypoints, size_t waypointCount, size_t pointCount, GeoPoint *points){
+    if (waypointCount == 0 || pointCount == 0) {
+        return;
+    }
+    if (waypointCount == 1) {
+        std::fill(points, points + pointCount, waypoints[0]);
+        return;
+    }
+    double total = 0;
+    for (size_t i=1; i<waypointCount; i++) {
+        total += angleBetween(unitVector(waypoints[i - 1]), unitVector(waypoints[i]));
+    }
+    // Walks the legs alongside the points, without scratch space.
+    size_t leg = 1;
+    double legBegin = 0;
+    double legLength = angleBetween(unitVector(waypoints[0]), unitVector(waypoints[1]));
+    for (size_t i=0; i<pointCount; i++) {
+        double along = pointCount > 1 ? total * static_cast<double>(i) / static_cast<double>(pointCount - 1) : 0;
+        while (leg + 1 < waypointCount && along > legBegin + legLength) {
+            legBegin += legLength;
+            leg++;
+            legLength = angleBetween(unitVector(waypoints[leg - 1]), unitVector(waypoints[leg]));
+        }
+        double fraction = legLength > 0 ? std::min((along - legBegin) / legLength, 1.0) : 0.0;
+        points[i] = pointBetween(waypoints[leg - 1], waypoints[leg], fraction);
+    }
+    points[0] = waypoints[0];
+    points[pointCount - 1] = waypoints[waypointCount - 1];
+}
+
+} // namespace geodesy
+
+#pragma mark - Tessellator
+
+RouteTessellator::RouteTessellator(TessellationSettings settings) : _settings(settings) {
+    // Written so NaN fails the comparison and takes the minimum too.
+    _settings.milesPerNode = _settings.milesPerNode >= 0.01 ? _settings.milesPerNode : 0.01;
+    _settings.maxNodesPerLeg = std::max<size_t>(_settings.maxNodesPerLeg, 2);
+}
+
+size_t RouteTessellator::nodeCount(size_t leg) const{
+    size_t count = geodesy::legNodeCount(_waypoints[leg], _waypoints[leg + 1], _settings.milesPerNode);
+    return std::max<size_t>(std::min(count, _settings.maxNodesPerLeg), 2);
+}
+
+void RouteTessellator::markChanged(size_t begin, size_t end){
+    if (_changedBegin == _changedEnd) {
+        _changedBegin = begin;
+        _changedEnd = end;
+    }
+    else {
+        _changedBegin = std::min(_changedBegin, begin);
+        _changedEnd = std::max(_changedEnd, end);
+    }
+}
+
+void RouteTessellator::setWaypoints(const geodesy::GeoPoint *waypoints, size_t count){
+    _waypoints.assign(waypoints, waypoints + count);
+    _legStarts.assign(count, 0);
+    for (size_t leg=0; leg+1<count; leg++) {
+        _legStarts[leg + 1] = _legStarts[leg] + nodeCount(leg) - 1;
+    }
+    _points.resize(count > 0 ? _legStarts.back() + 1 : 0);
+    for (size_t leg=0; leg+1<count; leg++) {
+        geodesy::tessellateLeg(_waypoints[leg], _waypoints[leg + 1], _legStarts[leg + 1] - _legStarts[leg] + 1,
+                               &_points[_legStarts[leg]]);
+        _legsTessellated++;
+    }
+    if (count == 1) {
+        _points[0] = _waypoints[0];
+    }
+    markChanged(0, _points.size());
+}
+
+void RouteTessellator::moveWaypoint(size_t index, geodesy::GeoPoint position){
+    if (index >= _waypoints.size()) {
+        return;
+    }
+    _waypoints[index] = position;
+    if (_waypoints.size() == 1) {
+        _points[0] = position;
+        markChanged(0, 1);
+        return;
+    }
+
+    // The legs either side of the waypoint, and the span of points from the first one's start to the
+    // last one's end.
+    size_t firstLeg = index > 0 ? index - 1 : 0;
+    size_t lastLeg = std::min(index, _waypoints.size() - 2);
+    size_t begin = _legStarts[firstLeg];
+    size_t oldEnd = _legStarts[lastLeg + 1];
+    size_t counts[2];
+    size_t newEnd = begin;
+    for (size_t leg=firstLeg; leg<=lastLeg; leg++) {
+        counts[leg - firstLeg] = nodeCount(leg);
+        newEnd += counts[leg - firstLeg] - 1;
+    }
+    if (newEnd > oldEnd) {
+        _points.insert(_points.begin() + static_cast<ptrdiff_t>(oldEnd), newEnd - oldEnd, geodesy::GeoPoint{0, 0});
+    }
+    else if (newEnd < oldEnd) {
+        _points.erase(_points.begin() + static_cast<ptrdiff_t>(newEnd), _points.begin() + static_cast<ptrdiff_t>(oldEnd));
+    }
+    for (size_t leg=firstLeg; leg<=lastLeg; leg++) {
+        _legStarts[leg + 1] = _legStarts[leg] + counts[leg - firstLeg] - 1;
+    }
+    for (size_t i=lastLeg+2; i<_legStarts.size(); i++) {
+        _legStarts[i] = _legStarts[i] + newEnd - oldEnd;
+    }
+
+    for (size_t leg=firstLeg; leg<=lastLeg; leg++) {
+        geodesy::tessellateLeg(_waypoints[leg], _waypoints[leg + 1], counts[leg - firstLeg], &_points[_legStarts[leg]]);
+        _legsTessellated++;
+    }
+    // When the counts changed, every point after the legs moved too.
+    markChanged(begin, newEnd == oldEnd ? newEnd + 1 : _points.size());
+}
+
+void RouteTessellator::clear(){
+    _waypoints.clear();
+    _points.clear();
+    _legStarts.clear();
+    clearChanges();
+}
+
+size_t RouteTessellator::copyPoints(geodesy::GeoPoint *points, size_t capacity) const{
+    size_t count = std::min(capacity, _points.size());
+    std::copy(_points.begin(), _points.begin() + static_cast<ptrdiff_t>(count), points);
+    return count;
+}
+
+void RouteTessellator::clearChanges(){
+    _changedBegin = 0;
+    _changedEnd = 0;
+}
+
+} // namespace ironman
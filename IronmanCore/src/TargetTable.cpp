@@ -0,0 +1,118 @@
+//
+//  TargetTable.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 12/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/TargetTable.hpp"
+#include "ironman/Geodesy.hpp"
+#include <cmath>
+
+namespace ironman {
+
+size_t TargetTable::update(const TrackSample &sample){
+    size_t row;
+    auto existing = _rows.find(sample.trackId);
+    if (existing != _rows.end()) {
+        row = existing->second;
+    }
+    else {
+        row = _trackId.size();
+        _rows.emplace(sample.trackId, row);
+        _trackId.push_back(sample.trackId);
+        _sampleTime.push_back(0);
+        _latitude.push_back(0);
+        _longitude.push_back(0);
+        _altitude.push_back(0);
+        _groundSpeed.push_back(0);
+        _trackAngle.push_back(0);
+        _verticalSpeed.push_back(0);
+        _eastVelocity.push_back(0);
+        _northVelocity.push_back(0);
+        _inverseCosLatitude.push_back(1);
+    }
+
+    _sampleTime[row] = static_cast<double>(sample.timeOfApplicability);
+    _latitude[row] = sample.latitude;
+    _longitude[row] = sample.longitude;
+    _altitude[row] = sample.altitude;
+    _groundSpeed[row] = sample.groundSpeed;
+    _trackAngle[row] = sample.trackAngle;
+    _verticalSpeed[row] = sample.verticalSpeed;
+
+    // A target with no recorded velocity stands still rather than poisoning every kernel with NaN.
+    double track = geodesy::toRadians(sample.trackAngle);
+    bool hasVelocity = std::isfinite(track) && std::isfinite(sample.groundSpeed);
+    _eastVelocity[row] = hasVelocity ? sample.groundSpeed * std::sin(track) : 0;
+    _northVelocity[row] = hasVelocity ? sample.groundSpeed * std::cos(track) : 0;
+    if (!std::isfinite(sample.verticalSpeed)) {
+        _verticalSpeed[row] = 0;
+    }
+
+    // Clamp near the poles, where a degree of longitude shrinks to nothing.
+    double cosLatitude = std::cos(geodesy::toRadians(sample.latitude));
+    _inverseCosLatitude[row] = 1.0 / std::fmax(cosLatitude, 1e-6);
+    return row;
+}
+
+bool TargetTable::remove(int64_t trackId){
+    auto existing = _rows.find(trackId);
+    if (existing == _rows.end()) {
+        return false;
+    }
+
+    // Move the last row into the hole.
+    size_t row = existing->second;
+    size_t last = _trackId.size() - 1;
+    _rows.erase(existing);
+    if (row != last) {
+        _trackId[row] = _trackId[last];
+        _sampleTime[row] = _sampleTime[last];
+        _latitude[row] = _latitude[last];
+        _longitude[row] = _longitude[last];
+        _altitude[row] = _altitude[last];
+        _groundSpeed[row] = _groundSpeed[last];
+        _trackAngle[row] = _trackAngle[last];
+        _verticalSpeed[row] = _verticalSpeed[last];
+        _eastVelocity[row] = _eastVelocity[last];
+        _northVelocity[row] = _northVelocity[last];
+        _inverseCosLatitude[row] = _inverseCosLatitude[last];
+        _rows[_trackId[row]] = row;
+    }
+    _trackId.pop_back();
+    _sampleTime.pop_back();
+    _latitude.pop_back();
+    _longitude.pop_back();
+    _altitude.pop_back();
+    _groundSpeed.pop_back();
+    _trackAngle.pop_back();
+    _verticalSpeed.pop_back();
+    _eastVelocity.pop_back();
+    _northVelocity.pop_back();
+    _inverseCosLatitude.pop_back();
+    return true;
+}
+
+void TargetTable::clear(){
+    _trackId.clear();
+    _sampleTime.clear();
+    _latitude.clear();
+    _longitude.clear();
+    _altitude.clear();
+    _groundSpeed.clear();
+    _trackAngle.clear();
+    _verticalSpeed.clear();
+    _eastVelocity.clear();
+    _northVelocity.clear();
+    _inverseCosLatitude.clear();
+    _rows.clear();
+}
+
+size_t TargetTable::rowOf(int64_t trackId) const{
+    auto existing = _rows.find(trackId);
+    return existing != _rows.end() ? existing->second : _trackId.size();
+}
+
+} // namespace ironman
@@ -0,0 +1,177 @@
+//
+//  TileProjection.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 24/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/TileProjection.hpp"
+#include "ironman/VectorMath.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ironman {
+namespace tiles {
+
+using namespace vectormath;
+
+static const double kDegreesToRadians = kPi / 180.0;
+static const uint64_t kCoordinateMask = (1ULL << 28) - 1;
+// Degrees of latitude in each polar cap.
+static const double kCapHeight = 90.0 - kMercatorLimit;
+
+// For non-negative x.
+static inline double floorOf(double x){
+    double rounded = roundToInteger(x);
+    return rounded > x ? rounded - 1.0 : rounded;
+}
+
+// A double holding an integer below 2^52, as the integer: the bits of x + 2^52 below the exponent.
+static inline uint64_t integerBits(double x){
+    double biased = x + 4503599627370496.0;
+    uint64_t bits;
+    std::memcpy(&bits, &biased, sizeof(bits));
+    return bits & 0x000FFFFFFFFFFFFFULL;
+}
+
+// Mercator y as a fraction of the map's height down from the top.
+static inline double mercatorFraction(double latitude){
+    double clamped = std::min(std::max(latitude, -kMercatorLimit), kMercatorLimit);
+    double s = sinReduced(clamped * kDegreesToRadians);
+    return 0.5 - logPositive((1.0 + s) / (1.0 - s)) * (0.25 / kPi);
+}
+
+static double fractionLatitude(double fraction){
+    return geodesy::toDegrees(std::atan(std::sinh(kPi * (1.0 - 2.0 * fraction))));
+}
+
+// Rows at level above northRows lie wholly north of 80 degrees, and rows from southRows down wholly
+// south of -80.
+struct RegionRows {
+    double northRows;
+    double southRows;
+};
+
+static RegionRows regionRows(double scale){
+    double northFraction = mercatorFraction(kRegionLimit);
+    return RegionRows{northFraction * scale, (1.0 - northFraction) * scale};
+}
+
+void toMercator(const double *__restrict latitudes, const double *__restrict longitudes, double *__restrict x,
+                double *__restrict y, size_t count){
+    for (size_t i=0; i<count; i++) {
+        double clamped = std::min(std::max(latitudes[i], -kMercatorLimit), kMercatorLimit);
+        double s = sinReduced(clamped * kDegreesToRadians);
+        x[i] = longitudes[i] * (kDegreesToRadians * kMercatorRadius);
+        y[i] = logPositive((1.0 + s) / (1.0 - s)) * (0.5 * kMercatorRadius);
+    }
+}
+
+void fromMercator(const double *__restrict x, const double *__restrict y, double *__restrict latitudes,
+                  double *__restrict longitudes, size_t count){
+    for (size_t i=0; i<count; i++) {
+        // Latitude is the Gudermannian, atan(sinh(y / R)).
+        double e = expReduced(y[i] * (1.0 / kMercatorRadius));
+        latitudes[i] = atan2Reduced(e - 1.0 / e, 2.0) * (180.0 / kPi);
+        longitudes[i] = x[i] * (180.0 / (kPi * kMercatorRadius));
+    }
+}
+
+void tileUids(const double *__restrict latitudes, const double *__restrict longitudes, int level,
+              uint64_t *__restrict uids, size_t count){
+    if (level <= 0) {
+        std::fill(uids, uids + count, (uint64_t)TileRegion::Root << 62);
+        return;
+    }
+    level = std::min(level, kMaxLevel);
+    double scale = std::ldexp(1.0, level);
+    double last = scale - 1.0;
+    RegionRows rows = regionRows(scale);
+    double levelBits = (double)level * (double)(1ULL << 28);
+    for (size_t i=0; i<count; i++) {
+        double latitude = latitudes[i];
+        double column = floorOf((wrapDegrees(longitudes[i]) + 180.0) * (scale / 360.0));
+        column = std::min(column, last);
+        double row = std::min(floorOf(mercatorFraction(latitude) * scale), last);
+
+        bool north = latitude > kMercatorLimit;
+        bool south = latitude < -kMercatorLimit;
+        double capDepth = north ? 90.0 - latitude : -kMercatorLimit - latitude;
+        double capRow = std::min(std::max(floorOf(capDepth * (scale / kCapHeight)), 0.0), last);
+
+        double region = row + 1.0 <= rows.northRows ? 2.0 : (row >= rows.southRows ? 3.0 : 1.0);
+        region = north ? 2.0 : (south ? 3.0 : region);
+        double polar = north || south ? 1.0 : 0.0;
+        row = north || south ? capRow : row;
+
+        // The bits above y, 36 of them, are exact in a double.
+        double high = region * (double)(1ULL << 34) + polar * (double)(1ULL << 33) + levelBits + column;
+        uids[i] = (integerBits(high) << 28) | integerBits(row);
+    }
+}
+
+uint64_t tileUid(const TileAddress &address){
+    return (uint64_t)address.region << 62 | (uint64_t)(address.polar ? 1 : 0) << 61
+           | (uint64_t)address.level << 56 | ((uint64_t)address.x & kCoordinateMask) << 28
+           | ((uint64_t)address.y & kCoordinateMask);
+}
+
+TileAddress tileAddress(uint64_t uid){
+    TileAddress address;
+    address.region = (TileRegion)(uid >> 62);
+    address.polar = (uid >> 61 & 1) != 0;
+    address.level = (int)(uid >> 56 & 31);
+    address.x = (int)(uid >> 28 & kCoordinateMask);
+    address.y = (int)(uid & kCoordinateMask);
+    return address;
+}
+
+TileAddress tileAt(geodesy::GeoPoint point, int level){
+    uint64_t uid;
+    tileUids(&point.latitude, &point.longitude, level, &uid, 1);
+    return tileAddress(uid);
+}
+
+TileBounds tileBounds(const TileAddress &address){
+    if (address.level == 0) {
+        return TileBounds{-180.0, -90.0, 180.0, 90.0};
+    }
+    double scale = std::ldexp(1.0, address.level);
+    TileBounds bounds;
+    bounds.minLongitude = address.x / scale * 360.0 - 180.0;
+    bounds.maxLongitude = (address.x + 1) / scale * 360.0 - 180.0;
+    if (!address.polar) {
+        bounds.maxLatitude = fractionLatitude(address.y / scale);
+        bounds.minLatitude = fractionLatitude((address.y + 1) / scale);
+    }
+    else {
+        double top = address.region == TileRegion::North ? 90.0 : -kMercatorLimit;
+        bounds.maxLatitude = top - address.y / scale * kCapHeight;
+        bounds.minLatitude = top - (address.y + 1) / scale * kCapHeight;
+    }
+    return bounds;
+}
+
+bool isValid(const TileAddress &address){
+    if (address.level == 0) {
+        return address.region == TileRegion::Root && !address.polar && address.x == 0 && address.y == 0;
+    }
+    if (address.level < 0 || address.level > kMaxLevel) {
+        return false;
+    }
+    int tilesAcross = 1 << address.level;
+    if (address.x < 0 || address.x >= tilesAcross || address.y < 0 || address.y >= tilesAcross) {
+        return false;
+    }
+    if (address.polar) {
+        return address.region == TileRegion::North || address.region == TileRegion::South;
+    }
+    RegionRows rows = regionRows(tilesAcross);
+    TileRegion region = address.y + 1.0 <= rows.northRows ? TileRegion::North
+                        : (address.y >= rows.southRows ? TileRegion::South : TileRegion::Center);
+    return address.region == region;
+}
+
+} // namespace tiles
+} // namespace ironman
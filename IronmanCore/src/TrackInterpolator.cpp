@@ -0,0 +1,113 @@
+//
+//  TrackInterpolator.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 11/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/TrackInterpolator.hpp"
+#include "ironman/Geodesy.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ironman {
+
+// Forward steps tried from the cached segment before falling back to a binary search.
+static const size_t kLinearProbeCount = 4;
+
+static TrackState stateOfSample(const TrackColumns &track, size_t index, double time){
+    return TrackState{time, track.latitude[index], track.longitude[index], track.altitude[index],
+                      track.groundSpeed[index], track.trackAngle[index], track.verticalSpeed[index]};
+}
+
+size_t TrackInterpolator::locate(double time){
+    // Segment i spans samples i and i + 1.
+    const std::vector<int64_t> &times = _track.timeOfApplicability;
+    size_t lastSegment = times.size() - 2;
+    if (_segment <= lastSegment && time >= times[_segment]) {
+        for (size_t probe=0; probe<kLinearProbeCount && _segment <= lastSegment; probe++) {
+            if (time < times[_segment + 1] || _segment == lastSegment) {
+                return _segment;
+            }
+            _segment++;
+        }
+    }
+
+    // The last sample at or before time starts the segment.
+    size_t upper = std::upper_bound(times.begin(), times.end(), time, [](double value, int64_t sampleTime){
+        return value < static_cast<double>(sampleTime);
+    }) - times.begin();
+    _segment = std::min(upper == 0 ? 0 : upper - 1, lastSegment);
+    return _segment;
+}
+
+TrackState TrackInterpolator::evaluate(double time){
+    size_t count = _track.size();
+    if (count == 0) {
+        return TrackState{time, NAN, NAN, NAN, NAN, NAN, NAN};
+    }
+    if (count == 1 || time <= _track.timeOfApplicability.front()) {
+        _segment = 0;
+        return stateOfSample(_track, 0, time);
+    }
+    if (time >= _track.timeOfApplicability.back()) {
+        _segment = count - 2;
+        return stateOfSample(_track, count - 1, time);
+    }
+
+    size_t i = locate(time);
+    double duration = static_cast<double>(_track.timeOfApplicability[i + 1] - _track.timeOfApplicability[i]);
+    double u = (time - _track.timeOfApplicability[i]) / duration;
+
+    // Work in a flat east/north frame in nautical miles around the first sample; a segment is far too
+    // short for the earth's curvature to matter.
+    geodesy::GeoPoint origin{_track.latitude[i], _track.longitude[i]};
+    geodesy::GeoPoint end{_track.latitude[i + 1], _track.longitude[i + 1]};
+    double chord = geodesy::nauticalMilesBetween(origin, end);
+    double chordCourse = geodesy::toRadians(geodesy::courseDegrees(origin, end));
+    double endEast = chord * std::sin(chordCourse);
+    double endNorth = chord * std::cos(chordCourse);
+
+    // Tangents in nautical miles and feet per second; a missing velocity follows the chord.
+    double velocity[2][3];
+    for (int side=0; side<2; side++) {
+        size_t sample = i + side;
+        double track = geodesy::toRadians(_track.trackAngle[sample]);
+        double speed = _track.groundSpeed[sample] / 3600.0;
+        bool hasVelocity = std::isfinite(track) && std::isfinite(speed);
+        velocity[side][0] = hasVelocity ? speed * std::sin(track) : endEast / duration;
+        velocity[side][1] = hasVelocity ? speed * std::cos(track) : endNorth / duration;
+        double climb = _track.verticalSpeed[sample] / 60.0;
+        velocity[side][2] = std::isfinite(climb) ? climb : (_track.altitude[i + 1] - _track.altitude[i]) / duration;
+    }
+
+    // Hermite basis and its derivative at u.
+    double u2 = u * u;
+    double u3 = u2 * u;
+    double h00 = 2 * u3 - 3 * u2 + 1;
+    double h10 = u3 - 2 * u2 + u;
+    double h01 = -2 * u3 + 3 * u2;
+    double h11 = u3 - u2;
+    double d00 = 6 * u2 - 6 * u;
+    double d10 = 3 * u2 - 4 * u + 1;
+    double d01 = -6 * u2 + 6 * u;
+    double d11 = 3 * u2 - 2 * u;
+
+    double start[3] = {0, 0, _track.altitude[i]};
+    double finish[3] = {endEast, endNorth, _track.altitude[i + 1]};
+    double position[3];
+    double rate[3];
+    for (int axis=0; axis<3; axis++) {
+        position[axis] = h00 * start[axis] + h10 * duration * velocity[0][axis] + h01 * finish[axis] + h11 * duration * velocity[1][axis];
+        rate[axis] = (d00 * start[axis] + d01 * finish[axis]) / duration + d10 * velocity[0][axis] + d11 * velocity[1][axis];
+    }
+
+    double offset = std::hypot(position[0], position[1]);
+    geodesy::GeoPoint location = offset > 0 ? geodesy::pointOnRadial(origin, geodesy::toDegrees(std::atan2(position[0], position[1])), offset) : origin;
+    double trackAngle = geodesy::toDegrees(std::atan2(rate[0], rate[1]));
+    return TrackState{time, location.latitude, location.longitude, position[2],
+                      std::hypot(rate[0], rate[1]) * 3600.0, trackAngle < 0 ? trackAngle + 360.0 : trackAngle, rate[2] * 60.0};
+}
+
+} // namespace ironman
@@ -0,0 +1,91 @@
+//
+//  TrackReader.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 08/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/TrackReader.hpp"
+
+namespace ironman {
+
+const char *trackSelectQuery(TrackTable table){
+    switch (table) {
+        case TrackTable::Traffic:
+            return selectQuery<TrafficSchema>();
+        case TrackTable::Ownship:
+            return selectQuery<OwnshipSchema>();
+        case TrackTable::Track:
+            return selectQuery<TrackStoreSchema>();
+    }
+    return nullptr;
+}
+
+TrackRowDecoder trackRowDecoder(TrackTable table){
+    switch (table) {
+        case TrackTable::Traffic:
+            return &decodeRow<TrafficSchema>;
+        case TrackTable::Ownship:
+            return &decodeRow<OwnshipSchema>;
+        case TrackTable::Track:
+            return &decodeRow<TrackStoreSchema>;
+    }
+    return nullptr;
+}
+
+bool TrackReader::load(TrackTable table, TrackColumns &columns, int64_t startTime, int64_t endTime){
+    Statement &statement = _statements[static_cast<int>(table)];
+    switch (table) {
+        case TrackTable::Traffic:
+            return load<TrafficSchema>(statement, columns, startTime, endTime);
+        case TrackTable::Ownship:
+            return load<OwnshipSchema>(statement, columns, startTime, endTime);
+        case TrackTable::Track:
+            return load<TrackStoreSchema>(statement, columns, startTime, endTime);
+    }
+    return false;
+}
+
+// The table is resolved once per load, so the row loop inlines its schema's decoder.
+template <typename Schema>
+bool TrackReader::load(Statement &statement, TrackColumns &columns, int64_t startTime, int64_t endTime){
+    if (!statement.isValid()) {
+        statement = Statement(_database, selectQuery<Schema>());
+        if (!statement.isValid()) {
+            return false;
+        }
+    }
+
+    statement.reset();
+    statement.bind(1, startTime);
+    statement.bind(2, endTime);
+    while (statement.step()) {
+        columns.push_back(decodeRow<Schema>(statement));
+    }
+    bool succeeded = !statement.failed();
+    statement.reset();
+    return succeeded;
+}
+
+void appendArchiveSpan(const DBTrackArchiveSpan &span, TrackColumns &columns){
+    columns.trackId.insert(columns.trackId.end(), span.count, 0);
+    columns.timeOfApplicability.insert(columns.timeOfApplicability.end(), span.timeOfApplicability, span.timeOfApplicability + span.count);
+    const double *values[] = {
+        span.columns[DBTrackArchiveColumnLatitude],
+        span.columns[DBTrackArchiveColumnLongitude],
+        span.columns[DBTrackArchiveColumnAltitude],
+        span.columns[DBTrackArchiveColumnHorizontalVelocity1],
+        span.columns[DBTrackArchiveColumnHorizontalVelocity2],
+        span.columns[DBTrackArchiveColumnVerticalSpeed],
+    };
+    std::vector<double> *destinations[] = {
+        &columns.latitude, &columns.longitude, &columns.altitude,
+        &columns.groundSpeed, &columns.trackAngle, &columns.verticalSpeed,
+    };
+    for (int column=0; column<DBTrackArchiveColumnCount; column++) {
+        destinations[column]->insert(destinations[column]->end(), values[column], values[column] + span.count);
+    }
+}
+
+} // namespace ironman
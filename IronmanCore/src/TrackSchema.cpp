@@ -0,0 +1,38 @@
+//
+//  TrackSchema.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 18/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/TrackSchema.hpp"
+
+namespace ironman {
+namespace schema {
+
+std::string selectQuery(const char *table, const SchemaColumn *columns, int count){
+    const char *time = nullptr;
+    const char *trackId = nullptr;
+    std::string query = "select ";
+    for (int i=0; i<count; i++) {
+        if (i > 0) {
+            query += ", ";
+        }
+        query += columns[i].name;
+        if (columns[i].field == TrackField::TimeOfApplicability) {
+            time = columns[i].name;
+        }
+        else if (columns[i].field == TrackField::TrackId) {
+            trackId = columns[i].name;
+        }
+    }
+    query += std::string(" from ") + table + " where " + time + " between ? and ? order by " + time;
+    if (trackId != nullptr) {
+        query += std::string(", ") + trackId;
+    }
+    return query;
+}
+
+} // namespace schema
+} // namespace ironman
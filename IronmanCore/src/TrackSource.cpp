@@ -0,0 +1,51 @@
+//
+//  TrackSource.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 10/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/TrackSource.hpp"
+
+namespace ironman {
+
+StatementTrackSource::StatementTrackSource(Database &database, TrackTable table, int64_t startTime, int64_t endTime)
+    : _statement(database, trackSelectQuery(table)), _decode(trackRowDecoder(table)){
+    _statement.bind(1, startTime);
+    _statement.bind(2, endTime);
+}
+
+bool StatementTrackSource::next(TrackSample &sample){
+    if (!_statement.isValid() || !_statement.step()) {
+        return false;
+    }
+    sample = _decode(_statement);
+    return true;
+}
+
+bool ColumnsTrackSource::next(TrackSample &sample){
+    if (_index >= _columns.size()) {
+        return false;
+    }
+    sample = _columns[_index++];
+    return true;
+}
+
+bool ArchiveTrackSource::next(TrackSample &sample){
+    if (_index >= _span.count) {
+        return false;
+    }
+    sample.trackId = 0;
+    sample.timeOfApplicability = _span.timeOfApplicability[_index];
+    sample.latitude = _span.columns[DBTrackArchiveColumnLatitude][_index];
+    sample.longitude = _span.columns[DBTrackArchiveColumnLongitude][_index];
+    sample.altitude = _span.columns[DBTrackArchiveColumnAltitude][_index];
+    sample.groundSpeed = _span.columns[DBTrackArchiveColumnHorizontalVelocity1][_index];
+    sample.trackAngle = _span.columns[DBTrackArchiveColumnHorizontalVelocity2][_index];
+    sample.verticalSpeed = _span.columns[DBTrackArchiveColumnVerticalSpeed][_index];
+    _index++;
+    return true;
+}
+
+} // namespace ironman
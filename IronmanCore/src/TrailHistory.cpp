@@ -0,0 +1,188 @@
+//
+//  TrailHistory.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 17/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/TrailHistory.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace ironman {
+
+TrailHistory::TrailHistory(const TrailHistorySettings &settings) : _settings(settings) {
+    _settings.capacity = std::max<size_t>(_settings.capacity, 1);
+}
+
+uint32_t TrailHistory::slotOf(int64_t trackId){
+    auto existing = _slots.find(trackId);
+    if (existing != _slots.end()) {
+        return existing->second;
+    }
+    uint32_t slot;
+    if (!_freeSlots.empty()) {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+    else {
+        slot = static_cast<uint32_t>(_trails.size());
+        _trails.push_back(Trail());
+        _trails.back().dirty = false;
+        _arena.resize(_arena.size() + _settings.capacity);
+    }
+    Trail &trail = _trails[slot];
+    trail.trackId = trackId;
+    trail.first = 0;
+    trail.end = 0;
+    trail.reportedFirst = 0;
+    trail.reportedEnd = 0;
+    trail.created = true;
+    trail.live = true;
+    _slots.emplace(trackId, slot);
+    return slot;
+}
+
+void TrailHistory::markDirty(uint32_t slot){
+    if (!_trails[slot].dirty) {
+        _trails[slot].dirty = true;
+        _dirty.push_back(slot);
+    }
+}
+
+void TrailHistory::evictBefore(uint32_t slot, double time){
+    Trail &trail = _trails[slot];
+    const TrailPoint *points = ring(slot);
+    uint64_t first = trail.first;
+    while (first < trail.end && points[first % _settings.capacity].time < time) {
+        first++;
+    }
+    if (first != trail.first) {
+        trail.first = first;
+        markDirty(slot);
+    }
+}
+
+bool TrailHistory::append(int64_t trackId, const TrailPoint &point){
+    if (!std::isfinite(point.time) || !std::isfinite(point.latitude) || !std::isfinite(point.longitude)) {
+        return false;
+    }
+    uint32_t slot = slotOf(trackId);
+    Trail &trail = _trails[slot];
+    TrailPoint *points = ring(slot);
+    if (trail.end > trail.first && !(point.time > points[(trail.end - 1) % _settings.capacity].time)) {
+        return false;
+    }
+    evictBefore(slot, point.time - _settings.maxAge);
+    if (trail.end - trail.first == _settings.capacity) {
+        trail.first++;
+    }
+    points[trail.end % _settings.capacity] = point;
+    trail.end++;
+    markDirty(slot);
+    return true;
+}
+
+bool TrailHistory::append(const TrackSample &sample){
+    return append(sample.trackId, TrailPoint{static_cast<double>(sample.timeOfApplicability), sample.latitude, sample.longitude, sample.altitude});
+}
+
+void TrailHistory::expire(double time){
+    for (uint32_t slot=0; slot<_trails.size(); slot++) {
+        if (_trails[slot].live) {
+            evictBefore(slot, time - _settings.maxAge);
+        }
+    }
+}
+
+bool TrailHistory::remove(int64_t trackId){
+    auto existing = _slots.find(trackId);
+    if (existing == _slots.end()) {
+        return false;
+    }
+    uint32_t slot = existing->second;
+    Trail &trail = _trails[slot];
+    // A trail the renderer never saw needs no removal.
+    if (!trail.created) {
+        _removed.push_back(trackId);
+    }
+    trail.live = false;
+    _slots.erase(existing);
+    _freeSlots.push_back(slot);
+    return true;
+}
+
+void TrailHistory::clear(){
+    for (const Trail &trail : _trails) {
+        if (trail.live && !trail.created) {
+            _removed.push_back(trail.trackId);
+        }
+    }
+    _arena.clear();
+    _trails.clear();
+    _freeSlots.clear();
+    _slots.clear();
+    _dirty.clear();
+}
+
+size_t TrailHistory::count(int64_t trackId) const{
+    auto existing = _slots.find(trackId);
+    if (existing == _slots.end()) {
+        return 0;
+    }
+    const Trail &trail = _trails[existing->second];
+    return static_cast<size_t>(trail.end - trail.first);
+}
+
+int TrailHistory::spansOf(uint32_t slot, uint64_t from, uint64_t to, TrailSpan spans[2]) const{
+    if (from >= to) {
+        return 0;
+    }
+    size_t begin = static_cast<size_t>(from % _settings.capacity);
+    size_t total = static_cast<size_t>(to - from);
+    size_t head = std::min(total, _settings.capacity - begin);
+    spans[0] = TrailSpan{ring(slot) + begin, head};
+    if (head == total) {
+        return 1;
+    }
+    spans[1] = TrailSpan{ring(slot), total - head};
+    return 2;
+}
+
+int TrailHistory::points(int64_t trackId, TrailSpan spans[2]) const{
+    auto existing = _slots.find(trackId);
+    if (existing == _slots.end()) {
+        return 0;
+    }
+    const Trail &trail = _trails[existing->second];
+    return spansOf(existing->second, trail.first, trail.end, spans);
+}
+
+void TrailHistory::changes(std::vector<TrailChange> &changed, std::vector<int64_t> &removed){
+    changed.clear();
+    for (uint32_t slot : _dirty) {
+        Trail &trail = _trails[slot];
+        trail.dirty = false;
+        if (!trail.live) {
+            continue;
+        }
+        TrailChange change;
+        change.trackId = trail.trackId;
+        change.created = trail.created;
+        // Points the renderer holds are [reportedFirst, reportedEnd); those before first are gone.
+        change.evicted = static_cast<size_t>(std::min(trail.first, trail.reportedEnd) - trail.reportedFirst);
+        change.appended[0] = TrailSpan{nullptr, 0};
+        change.appended[1] = TrailSpan{nullptr, 0};
+        spansOf(slot, std::max(trail.reportedEnd, trail.first), trail.end, change.appended);
+        trail.reportedFirst = trail.first;
+        trail.reportedEnd = trail.end;
+        trail.created = false;
+        changed.push_back(change);
+    }
+    _dirty.clear();
+    removed.assign(_removed.begin(), _removed.end());
+    _removed.clear();
+}
+
+} // namespace ironman
@@ -0,0 +1,157 @@
+//
+//  TrailSimplifier.cpp
+//  IronmanCore
+//
+//  Created by Aaron D'Souza on 16/07/19.
+//  Copyright © 2019 Aaron D'Souza. All rights reserved.
+//
+
+#include "ironman/TrailSimplifier.hpp"
+#include "ironman/Geodesy.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ironman {
+
+// Unit normals of the octagon's edges, at 0, 45, 90 and 135 degrees.
+static const double kNormalEast[4] = {1.0, 0.70710678118654752, 0.0, -0.70710678118654752};
+static const double kNormalNorth[4] = {0.0, 0.70710678118654752, 1.0, 0.70710678118654752};
+// An octagon whose edges lie this fraction of the radius from the centre has its vertices on the
+// circle: cos(22.5 degrees).
+static const double kInscribed = 0.92387953251128676;
+
+TrailSimplifier::TrailSimplifier(const TrailSettings &settings) : _settings(settings) {
+    _levels.resize(static_cast<size_t>(std::max(settings.levelCount, 1)));
+    for (size_t i=0; i<_levels.size(); i++) {
+        _levels[i].tolerance = std::ldexp(settings.tolerance, static_cast<int>(i));
+        _levels[i].altitudeTolerance = std::ldexp(settings.altitudeTolerance, static_cast<int>(i));
+        _levels[i].open = false;
+        resetWindow(_levels[i].window);
+    }
+}
+
+double TrailSimplifier::tolerance(int level) const{
+    return _levels[level].tolerance;
+}
+
+int TrailSimplifier::levelFor(double tolerance) const{
+    int level = 0;
+    while (level + 1 < levelCount() && _levels[level + 1].tolerance <= tolerance) {
+        level++;
+    }
+    return level;
+}
+
+void TrailSimplifier::resetWindow(Window &window){
+    for (int k=0; k<4; k++) {
+        window.lower[k] = -std::numeric_limits<double>::infinity();
+        window.upper[k] = std::numeric_limits<double>::infinity();
+    }
+    window.climbLower = -std::numeric_limits<double>::infinity();
+    window.climbUpper = std::numeric_limits<double>::infinity();
+}
+
+void TrailSimplifier::velocityOf(const TrailPoint &anchor, const TrailPoint &point, double &east, double &north, double &climb){
+    double dt = point.time - anchor.time;
+    double deltaLongitude = point.longitude - anchor.longitude;
+    if (deltaLongitude > 180.0) {
+        deltaLongitude -= 360.0;
+    }
+    else if (deltaLongitude < -180.0) {
+        deltaLongitude += 360.0;
+    }
+    east = deltaLongitude * 60.0 * std::cos(geodesy::toRadians(anchor.latitude)) / dt;
+    north = (point.latitude - anchor.latitude) * 60.0 / dt;
+    climb = (point.altitude - anchor.altitude) / dt;
+}
+
+bool TrailSimplifier::admits(const Window &window, double east, double north, double climb){
+    for (int k=0; k<4; k++) {
+        double projected = kNormalEast[k] * east + kNormalNorth[k] * north;
+        if (projected < window.lower[k] || projected > window.upper[k]) {
+            return false;
+        }
+    }
+    return climb >= window.climbLower && climb <= window.climbUpper;
+}
+
+// A sample dt seconds after the anchor is within tolerance of the segment exactly when the segment's
+// velocity is within tolerance / dt of the sample's own velocity from the anchor.
+void TrailSimplifier::constrain(Window &window, const Level &level, double dt, double east, double north, double climb){
+    double radius = kInscribed * level.tolerance / dt;
+    for (int k=0; k<4; k++) {
+        double projected = kNormalEast[k] * east + kNormalNorth[k] * north;
+        window.lower[k] = std::max(window.lower[k], projected - radius);
+        window.upper[k] = std::min(window.upper[k], projected + radius);
+    }
+    double climbRadius = level.altitudeTolerance / dt;
+    window.climbLower = std::max(window.climbLower, climb - climbRadius);
+    window.climbUpper = std::min(window.climbUpper, climb + climbRadius);
+}
+
+bool TrailSimplifier::append(const TrailPoint &sample){
+    if (!std::isfinite(sample.latitude) || !std::isfinite(sample.longitude) || !std::isfinite(sample.time)) {
+        return false;
+    }
+    if (_sampleCount > 0 && !(sample.time > _latest.time)) {
+        return false;
+    }
+    TrailPoint point = sample;
+    if (!std::isfinite(point.altitude)) {
+        point.altitude = _sampleCount > 0 ? _latest.altitude : 0;
+    }
+
+    if (_sampleCount == 0) {
+        for (Level &level : _levels) {
+            level.vertices.push_back(point);
+        }
+    }
+    else {
+        for (Level &level : _levels) {
+            const TrailPoint &anchor = level.vertices.back();
+            double east;
+            double north;
+            double climb;
+            velocityOf(anchor, point, east, north, climb);
+            double dt = point.time - anchor.time;
+
+            // The first sample after the anchor always extends the segment, however long the gap.
+            if (level.open && (dt > _settings.maxVertexGap || !admits(level.window, east, north, climb))) {
+                // The previous sample satisfied every constraint before it, so it ends the segment.
+                level.vertices.push_back(_latest);
+                resetWindow(level.window);
+                velocityOf(_latest, point, east, north, climb);
+                dt = point.time - _latest.time;
+            }
+            constrain(level.window, level, dt, east, north, climb);
+            level.open = true;
+        }
+    }
+    _latest = point;
+    _sampleCount++;
+    return true;
+}
+
+bool TrailSimplifier::append(const TrackSample &sample){
+    return append(TrailPoint{static_cast<double>(sample.timeOfApplicability), sample.latitude, sample.longitude, sample.altitude});
+}
+
+void TrailSimplifier::clear(){
+    for (Level &level : _levels) {
+        level.vertices.clear();
+        level.open = false;
+        resetWindow(level.window);
+    }
+    _sampleCount = 0;
+}
+
+void TrailSimplifier::vertices(int level, std::vector<TrailPoint> &trail) const{
+    const std::vector<TrailPoint> &kept = _levels[level].vertices;
+    trail.assign(kept.begin(), kept.end());
+    if (_sampleCount > 0 && _latest.time > kept.back().time) {
+        trail.push_back(_latest);
+    }
+}
+
+} // namespace ironman